@@ -0,0 +1,152 @@
+#include <benchmark/benchmark.h>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <audio_generic.h>
+#include <audio_kernels.h>
+#include <filesystem_stream.h>
+
+using AudioKernels::Isa;
+using AudioKernels::Format;
+
+namespace {
+	constexpr int frequency = 44100;
+	constexpr int frames_per_decode = 2048;
+	constexpr int se_channels = 31;
+
+	/** GenericAudio without an audio device, Decode is called by the benchmark */
+	class BenchAudio : public GenericAudio {
+	public:
+		BenchAudio() {
+			SetFormat(frequency, AudioDecoder::Format::S16, 2);
+		}
+		void LockMutex() const override {}
+		void UnlockMutex() const override {}
+	};
+
+	/** @return 10 seconds of stereo noise as 16 bit WAV file */
+	std::vector<uint8_t> MakeWav() {
+		const uint32_t data_size = frequency * 10 * 2 * 2;
+		std::vector<uint8_t> wav(44 + data_size);
+
+		auto put16 = [&](size_t pos, uint16_t v) { wav[pos] = v & 0xFF; wav[pos + 1] = v >> 8; };
+		auto put32 = [&](size_t pos, uint32_t v) { put16(pos, v & 0xFFFF); put16(pos + 2, v >> 16); };
+
+		memcpy(&wav[0], "RIFF", 4);
+		put32(4, 36 + data_size);
+		memcpy(&wav[8], "WAVEfmt ", 8);
+		put32(16, 16);
+		put16(20, 1); // PCM
+		put16(22, 2);
+		put32(24, frequency);
+		put32(28, frequency * 4);
+		put16(32, 4);
+		put16(34, 16);
+		memcpy(&wav[36], "data", 4);
+		put32(40, data_size);
+
+		std::mt19937 rng(1);
+		std::uniform_int_distribution<int> dist(-8000, 8000);
+		for (size_t pos = 44; pos < wav.size(); pos += 2) {
+			put16(pos, static_cast<uint16_t>(dist(rng)));
+		}
+		return wav;
+	}
+
+	void PlayAll(BenchAudio& audio, std::vector<uint8_t>& wav) {
+		for (int i = 0; i < se_channels; ++i) {
+			auto* buf = new Filesystem_Stream::InputMemoryStreamBuf(Span<uint8_t>(wav.data(), wav.size()));
+			audio.SE_Play(Filesystem_Stream::InputStream(buf, "bench.wav"), 100 - i, 100);
+		}
+	}
+
+	bool SelectIsa(benchmark::State& state) {
+		auto isa = static_cast<Isa>(state.range(0));
+		if (!AudioKernels::SetIsa(isa)) {
+			state.SkipWithError("Instruction set not supported");
+			return false;
+		}
+		state.SetLabel(PixelKernels::GetIsaName(isa));
+		return true;
+	}
+}
+
+// Arguments: instruction set
+static void IsaArgs(benchmark::internal::Benchmark* b) {
+	for (auto isa: { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON }) {
+		b->Args({ static_cast<int>(isa) });
+	}
+}
+
+// Arguments: instruction set, sample format
+static void MixArgs(benchmark::internal::Benchmark* b) {
+	for (auto isa: { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON }) {
+		for (auto format: { Format::S8, Format::U8, Format::S16, Format::S32, Format::F32 }) {
+			b->Args({ static_cast<int>(isa), static_cast<int>(format) });
+		}
+	}
+}
+
+// Full GenericAudio::Decode with all SE channels playing
+static void BM_DecodeAllSe(benchmark::State& state) {
+	if (!SelectIsa(state)) {
+		return;
+	}
+
+	static std::vector<uint8_t> wav = MakeWav();
+	BenchAudio audio;
+	std::vector<uint8_t> output(frames_per_decode * 2 * 2);
+
+	// The SE last 215 calls, restart them before they end
+	int decodes = 0;
+	for (auto _: state) {
+		if (decodes++ % 200 == 0) {
+			state.PauseTiming();
+			audio.SE_Stop();
+			audio.Decode(output.data(), output.size());
+			PlayAll(audio, wav);
+			state.ResumeTiming();
+		}
+		audio.Decode(output.data(), output.size());
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames_per_decode);
+}
+
+// Only the mixing kernels: 31 channels of one format and the final conversion
+static void BM_MixKernels(benchmark::State& state) {
+	if (!SelectIsa(state)) {
+		return;
+	}
+	auto format = static_cast<Format>(state.range(1));
+
+	std::mt19937 rng(1);
+	std::vector<uint8_t> samples(frames_per_decode * 2 * 4);
+	for (auto& b: samples) {
+		b = rng();
+	}
+	if (format == Format::F32) {
+		auto* f = reinterpret_cast<float*>(samples.data());
+		for (int i = 0; i < frames_per_decode * 2; ++i) {
+			f[i] = (static_cast<int>(rng() % 2001) - 1000) / 1000.0f;
+		}
+	}
+	std::vector<float> mixed(frames_per_decode * 2);
+	std::vector<int16_t> output(frames_per_decode * 2);
+
+	for (auto _: state) {
+		std::fill(mixed.begin(), mixed.end(), 0.0f);
+		for (int i = 0; i < se_channels; ++i) {
+			AudioKernels::Mix(format, samples.data(), mixed.data(), mixed.size(), 0.5f);
+		}
+		AudioKernels::ToS16(mixed.data(), output.data(), output.size(), se_channels * 0.5f);
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * frames_per_decode);
+}
+
+BENCHMARK(BM_DecodeAllSe)->Apply(IsaArgs);
+
+BENCHMARK(BM_MixKernels)->Apply(MixArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <vector>
+#include <bitmap.h>
+#include <pixel_format.h>
+#include <pixel_kernels.h>
+
+using PixelKernels::Isa;
+
+// Arguments: instruction set, tone (0: saturation + color, 1: saturation, 2: color)
+static void ToneRowArgs(benchmark::internal::Benchmark* b) {
+	for (auto isa: { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON }) {
+		for (int tone = 0; tone < 3; ++tone) {
+			b->Args({ static_cast<int>(isa), tone });
+		}
+	}
+}
+
+static Tone GetTone(int which) {
+	switch (which) {
+		case 0:
+			return Tone(255, 64, 128, 64);
+		case 1:
+			return Tone(128, 128, 128, 0);
+		default:
+			return Tone(255, 64, 200, 128);
+	}
+}
+
+static bool SelectIsa(benchmark::State& state) {
+	auto isa = static_cast<Isa>(state.range(0));
+	if (!PixelKernels::SetIsa(isa)) {
+		state.SkipWithError("Instruction set not supported");
+		return false;
+	}
+	state.SetLabel(PixelKernels::GetIsaName(isa));
+	return true;
+}
+
+static void BM_ToneRow(benchmark::State& state) {
+	if (!SelectIsa(state)) {
+		return;
+	}
+
+	std::mt19937 rng(1);
+	std::vector<uint32_t> pixels(320 * 240);
+	for (auto& px: pixels) {
+		px = rng();
+	}
+
+	auto tone = GetTone(state.range(1));
+	PixelKernels::ToneParams params;
+	params.rs = 0;
+	params.gs = 8;
+	params.bs = 16;
+	params.as = 24;
+	params.saturate = tone.gray != 128;
+	params.saturation = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	params.color = tone.red != 128 || tone.green != 128 || tone.blue != 128;
+	params.red = tone.red;
+	params.green = tone.green;
+	params.blue = tone.blue;
+	params.skip_transparent = true;
+
+	for (auto _: state) {
+		PixelKernels::ToneRow(pixels.data(), pixels.size(), params);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * pixels.size());
+}
+
+BENCHMARK(BM_ToneRow)->Apply(ToneRowArgs);
+
+static void BM_ToneBlitScreen(benchmark::State& state) {
+	if (!SelectIsa(state)) {
+		return;
+	}
+
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	auto dest = Bitmap::Create(320, 240);
+	auto src = Bitmap::Create(320, 240);
+	src->Fill(Color(200, 100, 50, 255));
+	auto rect = src->GetRect();
+	auto tone = GetTone(state.range(1));
+	for (auto _: state) {
+		dest->ToneBlit(0, 0, *src, rect, tone, Opacity::Opaque(), false);
+	}
+	state.SetItemsProcessed(state.iterations() * rect.width * rect.height);
+}
+
+BENCHMARK(BM_ToneBlitScreen)->Apply(ToneRowArgs);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,230 @@
+// End to end benchmark: runs the player headless for a number of frames with
+// replayed input and reports the update and draw time of every scene.
+//
+// Usage: bench_replay [--frames N] [GAME_DIR INPUT_LOG]
+//
+// Without arguments a generated test game is used: one map with animated
+// tiles, wandering events and parallel processes, and an input log which
+// walks the hero around. Pass a game directory and a log recorded with
+// --record-input to benchmark a real game.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <lcf/ldb/reader.h>
+#include <lcf/lmt/reader.h>
+#include <lcf/lmu/reader.h>
+#include <lcf/rpg/database.h>
+#include <lcf/rpg/map.h>
+#include <lcf/rpg/treemap.h>
+#include <filefinder.h>
+#include <map_data.h>
+#include <player.h>
+
+namespace {
+	constexpr int map_width = 60;
+	constexpr int map_height = 45;
+	constexpr int num_walkers = 60;
+	constexpr int num_parallel = 8;
+
+	lcf::rpg::EventCommand MakeCommand(lcf::rpg::EventCommand::Code code, std::initializer_list<int32_t> params) {
+		lcf::rpg::EventCommand cmd;
+		cmd.code = static_cast<int32_t>(code);
+		cmd.parameters = lcf::DBArray<int32_t>(params.begin(), params.end());
+		return cmd;
+	}
+
+	lcf::rpg::Database MakeDatabase() {
+		lcf::rpg::Database db;
+
+		db.actors.resize(1);
+		db.actors[0].ID = 1;
+		db.actors[0].character_name = lcf::DBString("Bench");
+		db.system.party.push_back(1);
+
+		db.terrains.resize(1);
+		db.terrains[0].ID = 1;
+
+		db.chipsets.resize(1);
+		auto& chipset = db.chipsets[0];
+		chipset.ID = 1;
+		chipset.chipset_name = lcf::DBString("Bench");
+		chipset.passable_data_lower.resize(162, 0xF);
+		chipset.passable_data_upper.resize(162, 0xF);
+		chipset.terrain_data.resize(162, 1);
+
+		db.switches.resize(20);
+		db.variables.resize(20);
+		for (int i = 0; i < 20; ++i) {
+			db.switches[i].ID = i + 1;
+			db.variables[i].ID = i + 1;
+		}
+
+		return db;
+	}
+
+	lcf::rpg::TreeMap MakeTreeMap() {
+		lcf::rpg::TreeMap treemap;
+
+		treemap.maps.resize(2);
+		treemap.maps[0].type = lcf::rpg::TreeMap::MapType_root;
+		treemap.maps[1].ID = 1;
+		treemap.maps[1].type = lcf::rpg::TreeMap::MapType_map;
+
+		treemap.start.party_map_id = 1;
+		treemap.start.party_x = map_width / 2;
+		treemap.start.party_y = map_height / 2;
+
+		return treemap;
+	}
+
+	lcf::rpg::Map MakeMap() {
+		lcf::rpg::Map map;
+		map.chipset_id = 1;
+		map.width = map_width;
+		map.height = map_height;
+
+		// Water and animated tiles in the lower layer, some upper layer tiles
+		map.lower_layer.resize(map_width * map_height);
+		map.upper_layer.resize(map_width * map_height);
+		for (int y = 0; y < map_height; ++y) {
+			for (int x = 0; x < map_width; ++x) {
+				const int i = y * map_width + x;
+				if ((x / 8 + y / 6) % 5 == 0) {
+					map.lower_layer[i] = BLOCK_A + ((x + y) % 3) * BLOCK_A_STRIDE;
+				} else if ((x + 2 * y) % 11 == 0) {
+					map.lower_layer[i] = BLOCK_C + (x % 3) * BLOCK_C_STRIDE;
+				} else {
+					map.lower_layer[i] = BLOCK_E + (x * 7 + y * 3) % BLOCK_E_TILES;
+				}
+				map.upper_layer[i] = (x * y) % 13 == 0 ? BLOCK_F + 1 + (x + y) % 40 : BLOCK_F;
+			}
+		}
+
+		int id = 1;
+		for (int i = 0; i < num_walkers; ++i, ++id) {
+			lcf::rpg::Event event;
+			event.ID = id;
+			event.x = (i * 17) % map_width;
+			event.y = (i * 29) % map_height;
+
+			lcf::rpg::EventPage page;
+			page.ID = 1;
+			page.character_name = lcf::DBString("Bench");
+			page.character_index = i % 8;
+			page.move_type = lcf::rpg::EventPage::MoveType_random;
+			page.move_frequency = 3 + i % 4;
+			page.layer = lcf::rpg::EventPage::Layers_same;
+			event.pages.push_back(std::move(page));
+
+			map.events.push_back(std::move(event));
+		}
+
+		// Interpreter load: random variables and switch flips every frame
+		using Cmd = lcf::rpg::EventCommand::Code;
+		for (int i = 0; i < num_parallel; ++i, ++id) {
+			lcf::rpg::Event event;
+			event.ID = id;
+
+			lcf::rpg::EventPage page;
+			page.ID = 1;
+			page.trigger = lcf::rpg::EventPage::Trigger_parallel;
+			page.event_commands.push_back(MakeCommand(Cmd::ControlVars, { 1, 1, 10, 0, 3, 0, 100 }));
+			page.event_commands.push_back(MakeCommand(Cmd::ControlVars, { 0, 11 + i, 0, 1, 1, 1, 0 }));
+			page.event_commands.push_back(MakeCommand(Cmd::ControlSwitches, { 0, 1 + i, 0, 2 }));
+			page.event_commands.push_back(MakeCommand(Cmd::Wait, { 0 }));
+			event.pages.push_back(std::move(page));
+
+			map.events.push_back(std::move(event));
+		}
+
+		return map;
+	}
+
+	/**
+	 * Walks the hero in a square, 30 of 40 frames a direction is held.
+	 * The player exits at the end of the log, so it ends with an idle frame
+	 * well after the benchmark stopped.
+	 */
+	std::string MakeInputLog(int frames) {
+		static const char* directions[] = { "RIGHT", "DOWN", "LEFT", "UP" };
+
+		std::string log = "H EasyRPG Player Recording\nV 2 bench\n";
+		for (int frame = 1; frame <= frames; ++frame) {
+			if (frame % 40 < 30) {
+				log += "F " + std::to_string(frame) + "," + directions[(frame / 40) % 4] + "\n";
+			}
+		}
+		// The game frame counter only starts with the new game, after the title and loading frames the
+		// benchmark already measured, so it never gets here before --bench-frames stops the player
+		log += "F " + std::to_string(frames * 2 + 1) + "\n";
+		return log;
+	}
+
+	bool WriteGame(const std::string& dir, const std::string& log_path, int frames) {
+		auto root = FileFinder::Root();
+		root.MakeDirectory(dir, false);
+
+		auto db_os = root.OpenOutputStream(dir + "/RPG_RT.ldb", std::ios::out | std::ios::binary | std::ios::trunc);
+		auto tree_os = root.OpenOutputStream(dir + "/RPG_RT.lmt", std::ios::out | std::ios::binary | std::ios::trunc);
+		auto map_os = root.OpenOutputStream(dir + "/Map0001.lmu", std::ios::out | std::ios::binary | std::ios::trunc);
+		auto log_os = root.OpenOutputStream(log_path, std::ios::out | std::ios::trunc);
+		if (!db_os || !tree_os || !map_os || !log_os) {
+			return false;
+		}
+
+		return lcf::LDB_Reader::Save(db_os, MakeDatabase(), "1252")
+			&& lcf::LMT_Reader::Save(tree_os, MakeTreeMap(), lcf::EngineVersion::e2k, "1252")
+			&& lcf::LMU_Reader::Save(map_os, MakeMap(), lcf::EngineVersion::e2k, "1252")
+			&& (log_os << MakeInputLog(frames));
+	}
+}
+
+int main(int argc, char* argv[]) {
+	int frames = 3000;
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+			frames = std::max(1, atoi(argv[++i]));
+		} else {
+			paths.push_back(argv[i]);
+		}
+	}
+
+	std::string game_dir;
+	std::string log_path;
+	if (paths.size() == 2) {
+		game_dir = paths[0];
+		log_path = paths[1];
+	} else if (paths.empty()) {
+		game_dir = "bench_replay_game";
+		log_path = "bench_replay_game.log";
+		if (!WriteGame(game_dir, log_path, frames)) {
+			std::cerr << "Failed to write the test game to " << game_dir << "\n";
+			return EXIT_FAILURE;
+		}
+	} else {
+		std::cerr << "Usage: " << argv[0] << " [--frames N] [GAME_DIR INPUT_LOG]\n";
+		return EXIT_FAILURE;
+	}
+
+	std::vector<std::string> args = {
+		argv[0], "--headless", "--disable-rtp", "--new-game",
+		"--encoding", "1252", "--seed", "1",
+		"--project-path", game_dir, "--replay-input", log_path,
+		"--bench-frames", std::to_string(frames)
+	};
+	std::vector<char*> player_argv;
+	for (auto& arg : args) {
+		player_argv.push_back(&arg[0]);
+	}
+	player_argv.push_back(nullptr);
+
+	Player::Init(static_cast<int>(args.size()), player_argv.data());
+	Player::Run();
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,140 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "async_decoder.h"
+#include "bitmap.h"
+#include "instrumentation.h"
+#include "utils.h"
+
+#ifdef HAVE_ASYNC_DECODE
+#  include <condition_variable>
+#  include <deque>
+#  include <mutex>
+#  include <thread>
+#endif
+
+namespace {
+	std::vector<AsyncDecoder::Result> finished;
+}
+
+#ifdef HAVE_ASYNC_DECODE
+namespace {
+	struct Job {
+		std::string key;
+		std::vector<uint8_t> data;
+		bool transparent;
+		uint32_t flags;
+	};
+
+	std::mutex mutex;
+	std::condition_variable jobs_cv;
+	std::deque<Job> jobs;
+	std::vector<std::thread> workers;
+	bool quit = false;
+
+	void WorkerMain() {
+		Instrumentation::SetThreadName("Image decoder");
+
+		std::unique_lock<std::mutex> lock(mutex);
+		for (;;) {
+			jobs_cv.wait(lock, [] { return quit || !jobs.empty(); });
+			if (quit) {
+				return;
+			}
+
+			Job job = std::move(jobs.front());
+			jobs.pop_front();
+			lock.unlock();
+
+			static Instrumentation::Zone zone("AsyncDecoder::Decode");
+			Instrumentation::Scope scope(zone);
+
+			BitmapRef bitmap;
+			std::vector<Output::LogMessage> log;
+			if (!job.data.empty()) {
+				Output::SetThreadCapture(&log);
+				bitmap = Bitmap::Create(job.data.data(), static_cast<unsigned>(job.data.size()), job.transparent, job.flags);
+				Output::SetThreadCapture(nullptr);
+			}
+
+			lock.lock();
+			finished.push_back({ std::move(job.key), std::move(bitmap), std::move(log) });
+		}
+	}
+
+	void StartWorkers() {
+		if (!workers.empty()) {
+			return;
+		}
+		// Leave one core to the main thread
+		int count = Utils::Clamp(static_cast<int>(std::thread::hardware_concurrency()) - 1, 1, 4);
+		quit = false;
+		for (int i = 0; i < count; ++i) {
+			workers.emplace_back(WorkerMain);
+		}
+	}
+}
+#endif
+
+bool AsyncDecoder::IsSupported() {
+#ifdef HAVE_ASYNC_DECODE
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AsyncDecoder::Submit(std::string key, std::vector<uint8_t> data, bool transparent, uint32_t flags) {
+#ifdef HAVE_ASYNC_DECODE
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		StartWorkers();
+		jobs.push_back({ std::move(key), std::move(data), transparent, flags });
+	}
+	jobs_cv.notify_one();
+#else
+	// Decode directly when there are no threads
+	BitmapRef bitmap = Bitmap::Create(data.data(), static_cast<unsigned>(data.size()), transparent, flags);
+	finished.push_back({ std::move(key), std::move(bitmap), {} });
+#endif
+}
+
+std::vector<AsyncDecoder::Result> AsyncDecoder::TakeFinished() {
+	std::vector<Result> result;
+#ifdef HAVE_ASYNC_DECODE
+	std::lock_guard<std::mutex> lock(mutex);
+#endif
+	result.swap(finished);
+	return result;
+}
+
+void AsyncDecoder::Quit() {
+#ifdef HAVE_ASYNC_DECODE
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+		jobs.clear();
+	}
+	jobs_cv.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	workers.clear();
+	finished.clear();
+#endif
+}
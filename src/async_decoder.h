@@ -0,0 +1,72 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_ASYNC_DECODER_H
+#define EP_ASYNC_DECODER_H
+
+// Headers
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "memory_management.h"
+#include "output.h"
+
+/**
+ * AsyncDecoder decodes image files on worker threads.
+ *
+ * The file data is read by the caller on the main thread, only the
+ * decoding (PNG, BMP, XYZ) and the pixel format conversion run on the
+ * workers. Finished images are collected with TakeFinished on the main thread,
+ * together with the messages the decoders logged.
+ */
+namespace AsyncDecoder {
+	/** Result of a decoded image */
+	struct Result {
+		/** Key passed to Submit */
+		std::string key;
+		/** Decoded bitmap, nullptr when the data was not a valid image */
+		BitmapRef bitmap;
+		/** Messages logged while decoding, the log is only written on the main thread */
+		std::vector<Output::LogMessage> log;
+	};
+
+	/** @return whether images can be decoded on worker threads */
+	bool IsSupported();
+
+	/**
+	 * Queues an image for decoding.
+	 * The worker threads are started on the first call.
+	 *
+	 * @param key identifies the image in the result
+	 * @param data content of the image file
+	 * @param transparent whether the image uses a transparent color
+	 * @param flags Bitmap::Flag values used when creating the bitmap
+	 */
+	void Submit(std::string key, std::vector<uint8_t> data, bool transparent, uint32_t flags);
+
+	/**
+	 * Returns all images decoded since the last call.
+	 *
+	 * @return finished images
+	 */
+	std::vector<Result> TakeFinished();
+
+	/** Stops the worker threads, queued images are discarded. */
+	void Quit();
+}
+
+#endif
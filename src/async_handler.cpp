@@ -288,6 +288,10 @@ void FileRequestAsync::Start() {
 #  endif
 
 #  ifndef EP_DEBUG_SIMULATE_ASYNC
+	// Large images are decoded in the background, the request finishes when they are cached
+	if (graphic && Cache::DecodeAsync(directory, file, [this]() { DownloadDone(true); })) {
+		return;
+	}
 	DownloadDone(true);
 #  endif
 #endif
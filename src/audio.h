@@ -110,6 +110,18 @@ struct AudioInterface {
 	 * Stops the currently playing sound effect.
 	 */
 	virtual void SE_Stop() = 0;
+
+	/**
+	 * Decodes a sound effect in advance so playing it later is fast.
+	 * Optional, does nothing by default.
+	 *
+	 * @param stream file to decode.
+	 * @param pitch pitch the sound effect will be played with.
+	 */
+	virtual void SE_Preload(Filesystem_Stream::InputStream stream, int pitch) {
+		(void)stream;
+		(void)pitch;
+	}
 };
 
 struct EmptyAudio : public AudioInterface {
@@ -17,38 +17,27 @@
 
 #include "system.h"
 
+#include <algorithm>
 #include <cstring>
 #include <cassert>
 #include <memory>
 #include "audio_decoder_midi.h"
 #include "audio_generic.h"
 #include "audio_generic_midiout.h"
+#include "audio_kernels.h"
 #include "filefinder.h"
+#include "instrumentation.h"
 #include "output.h"
 
-GenericAudio::BgmChannel GenericAudio::BGM_Channels[nr_of_bgm_channels];
-GenericAudio::SeChannel GenericAudio::SE_Channels[nr_of_se_channels];
-bool GenericAudio::BGM_PlayedOnceIndicator;
-
 std::vector<int16_t> GenericAudio::sample_buffer = {};
 std::vector<uint8_t> GenericAudio::scrap_buffer = {};
 unsigned GenericAudio::scrap_buffer_size = 0;
 std::vector<float> GenericAudio::mixer_buffer = {};
+std::vector<float> GenericAudio::channel_buffer = {};
 
 std::unique_ptr<GenericAudioMidiOut> GenericAudio::midi_thread;
 
 GenericAudio::GenericAudio() {
-	int i = 0;
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.id = i++;
-		BGM_Channel.decoder.reset();
-	}
-	i = 0;
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.id = i++;
-		SE_Channel.decoder.reset();
-	}
-	BGM_PlayedOnceIndicator = false;
 	midi_thread.reset();
 
 	// Initialize to some arbitrary (low-quality) format to prevent crashes
@@ -57,127 +46,117 @@ GenericAudio::GenericAudio() {
 }
 
 void GenericAudio::BGM_Play(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein) {
-	bool bgm_set = false;
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.stopped = true; //Stop all running background music
-		if (!BGM_Channel.IsUsed() && !bgm_set) {
-			// If there is an unused bgm channel
-			bgm_set = true;
-			LockMutex();
-			BGM_PlayedOnceIndicator = false;
-			UnlockMutex();
-			PlayOnChannel(BGM_Channel, std::move(stream), volume, pitch, fadein);
-		}
-	}
+	bgm_stopped = false;
+	++bgm_serial;
+
+	Command cmd;
+	cmd.decoder = OpenBgm(std::move(stream), volume, pitch, fadein);
+	// Without a decoder this stops the previous BGM
+	cmd.type = cmd.decoder ? Command::Type::BgmPlay : Command::Type::BgmStop;
+	cmd.value = bgm_serial;
+	// The audio thread only publishes the ticks of the new BGM after its next decode
+	bgm_ticks.store(0, std::memory_order_relaxed);
+	PushCommand(std::move(cmd));
 }
 
 void GenericAudio::BGM_Pause() {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.IsUsed()) {
-			BGM_Channel.SetPaused(true);
-		}
+	if (bgm_midi_out_used) {
+		midi_thread->GetMidiOut().Pause();
 	}
+	PushCommand({ Command::Type::BgmPause });
 }
 
 void GenericAudio::BGM_Resume() {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.IsUsed()) {
-			BGM_Channel.SetPaused(false);
-		}
+	if (bgm_midi_out_used) {
+		midi_thread->GetMidiOut().Resume();
 	}
+	PushCommand({ Command::Type::BgmResume });
 }
 
 void GenericAudio::BGM_Stop() {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.Stop();
-	}
-	UnlockMutex();
+	bgm_stopped = true;
+	StopMidiOut();
+	PushCommand({ Command::Type::BgmStop });
 }
 
 bool GenericAudio::BGM_PlayedOnce() const {
-	if (BGM_PlayedOnceIndicator) {
-		return BGM_PlayedOnceIndicator;
-	}
-
-	LockMutex();
-	// Audio Decoders set this in the Decoding thread
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (BGM_Channel.midi_out_used) {
-			BGM_PlayedOnceIndicator = midi_thread->GetMidiOut().GetLoopCount() > 0;
-		}
+	if (bgm_midi_out_used) {
+		midi_thread->LockMutex();
+		bool played_once = midi_thread->GetMidiOut().GetLoopCount() > 0;
+		midi_thread->UnlockMutex();
+		return played_once;
 	}
-	UnlockMutex();
 
-	return BGM_PlayedOnceIndicator;
+	// Set by the audio thread once the BGM with this serial looped
+	return bgm_serial > 0 && bgm_played_once_serial.load(std::memory_order_acquire) == bgm_serial;
 }
 
 bool GenericAudio::BGM_IsPlaying() const {
-	for (auto& BGM_Channel : BGM_Channels) {
-		if (!BGM_Channel.stopped) {
-			return true;
-		};
-	}
-	return false;
+	return !bgm_stopped;
 }
 
 int GenericAudio::BGM_GetTicks() const {
-	unsigned ticks = 0;
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		int cur_ticks = BGM_Channel.GetTicks();
-		if (cur_ticks >= 0) {
-			ticks = static_cast<unsigned>(cur_ticks);
-		}
+	if (bgm_midi_out_used) {
+		return midi_thread->GetMidiOut().GetTicks();
 	}
-	UnlockMutex();
-	return ticks;
+	return std::max(bgm_ticks.load(std::memory_order_relaxed), 0);
 }
 
 void GenericAudio::BGM_Fade(int fade) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetFade(fade);
+	if (bgm_midi_out_used) {
+		midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
 	}
-	UnlockMutex();
+	PushCommand({ Command::Type::BgmFade, fade });
 }
 
 void GenericAudio::BGM_Volume(int volume) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetVolume(volume);
+	if (bgm_midi_out_used) {
+		midi_thread->GetMidiOut().SetVolume(volume);
 	}
-	UnlockMutex();
+	PushCommand({ Command::Type::BgmVolume, volume });
 }
 
 void GenericAudio::BGM_Pitch(int pitch) {
-	LockMutex();
-	for (auto& BGM_Channel : BGM_Channels) {
-		BGM_Channel.SetPitch(pitch);
+	if (bgm_midi_out_used) {
+		midi_thread->GetMidiOut().SetPitch(pitch);
 	}
-	UnlockMutex();
+	PushCommand({ Command::Type::BgmPitch, pitch });
 }
 
 void GenericAudio::SE_Play(Filesystem_Stream::InputStream stream, int volume, int pitch) {
-	for (auto& SE_Channel : SE_Channels) {
-		if (!SE_Channel.decoder) {
-			//If there is an unused se channel
-			PlayOnChannel(SE_Channel, std::move(stream), volume, pitch);
-			return;
-		}
+	if (se_channels_used.load(std::memory_order_relaxed) >= nr_of_se_channels) {
+		// FIXME Not displaying as warning because multiple games exhaust free channels available, see #1356
+		Output::Debug("Couldn't play {} SE. No free channel available", stream.GetName());
+		return;
+	}
+
+	std::unique_ptr<AudioSeCache> cache = AudioSeCache::Create(std::move(stream));
+	if (!cache) {
+		Output::Warning("Couldn't play SE {}. Format not supported", stream.GetName());
+		return;
+	}
+
+	Command cmd;
+	cmd.type = Command::Type::SePlay;
+	cmd.decoder = cache->CreateSeDecoder(pitch, output_format.frequency, output_format.format, output_format.channels);
+	cmd.decoder->SetVolume(volume);
+	PushCommand(std::move(cmd));
+}
+
+void GenericAudio::SE_Preload(Filesystem_Stream::InputStream stream, int pitch) {
+	std::unique_ptr<AudioSeCache> cache = AudioSeCache::Create(std::move(stream));
+	if (cache) {
+		cache->Preload(pitch, output_format.frequency, output_format.format, output_format.channels);
 	}
-	// FIXME Not displaying as warning because multiple games exhaust free channels available, see #1356
-	Output::Debug("Couldn't play {} SE. No free channel available", stream.GetName());
 }
 
 void GenericAudio::SE_Stop() {
-	for (auto& SE_Channel : SE_Channels) {
-		SE_Channel.stopped = true; //Stop all running sound effects
-	}
+	PushCommand({ Command::Type::SeStop });
 }
 
 void GenericAudio::Update() {
-	// no-op, handled by the Decode function called through a thread
+	// Decoding is handled by the Decode function called through a thread
+	FlushCommands();
 }
 
 void GenericAudio::SetFormat(int frequency, AudioDecoder::Format format, int channels) {
@@ -186,19 +165,15 @@ void GenericAudio::SetFormat(int frequency, AudioDecoder::Format format, int cha
 	output_format.channels = channels;
 }
 
-bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream filestream, int volume, int pitch, int fadein) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
-
+std::unique_ptr<AudioDecoderBase> GenericAudio::OpenBgm(Filesystem_Stream::InputStream filestream, int volume, int pitch, int fadein) {
 	if (!filestream) {
+		StopMidiOut();
 		Output::Warning("BGM file not readable: {}", filestream.GetName());
-		return false;
+		return nullptr;
 	}
 
-	// Midiout is only supported on channel 0 because this is an exclusive resource
-	if (chan.id == 0 && GenericAudioMidiOut::IsSupported(filestream)) {
-		chan.decoder.reset();
-
+	// Midiout is an exclusive resource and runs in its own thread
+	if (GenericAudioMidiOut::IsSupported(filestream)) {
 		// FIXME: Try Fluidsynth and WildMidi first
 		// If they work fallback to the normal AudioDecoder handler below
 		// There should be a way to configure the order
@@ -221,58 +196,132 @@ bool GenericAudio::PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStrea
 					midi_out.SetFade(volume, std::chrono::milliseconds(fadein));
 					midi_out.SetLooping(true);
 					midi_out.Resume();
-					chan.paused = false;
-					chan.midi_out_used = true;
+					bgm_midi_out_used = true;
 					midi_thread->UnlockMutex();
-					return true;
+					return nullptr;
 				}
 				midi_thread->UnlockMutex();
 			}
 		}
 	}
 
-	if (midi_thread) {
+	StopMidiOut();
+
+	// Opening happens here on the game thread, the audio thread only receives ready decoders
+	auto decoder = AudioDecoder::Create(filestream);
+	if (decoder && decoder->Open(std::move(filestream))) {
+		decoder->SetPitch(pitch);
+		decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
+		decoder->SetVolume(0);
+		decoder->SetFade(volume, std::chrono::milliseconds(fadein));
+		decoder->SetLooping(true);
+		return decoder;
+	}
+
+	Output::Warning("Couldn't play BGM {}. Format not supported", filestream.GetName());
+	return nullptr;
+}
+
+void GenericAudio::StopMidiOut() {
+	if (bgm_midi_out_used) {
+		bgm_midi_out_used = false;
+		midi_thread->GetMidiOut().Reset();
+		midi_thread->GetMidiOut().Pause();
+	} else if (midi_thread) {
 		midi_thread->GetMidiOut().Reset();
 	}
+}
 
-	chan.decoder = AudioDecoder::Create(filestream);
-	chan.midi_out_used = false;
-	if (chan.decoder && chan.decoder->Open(std::move(filestream))) {
-		chan.decoder->SetPitch(pitch);
-		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-		chan.decoder->SetVolume(0);
-		chan.decoder->SetFade(volume, std::chrono::milliseconds(fadein));
-		chan.decoder->SetLooping(true);
-		chan.paused = false; // Unpause channel -> Play it.
-
-		return true;
-	} else {
-		Output::Warning("Couldn't play BGM {}. Format not supported", filestream.GetName());
+void GenericAudio::PushCommand(Command cmd) {
+	FlushCommands();
+
+	if (pending_commands.empty() && commands.Push(std::move(cmd))) {
+		return;
 	}
 
-	return false;
+	// The audio thread is not draining the queue (e.g. the device is paused).
+	// Late sound effects are useless, everything else must arrive in order.
+	if (cmd.type != Command::Type::SePlay) {
+		pending_commands.push_back(std::move(cmd));
+	}
 }
 
-bool GenericAudio::PlayOnChannel(SeChannel& chan, Filesystem_Stream::InputStream filestream, int volume, int pitch) {
-	chan.paused = true; // Pause channel so the audio thread doesn't work on it
-	chan.stopped = false; // Unstop channel so the audio thread doesn't delete it
+void GenericAudio::FlushCommands() {
+	std::unique_ptr<AudioDecoderBase> decoder;
+	while (retired_decoders.Pop(decoder)) {
+		decoder.reset();
+	}
 
-	std::unique_ptr<AudioSeCache> cache = AudioSeCache::Create(std::move(filestream));
-	if (cache) {
-		chan.decoder = cache->CreateSeDecoder();
-		chan.decoder->SetPitch(pitch);
-		chan.decoder->SetFormat(output_format.frequency, output_format.format, output_format.channels);
-		chan.decoder->SetVolume(volume);
-		chan.paused = false; // Unpause channel -> Play it.
-		return true;
-	} else {
-		Output::Warning("Couldn't play SE {}. Format not supported", filestream.GetName());
+	while (!pending_commands.empty() && commands.Push(std::move(pending_commands.front()))) {
+		pending_commands.pop_front();
 	}
+}
 
-	return false;
+void GenericAudio::ProcessCommands() {
+	Command cmd;
+	while (commands.Pop(cmd)) {
+		switch (cmd.type) {
+			case Command::Type::BgmPlay:
+				Retire(std::move(BGM_Channel.decoder));
+				BGM_Channel.decoder = std::move(cmd.decoder);
+				BGM_Channel.paused = false;
+				BGM_Channel.serial = cmd.value;
+				break;
+			case Command::Type::BgmStop:
+				Retire(std::move(BGM_Channel.decoder));
+				break;
+			case Command::Type::BgmPause:
+				BGM_Channel.paused = true;
+				break;
+			case Command::Type::BgmResume:
+				BGM_Channel.paused = false;
+				break;
+			case Command::Type::BgmFade:
+				if (BGM_Channel.decoder) {
+					BGM_Channel.decoder->SetFade(0, std::chrono::milliseconds(cmd.value));
+				}
+				break;
+			case Command::Type::BgmVolume:
+				if (BGM_Channel.decoder) {
+					BGM_Channel.decoder->SetVolume(cmd.value);
+				}
+				break;
+			case Command::Type::BgmPitch:
+				if (BGM_Channel.decoder) {
+					BGM_Channel.decoder->SetPitch(cmd.value);
+				}
+				break;
+			case Command::Type::SePlay: {
+				auto it = std::find_if(std::begin(SE_Channels), std::end(SE_Channels), [](const SeChannel& chan) {
+					return !chan.decoder;
+				});
+				if (it != std::end(SE_Channels)) {
+					it->decoder = std::move(cmd.decoder);
+				} else {
+					Retire(std::move(cmd.decoder));
+				}
+				break;
+			}
+			case Command::Type::SeStop:
+				for (auto& SE_Channel : SE_Channels) {
+					Retire(std::move(SE_Channel.decoder));
+				}
+				break;
+		}
+	}
+}
+
+void GenericAudio::Retire(std::unique_ptr<AudioDecoderBase> decoder) {
+	if (decoder && !retired_decoders.Push(std::move(decoder))) {
+		// Game thread is behind, free it here instead of waiting
+		decoder.reset();
+	}
 }
 
 void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
+	static Instrumentation::Zone zone("GenericAudio::Decode");
+	Instrumentation::Scope scope(zone);
+
 	bool channel_active = false;
 	float total_volume = 0;
 	int samples_per_frame = buffer_length / output_format.channels / 2;
@@ -289,7 +338,9 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 	if (scrap_buffer.size() != scrap_buffer_size) {
 		scrap_buffer.resize(scrap_buffer_size);
 	}
-	memset(mixer_buffer.data(), '\0', mixer_buffer.size());
+	std::fill(mixer_buffer.begin(), mixer_buffer.end(), 0.0f);
+
+	ProcessCommands();
 
 	for (unsigned i = 0; i < nr_of_bgm_channels + nr_of_se_channels; i++) {
 		int read_bytes = 0;
@@ -304,73 +355,65 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		bool channel_used = false;
 
 		if (is_bgm_channel) {
-			BgmChannel& currently_mixed_channel = BGM_Channels[i];
+			BgmChannel& currently_mixed_channel = BGM_Channel;
 			float current_master_volume = 1.0;
 
 			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					currently_mixed_channel.decoder->Update(std::chrono::microseconds(1000 * 1000 / 60));
-					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
+				currently_mixed_channel.decoder->Update(std::chrono::microseconds(1000 * 1000 / 60));
+				volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
+				currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
+				samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					total_volume += volume;
+				total_volume += volume;
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+				// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
+				unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
+				bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+				read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
 
-					if (read_bytes < 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
-					}
-
-					if (!currently_mixed_channel.stopped) {
-						BGM_PlayedOnceIndicator = currently_mixed_channel.decoder->GetLoopCount() > 0;
-					}
+				if (read_bytes < 0) {
+					// An error occured when reading - the channel is faulty - discard
+					Retire(std::move(currently_mixed_channel.decoder));
+					continue; // skip this loop run - there is nothing to mix
+				}
 
-					channel_used = true;
+				if (currently_mixed_channel.decoder->GetLoopCount() > 0) {
+					bgm_played_once_serial.store(currently_mixed_channel.serial, std::memory_order_release);
 				}
+
+				channel_used = true;
 			}
 		} else {
 			SeChannel& currently_mixed_channel = SE_Channels[i - nr_of_bgm_channels];
 			float current_master_volume = 1.0;
 
-			if (currently_mixed_channel.decoder && !currently_mixed_channel.paused) {
-				if (currently_mixed_channel.stopped) {
-					currently_mixed_channel.decoder.reset();
-				} else {
-					volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
-					currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
-					samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
+			if (currently_mixed_channel.decoder) {
+				volume = current_master_volume * (currently_mixed_channel.decoder->GetVolume() / 100.0);
+				currently_mixed_channel.decoder->GetFormat(frequency, sampleformat, channels);
+				samplesize = AudioDecoder::GetSamplesizeForFormat(sampleformat);
 
-					total_volume += volume;
+				total_volume += volume;
 
-					// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
-					unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
-					bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
+				// determine how much data has to be read from this channel (but cap at the bounds of the scrap buffer)
+				unsigned bytes_to_read = (samplesize * channels * samples_per_frame);
+				bytes_to_read = (bytes_to_read < scrap_buffer_size) ? bytes_to_read : scrap_buffer_size;
 
-					read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
+				read_bytes = currently_mixed_channel.decoder->Decode(scrap_buffer.data(), bytes_to_read);
 
-					if (read_bytes < 0) {
-						// An error occured when reading - the channel is faulty - discard
-						currently_mixed_channel.decoder.reset();
-						continue; // skip this loop run - there is nothing to mix
-					}
-
-					// Now decide what to do when a channel has reached its end
-					if (currently_mixed_channel.decoder->IsFinished()) {
-						// SE are only played once so free the se if finished
-						currently_mixed_channel.decoder.reset();
-					}
+				if (read_bytes < 0) {
+					// An error occured when reading - the channel is faulty - discard
+					Retire(std::move(currently_mixed_channel.decoder));
+					continue; // skip this loop run - there is nothing to mix
+				}
 
-					channel_used = true;
+				// Now decide what to do when a channel has reached its end
+				if (currently_mixed_channel.decoder->IsFinished()) {
+					// SE are only played once so free the se if finished
+					Retire(std::move(currently_mixed_channel.decoder));
 				}
+
+				channel_used = true;
 			}
 		}
 
@@ -379,147 +422,37 @@ void GenericAudio::Decode(uint8_t* output_buffer, int buffer_length) {
 		//--------------------------------------------------------------------------------------------------------------------//
 
 		if (channel_used) {
-			for (unsigned ii = 0; ii < (unsigned)(read_bytes / (samplesize * channels)); ii++) {
-
-				float vall = volume;
-				float valr = vall;
-
-				// Convert to floating point
-				switch (sampleformat) {
-					case AudioDecoder::Format::S8:
-						vall *= (((int8_t *) scrap_buffer.data())[ii * channels] / 128.0);
-						valr *= (((int8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0);
-						break;
-					case AudioDecoder::Format::U8:
-						vall *= (((uint8_t *) scrap_buffer.data())[ii * channels] / 128.0 - 1.0);
-						valr *= (((uint8_t *) scrap_buffer.data())[ii * channels + 1] / 128.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S16:
-						vall *= (((int16_t *) scrap_buffer.data())[ii * channels] / 32768.0);
-						valr *= (((int16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0);
-						break;
-					case AudioDecoder::Format::U16:
-						vall *= (((uint16_t *) scrap_buffer.data())[ii * channels] / 32768.0 - 1.0);
-						valr *= (((uint16_t *) scrap_buffer.data())[ii * channels + 1] / 32768.0 - 1.0);
-						break;
-					case AudioDecoder::Format::S32:
-						vall *= (((int32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0);
-						valr *= (((int32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0);
-						break;
-					case AudioDecoder::Format::U32:
-						vall *= (((uint32_t *) scrap_buffer.data())[ii * channels] / 2147483648.0 - 1.0);
-						valr *= (((uint32_t *) scrap_buffer.data())[ii * channels + 1] / 2147483648.0 - 1.0);
-						break;
-					case AudioDecoder::Format::F32:
-						vall *= (((float *) scrap_buffer.data())[ii * channels]);
-						valr *= (((float *) scrap_buffer.data())[ii * channels + 1]);
-						break;
+			const int frames = read_bytes / (samplesize * channels);
+			if (channels == output_format.channels) {
+				AudioKernels::Mix(sampleformat, scrap_buffer.data(), mixer_buffer.data(), frames * channels, volume);
+			} else {
+				// Channel layout differs from the output (e.g. mono): convert first, then map the channels
+				if (channel_buffer.size() < (size_t)(frames * channels)) {
+					channel_buffer.resize(frames * channels);
 				}
-
-				if (!channel_active) {
-					// first channel
-					mixer_buffer[ii * output_format.channels] = vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] = valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
-					}
-				} else {
-					mixer_buffer[ii * output_format.channels] += vall;
-					if (channels > 1) {
-						mixer_buffer[ii * output_format.channels + 1] += valr;
-					} else {
-						mixer_buffer[ii * output_format.channels + 1] = mixer_buffer[ii * output_format.channels];
+				std::fill(channel_buffer.begin(), channel_buffer.end(), 0.0f);
+				AudioKernels::Mix(sampleformat, scrap_buffer.data(), channel_buffer.data(), frames * channels, volume);
+				for (int ii = 0; ii < frames; ii++) {
+					for (int c = 0; c < output_format.channels; c++) {
+						mixer_buffer[ii * output_format.channels + c] += channel_buffer[ii * channels + std::min(c, channels - 1)];
 					}
 				}
-
 			}
 			channel_active = true;
 		}
 	}
 
+	bgm_ticks.store(BGM_Channel.decoder ? BGM_Channel.decoder->GetTicks() : -1, std::memory_order_relaxed);
+	se_channels_used.store(std::count_if(std::begin(SE_Channels), std::end(SE_Channels), [](const SeChannel& chan) {
+		return static_cast<bool>(chan.decoder);
+	}), std::memory_order_relaxed);
+
 	if (channel_active) {
-		if (total_volume > 1.0) {
-			float threshold = 0.8;
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				float sample = mixer_buffer[i];
-				float sign = (sample < 0) ? -1.0 : 1.0;
-				sample /= sign;
-				//dynamic range compression
-				if (sample > threshold) {
-					sample_buffer[i] = sign * 32768.0 * (threshold + (1.0 - threshold) * (sample - threshold) / (total_volume - threshold));
-				} else {
-					sample_buffer[i] = sign * sample * 32768.0;
-				}
-			}
-		} else {
-			//No dynamic range compression necessary
-			for (unsigned i = 0; i < (unsigned)(samples_per_frame * 2); i++) {
-				sample_buffer[i] = mixer_buffer[i] * 32768.0;
-			}
-		}
+		// Compresses the dynamic range when the sum of the volumes is above 1.0
+		AudioKernels::ToS16(mixer_buffer.data(), sample_buffer.data(), samples_per_frame * output_format.channels, total_volume);
 
 		memcpy(output_buffer, sample_buffer.data(), buffer_length);
 	} else {
 		memset(output_buffer, '\0', buffer_length);
 	}
 }
-
-void GenericAudio::BgmChannel::Stop() {
-	stopped = true;
-	if (midi_out_used) {
-		midi_out_used = false;
-		midi_thread->GetMidiOut().Reset();
-		midi_thread->GetMidiOut().Pause();
-	} else if (decoder) {
-		decoder.reset();
-	}
-}
-
-void GenericAudio::BgmChannel::SetPaused(bool newPaused) {
-	paused = newPaused;
-	if (midi_out_used) {
-		if (newPaused) {
-			midi_thread->GetMidiOut().Pause();
-		} else {
-			midi_thread->GetMidiOut().Resume();
-		}
-	}
-}
-
-int GenericAudio::BgmChannel::GetTicks() const {
-	if (midi_out_used) {
-		return midi_thread->GetMidiOut().GetTicks();
-	} else if (decoder) {
-		return decoder->GetTicks();
-	}
-	return -1;
-}
-
-void GenericAudio::BgmChannel::SetFade(int fade) {
-	if (midi_out_used) {
-		midi_thread->GetMidiOut().SetFade(0, std::chrono::milliseconds(fade));
-	} else if (decoder) {
-		decoder->SetFade(0, std::chrono::milliseconds(fade));
-	}
-}
-
-void GenericAudio::BgmChannel::SetVolume(int volume) {
-	if (midi_out_used) {
-		midi_thread->GetMidiOut().SetVolume(volume);
-	} else if (decoder) {
-		decoder->SetVolume(volume);
-	}
-}
-
-void GenericAudio::BgmChannel::SetPitch(int pitch) {
-	if (midi_out_used) {
-		midi_thread->GetMidiOut().SetPitch(pitch);
-	} else if (decoder) {
-		decoder->SetPitch(pitch);
-	}
-}
-
-bool GenericAudio::BgmChannel::IsUsed() const {
-	return decoder || midi_out_used;
-}
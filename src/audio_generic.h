@@ -21,6 +21,9 @@
 #include "audio.h"
 #include "audio_secache.h"
 #include "audio_decoder_base.h"
+#include "spsc_queue.h"
+#include <atomic>
+#include <deque>
 #include <memory>
 
 class GenericAudioMidiOut;
@@ -29,14 +32,21 @@ class GenericAudioMidiOut;
  * A software implementation for handling EasyRPG Audio utilizing the
  * AudioDecoder for BGM and AudioSeCache for fast SE playback.
  *
+ * The BGM and SE functions are called from the game thread. They open the
+ * decoders and pass them together with all other changes through a lock-free
+ * command queue to the audio thread, which applies them at the start of
+ * every Decode call. Decoders which are not needed anymore are handed back
+ * the same way and destroyed on the game thread. Decode therefore never
+ * waits for the game thread.
+ *
  * Inheriting implementations have to:
  * 1. Init the audio system in the constructor (and deinit in destructor)
  * 2. Start a thread (or a callback) which invokes the Decode function to
  *    fill the output buffer and controls access to the audio api of the
- *    target platform.
+ *    target platform. Decode must not be called from several threads at once.
  * 3. Initialize the "output_format" (must match the format of the hardware)
- * 4. Implement LockMutex and UnlockMutex. Locking and Unlocking when
- *    calling Decode must be done manually.
+ * 4. Implement LockMutex and UnlockMutex. They guard platform specific
+ *    state only, GenericAudio does not call them.
  * 5. Implement update function (optional)
  */
 class GenericAudio : public AudioInterface {
@@ -56,6 +66,7 @@ public:
 	void BGM_Pitch(int pitch) override;
 	void SE_Play(Filesystem_Stream::InputStream stream, int volume, int pitch) override;
 	void SE_Stop() override;
+	void SE_Preload(Filesystem_Stream::InputStream stream, int pitch) override;
 	virtual void Update() override;
 
 	void SetFormat(int frequency, AudioDecoder::Format format, int channels);
@@ -66,25 +77,34 @@ public:
 	void Decode(uint8_t* output_buffer, int buffer_length);
 
 private:
+	/** A change sent from the game thread to the audio thread */
+	struct Command {
+		enum class Type {
+			BgmPlay,
+			BgmStop,
+			BgmPause,
+			BgmResume,
+			BgmFade,
+			BgmVolume,
+			BgmPitch,
+			SePlay,
+			SeStop
+		};
+		Type type = Type::BgmStop;
+		/** Serial of the BGM for BgmPlay, otherwise the fade, volume or pitch */
+		int value = 0;
+		/** Opened and configured decoder for BgmPlay and SePlay */
+		std::unique_ptr<AudioDecoderBase> decoder;
+	};
+
+	/** Channel state, only accessed by the audio thread */
 	struct BgmChannel {
-		int id;
 		std::unique_ptr<AudioDecoderBase> decoder;
-		bool paused;
-		bool stopped;
-		bool midi_out_used = false;
-		void Stop();
-		void SetPaused(bool newPaused);
-		int GetTicks() const;
-		void SetFade(int fade);
-		void SetVolume(int volume);
-		void SetPitch(int pitch);
-		bool IsUsed() const;
+		bool paused = false;
+		int serial = 0;
 	};
 	struct SeChannel {
-		int id;
 		std::unique_ptr<AudioDecoderBase> decoder;
-		bool paused;
-		bool stopped;
 	};
 	struct Format {
 		int frequency;
@@ -93,21 +113,44 @@ private:
 	};
 	Format output_format = {};
 
-	bool PlayOnChannel(BgmChannel& chan, Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein);
-	bool PlayOnChannel(SeChannel& chan, Filesystem_Stream::InputStream stream, int volume, int pitch);
+	std::unique_ptr<AudioDecoderBase> OpenBgm(Filesystem_Stream::InputStream stream, int volume, int pitch, int fadein);
+	void StopMidiOut();
+
+	/** Game thread: queues a command, keeps it when the queue is full */
+	void PushCommand(Command cmd);
+	/** Game thread: retries held back commands and frees retired decoders */
+	void FlushCommands();
+	/** Audio thread: applies all queued commands */
+	void ProcessCommands();
+	/** Audio thread: hands a decoder to the game thread for destruction */
+	void Retire(std::unique_ptr<AudioDecoderBase> decoder);
 
 	static constexpr unsigned nr_of_se_channels = 31;
-	static constexpr unsigned nr_of_bgm_channels = 2;
+	static constexpr unsigned nr_of_bgm_channels = 1;
+
+	BgmChannel BGM_Channel;
+	SeChannel SE_Channels[nr_of_se_channels];
+
+	SpscQueue<Command, 256> commands;
+	SpscQueue<std::unique_ptr<AudioDecoderBase>, 64> retired_decoders;
+	/** Commands which did not fit into the queue, in order */
+	std::deque<Command> pending_commands;
+
+	/** Game thread view of the BGM */
+	int bgm_serial = 0;
+	bool bgm_stopped = true;
+	bool bgm_midi_out_used = false;
 
-	static BgmChannel BGM_Channels[nr_of_bgm_channels];
-	static SeChannel SE_Channels[nr_of_se_channels];
-	static bool BGM_PlayedOnceIndicator;
-	static bool Muted;
+	/** Published by the audio thread */
+	std::atomic<int> bgm_ticks = { -1 };
+	std::atomic<int> bgm_played_once_serial = { 0 };
+	std::atomic<unsigned> se_channels_used = { 0 };
 
 	static std::vector<int16_t> sample_buffer;
 	static std::vector<uint8_t> scrap_buffer;
 	static unsigned scrap_buffer_size;
 	static std::vector<float> mixer_buffer;
+	static std::vector<float> channel_buffer;
 
 	static std::unique_ptr<GenericAudioMidiOut> midi_thread;
 };
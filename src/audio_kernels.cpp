@@ -0,0 +1,168 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <cmath>
+#include <initializer_list>
+#include "audio_kernels.h"
+
+namespace {
+	template <typename T>
+	inline float SampleValue(T sample) {
+		return static_cast<float>(sample);
+	}
+
+	inline float SampleValue(uint8_t sample) {
+		return static_cast<float>(sample - 128);
+	}
+
+	inline float SampleValue(uint16_t sample) {
+		return static_cast<float>(sample - 32768);
+	}
+
+	inline float SampleValue(uint32_t sample) {
+		return static_cast<float>(static_cast<int32_t>(sample ^ 0x80000000u));
+	}
+
+	template <typename T>
+	void MixSamples(const void* src, float* dst, int count, float gain) {
+		auto* samples = static_cast<const T*>(src);
+		for (int i = 0; i < count; ++i) {
+			dst[i] += SampleValue(samples[i]) * gain;
+		}
+	}
+
+	using MixFn = void(*)(AudioKernels::Format, const void*, float*, int, float);
+	using ToS16Fn = void(*)(const float*, int16_t*, int, float);
+
+	MixFn GetMix(AudioKernels::Isa isa) {
+		using AudioKernels::Isa;
+		switch (isa) {
+#ifdef EP_PIXEL_KERNELS_X86
+			case Isa::SSE2:
+				return AudioKernels::detail::MixSSE2;
+			case Isa::AVX2:
+				return AudioKernels::detail::MixAVX2;
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+			case Isa::NEON:
+				return AudioKernels::detail::MixNEON;
+#endif
+			default:
+				return AudioKernels::detail::MixScalar;
+		}
+	}
+
+	ToS16Fn GetToS16(AudioKernels::Isa isa) {
+		using AudioKernels::Isa;
+		switch (isa) {
+#ifdef EP_PIXEL_KERNELS_X86
+			case Isa::SSE2:
+				return AudioKernels::detail::ToS16SSE2;
+			case Isa::AVX2:
+				return AudioKernels::detail::ToS16AVX2;
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+			case Isa::NEON:
+				return AudioKernels::detail::ToS16NEON;
+#endif
+			default:
+				return AudioKernels::detail::ToS16Scalar;
+		}
+	}
+
+	AudioKernels::Isa DetectIsa() {
+		using AudioKernels::Isa;
+		for (auto isa: { Isa::AVX2, Isa::SSE2, Isa::NEON }) {
+			if (PixelKernels::IsSupported(isa)) {
+				return isa;
+			}
+		}
+		return Isa::Scalar;
+	}
+
+	AudioKernels::Isa active_isa = DetectIsa();
+	MixFn mix = GetMix(active_isa);
+	ToS16Fn to_s16 = GetToS16(active_isa);
+}
+
+void AudioKernels::detail::MixScalar(Format format, const void* src, float* dst, int count, float volume) {
+	const float gain = volume * SampleScale(format);
+	switch (format) {
+		case Format::S8:
+			MixSamples<int8_t>(src, dst, count, gain);
+			break;
+		case Format::U8:
+			MixSamples<uint8_t>(src, dst, count, gain);
+			break;
+		case Format::S16:
+			MixSamples<int16_t>(src, dst, count, gain);
+			break;
+		case Format::U16:
+			MixSamples<uint16_t>(src, dst, count, gain);
+			break;
+		case Format::S32:
+			MixSamples<int32_t>(src, dst, count, gain);
+			break;
+		case Format::U32:
+			MixSamples<uint32_t>(src, dst, count, gain);
+			break;
+		case Format::F32:
+			MixSamples<float>(src, dst, count, gain);
+			break;
+	}
+}
+
+void AudioKernels::detail::ToS16Scalar(const float* src, int16_t* dst, int count, float total_volume) {
+	const bool compress = total_volume > 1.0f;
+	const float ratio = compress ? (1.0f - compress_threshold) / (total_volume - compress_threshold) : 1.0f;
+
+	for (int i = 0; i < count; ++i) {
+		float sample = src[i];
+		if (compress) {
+			float level = std::fabs(sample);
+			if (level > compress_threshold) {
+				sample = std::copysign(compress_threshold + (level - compress_threshold) * ratio, sample);
+			}
+		}
+		sample *= 32768.0f;
+		sample = sample < -32768.0f ? -32768.0f : sample > 32767.0f ? 32767.0f : sample;
+		dst[i] = static_cast<int16_t>(sample);
+	}
+}
+
+void AudioKernels::Mix(Format format, const void* src, float* dst, int count, float volume) {
+	mix(format, src, dst, count, volume);
+}
+
+void AudioKernels::ToS16(const float* src, int16_t* dst, int count, float total_volume) {
+	to_s16(src, dst, count, total_volume);
+}
+
+AudioKernels::Isa AudioKernels::GetIsa() {
+	return active_isa;
+}
+
+bool AudioKernels::SetIsa(Isa isa) {
+	if (!PixelKernels::IsSupported(isa)) {
+		return false;
+	}
+	active_isa = isa;
+	mix = GetMix(isa);
+	to_s16 = GetToS16(isa);
+	return true;
+}
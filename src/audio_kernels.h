@@ -0,0 +1,99 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_AUDIO_KERNELS_H
+#define EP_AUDIO_KERNELS_H
+
+// Headers
+#include <cstdint>
+#include "audio_decoder_base.h"
+#include "pixel_kernels.h"
+
+/**
+ * Per sample loops of the GenericAudio mixer.
+ *
+ * Like PixelKernels every kernel has a scalar implementation and SSE2,
+ * AVX2 or NEON implementations. The CPU detection of PixelKernels is used
+ * and the fastest supported implementation is selected at startup.
+ */
+namespace AudioKernels {
+	using Isa = PixelKernels::Isa;
+	using Format = AudioDecoderBase::Format;
+
+	/**
+	 * Converts samples to float and adds them, scaled by volume, to dst.
+	 * The format is dispatched once per call, not per sample.
+	 *
+	 * @param format sample format of src
+	 * @param src samples
+	 * @param dst mixing buffer of count floats
+	 * @param count number of samples
+	 * @param volume volume, 1.0 is full volume
+	 */
+	void Mix(Format format, const void* src, float* dst, int count, float volume);
+
+	/**
+	 * Converts mixed samples to signed 16 bit. When the sum of all channel
+	 * volumes is above 1.0 samples louder than 0.8 are compressed, then the
+	 * result is clamped to the 16 bit range.
+	 *
+	 * @param src mixing buffer
+	 * @param dst output samples
+	 * @param count number of samples
+	 * @param total_volume sum of the volumes of all mixed channels
+	 */
+	void ToS16(const float* src, int16_t* dst, int count, float total_volume);
+
+	/** @return instruction set currently used */
+	Isa GetIsa();
+
+	/**
+	 * Changes the instruction set used. For benchmarks and tests.
+	 *
+	 * @param isa instruction set
+	 * @return false when the CPU does not support isa, the setting is not changed then
+	 */
+	bool SetIsa(Isa isa);
+
+	namespace detail {
+		/** Parameters of the dynamic range compression in ToS16 */
+		constexpr float compress_threshold = 0.8f;
+
+		/** @return factor which converts a sample of format to the range -1.0 to 1.0 */
+		constexpr float SampleScale(Format format) {
+			return format == Format::S8 || format == Format::U8 ? 1.0f / 128.0f
+				: format == Format::S16 || format == Format::U16 ? 1.0f / 32768.0f
+				: format == Format::S32 || format == Format::U32 ? 1.0f / 2147483648.0f
+				: 1.0f;
+		}
+
+		void MixScalar(Format format, const void* src, float* dst, int count, float volume);
+		void ToS16Scalar(const float* src, int16_t* dst, int count, float total_volume);
+#ifdef EP_PIXEL_KERNELS_X86
+		void MixSSE2(Format format, const void* src, float* dst, int count, float volume);
+		void MixAVX2(Format format, const void* src, float* dst, int count, float volume);
+		void ToS16SSE2(const float* src, int16_t* dst, int count, float total_volume);
+		void ToS16AVX2(const float* src, int16_t* dst, int count, float total_volume);
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+		void MixNEON(Format format, const void* src, float* dst, int count, float volume);
+		void ToS16NEON(const float* src, int16_t* dst, int count, float total_volume);
+#endif
+	}
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_X86
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#  pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#  pragma GCC push_options
+#  pragma GCC target("avx2")
+#endif
+
+// Same algorithm as audio_kernels_sse2.cpp with 8 samples per step.
+// AVX2 widens 8, 16 and 32 bit integers directly.
+namespace {
+	using AudioKernels::Format;
+
+	inline void Accumulate(float* dst, __m256 v, __m256 gain) {
+		_mm256_storeu_ps(dst, _mm256_add_ps(_mm256_loadu_ps(dst), _mm256_mul_ps(v, gain)));
+	}
+
+	inline void Accumulate(float* dst, __m256i v, __m256 gain) {
+		Accumulate(dst, _mm256_cvtepi32_ps(v), gain);
+	}
+
+	int Mix8Bit(const void* src, float* dst, int count, __m256 gain, __m128i bias) {
+		auto* samples = static_cast<const uint8_t*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = _mm_xor_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(samples + i)), bias);
+			Accumulate(dst + i, _mm256_cvtepi8_epi32(v), gain);
+		}
+		return i;
+	}
+
+	int Mix16Bit(const void* src, float* dst, int count, __m256 gain, __m128i bias) {
+		auto* samples = static_cast<const uint16_t*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), bias);
+			Accumulate(dst + i, _mm256_cvtepi16_epi32(v), gain);
+		}
+		return i;
+	}
+
+	int Mix32Bit(const void* src, float* dst, int count, __m256 gain, __m256i bias) {
+		auto* samples = static_cast<const uint32_t*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(samples + i)), bias);
+			Accumulate(dst + i, v, gain);
+		}
+		return i;
+	}
+
+	int MixFloat(const void* src, float* dst, int count, __m256 gain) {
+		auto* samples = static_cast<const float*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			Accumulate(dst + i, _mm256_loadu_ps(samples + i), gain);
+		}
+		return i;
+	}
+
+	inline __m256 Compress(__m256 sample, __m256 threshold, __m256 ratio) {
+		const auto sign_mask = _mm256_set1_ps(-0.0f);
+		auto sign = _mm256_and_ps(sample, sign_mask);
+		auto level = _mm256_andnot_ps(sign_mask, sample);
+		auto loud = _mm256_cmp_ps(level, threshold, _CMP_GT_OQ);
+		auto compressed = _mm256_add_ps(threshold, _mm256_mul_ps(_mm256_sub_ps(level, threshold), ratio));
+		return _mm256_or_ps(_mm256_blendv_ps(level, compressed, loud), sign);
+	}
+
+	inline __m256i ToInt(__m256 sample) {
+		sample = _mm256_mul_ps(sample, _mm256_set1_ps(32768.0f));
+		sample = _mm256_min_ps(_mm256_max_ps(sample, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f));
+		return _mm256_cvttps_epi32(sample);
+	}
+}
+
+void AudioKernels::detail::MixAVX2(Format format, const void* src, float* dst, int count, float volume) {
+	const auto gain = _mm256_set1_ps(volume * SampleScale(format));
+	int done = 0;
+	int samplesize = 1;
+
+	switch (format) {
+		case Format::S8:
+			done = Mix8Bit(src, dst, count, gain, _mm_setzero_si128());
+			break;
+		case Format::U8:
+			done = Mix8Bit(src, dst, count, gain, _mm_set1_epi8(static_cast<char>(0x80)));
+			break;
+		case Format::S16:
+			done = Mix16Bit(src, dst, count, gain, _mm_setzero_si128());
+			samplesize = 2;
+			break;
+		case Format::U16:
+			done = Mix16Bit(src, dst, count, gain, _mm_set1_epi16(static_cast<short>(0x8000)));
+			samplesize = 2;
+			break;
+		case Format::S32:
+			done = Mix32Bit(src, dst, count, gain, _mm256_setzero_si256());
+			samplesize = 4;
+			break;
+		case Format::U32:
+			done = Mix32Bit(src, dst, count, gain, _mm256_set1_epi32(static_cast<int>(0x80000000u)));
+			samplesize = 4;
+			break;
+		case Format::F32:
+			done = MixFloat(src, dst, count, gain);
+			samplesize = 4;
+			break;
+	}
+
+	MixScalar(format, static_cast<const uint8_t*>(src) + done * samplesize, dst + done, count - done, volume);
+}
+
+void AudioKernels::detail::ToS16AVX2(const float* src, int16_t* dst, int count, float total_volume) {
+	const bool compress = total_volume > 1.0f;
+	const auto threshold = _mm256_set1_ps(compress_threshold);
+	const auto ratio = _mm256_set1_ps(compress ? (1.0f - compress_threshold) / (total_volume - compress_threshold) : 1.0f);
+
+	int i = 0;
+	for (; i + 16 <= count; i += 16) {
+		auto lo = _mm256_loadu_ps(src + i);
+		auto hi = _mm256_loadu_ps(src + i + 8);
+		if (compress) {
+			lo = Compress(lo, threshold, ratio);
+			hi = Compress(hi, threshold, ratio);
+		}
+		// packs works per 128 bit lane, restore the sample order
+		auto packed = _mm256_packs_epi32(ToInt(lo), ToInt(hi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute4x64_epi64(packed, 0xD8));
+	}
+
+	ToS16Scalar(src + i, dst + i, count - i, total_volume);
+}
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(__GNUC__)
+#  pragma GCC pop_options
+#endif
+
+#endif
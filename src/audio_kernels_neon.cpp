@@ -0,0 +1,158 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_NEON
+
+#include <arm_neon.h>
+
+// Same algorithm as audio_kernels_sse2.cpp with 8 samples per step.
+namespace {
+	using AudioKernels::Format;
+
+	inline void Accumulate(float* dst, float32x4_t v, float32x4_t gain) {
+		vst1q_f32(dst, vaddq_f32(vld1q_f32(dst), vmulq_f32(v, gain)));
+	}
+
+	inline void Accumulate(float* dst, int32x4_t v, float32x4_t gain) {
+		Accumulate(dst, vcvtq_f32_s32(v), gain);
+	}
+
+	// 8 signed 16 bit samples
+	inline void Accumulate16(float* dst, int16x8_t v, float32x4_t gain) {
+		Accumulate(dst, vmovl_s16(vget_low_s16(v)), gain);
+		Accumulate(dst + 4, vmovl_s16(vget_high_s16(v)), gain);
+	}
+
+	int Mix8Bit(const void* src, float* dst, int count, float32x4_t gain, uint8_t bias) {
+		auto* samples = static_cast<const uint8_t*>(src);
+		const auto bias8 = vdup_n_u8(bias);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = vreinterpret_s8_u8(veor_u8(vld1_u8(samples + i), bias8));
+			Accumulate16(dst + i, vmovl_s8(v), gain);
+		}
+		return i;
+	}
+
+	int Mix16Bit(const void* src, float* dst, int count, float32x4_t gain, uint16_t bias) {
+		auto* samples = static_cast<const uint16_t*>(src);
+		const auto bias16 = vdupq_n_u16(bias);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = vreinterpretq_s16_u16(veorq_u16(vld1q_u16(samples + i), bias16));
+			Accumulate16(dst + i, v, gain);
+		}
+		return i;
+	}
+
+	int Mix32Bit(const void* src, float* dst, int count, float32x4_t gain, uint32_t bias) {
+		auto* samples = static_cast<const uint32_t*>(src);
+		const auto bias32 = vdupq_n_u32(bias);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			Accumulate(dst + i, vreinterpretq_s32_u32(veorq_u32(vld1q_u32(samples + i), bias32)), gain);
+			Accumulate(dst + i + 4, vreinterpretq_s32_u32(veorq_u32(vld1q_u32(samples + i + 4), bias32)), gain);
+		}
+		return i;
+	}
+
+	int MixFloat(const void* src, float* dst, int count, float32x4_t gain) {
+		auto* samples = static_cast<const float*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			Accumulate(dst + i, vld1q_f32(samples + i), gain);
+			Accumulate(dst + i + 4, vld1q_f32(samples + i + 4), gain);
+		}
+		return i;
+	}
+
+	inline float32x4_t Compress(float32x4_t sample, float32x4_t threshold, float32x4_t ratio) {
+		auto level = vabsq_f32(sample);
+		auto loud = vcgtq_f32(level, threshold);
+		auto compressed = vaddq_f32(threshold, vmulq_f32(vsubq_f32(level, threshold), ratio));
+		level = vbslq_f32(loud, compressed, level);
+		// copy the sign bit of sample
+		return vbslq_f32(vdupq_n_u32(0x80000000u), sample, level);
+	}
+
+	inline int16x4_t ToInt(float32x4_t sample) {
+		sample = vmulq_f32(sample, vdupq_n_f32(32768.0f));
+		sample = vminq_f32(vmaxq_f32(sample, vdupq_n_f32(-32768.0f)), vdupq_n_f32(32767.0f));
+		return vqmovn_s32(vcvtq_s32_f32(sample));
+	}
+}
+
+void AudioKernels::detail::MixNEON(Format format, const void* src, float* dst, int count, float volume) {
+	const auto gain = vdupq_n_f32(volume * SampleScale(format));
+	int done = 0;
+	int samplesize = 1;
+
+	switch (format) {
+		case Format::S8:
+			done = Mix8Bit(src, dst, count, gain, 0);
+			break;
+		case Format::U8:
+			done = Mix8Bit(src, dst, count, gain, 0x80);
+			break;
+		case Format::S16:
+			done = Mix16Bit(src, dst, count, gain, 0);
+			samplesize = 2;
+			break;
+		case Format::U16:
+			done = Mix16Bit(src, dst, count, gain, 0x8000);
+			samplesize = 2;
+			break;
+		case Format::S32:
+			done = Mix32Bit(src, dst, count, gain, 0);
+			samplesize = 4;
+			break;
+		case Format::U32:
+			done = Mix32Bit(src, dst, count, gain, 0x80000000u);
+			samplesize = 4;
+			break;
+		case Format::F32:
+			done = MixFloat(src, dst, count, gain);
+			samplesize = 4;
+			break;
+	}
+
+	MixScalar(format, static_cast<const uint8_t*>(src) + done * samplesize, dst + done, count - done, volume);
+}
+
+void AudioKernels::detail::ToS16NEON(const float* src, int16_t* dst, int count, float total_volume) {
+	const bool compress = total_volume > 1.0f;
+	const auto threshold = vdupq_n_f32(compress_threshold);
+	const auto ratio = vdupq_n_f32(compress ? (1.0f - compress_threshold) / (total_volume - compress_threshold) : 1.0f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		auto lo = vld1q_f32(src + i);
+		auto hi = vld1q_f32(src + i + 4);
+		if (compress) {
+			lo = Compress(lo, threshold, ratio);
+			hi = Compress(hi, threshold, ratio);
+		}
+		vst1q_s16(dst + i, vcombine_s16(ToInt(lo), ToInt(hi)));
+	}
+
+	ToS16Scalar(src + i, dst + i, count - i, total_volume);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "audio_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_X86
+
+#include <emmintrin.h>
+
+#if defined(__clang__)
+#  pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#  pragma GCC push_options
+#  pragma GCC target("sse2")
+#endif
+
+// Unsigned samples are made signed by flipping the top bit, then all
+// formats are widened to 32 bit integers and converted to float.
+// The operations match the scalar code exactly.
+namespace {
+	using AudioKernels::Format;
+
+	inline void Accumulate(float* dst, __m128 v, __m128 gain) {
+		_mm_storeu_ps(dst, _mm_add_ps(_mm_loadu_ps(dst), _mm_mul_ps(v, gain)));
+	}
+
+	inline void Accumulate(float* dst, __m128i v, __m128 gain) {
+		Accumulate(dst, _mm_cvtepi32_ps(v), gain);
+	}
+
+	// 8 signed 16 bit samples
+	inline void Accumulate16(float* dst, __m128i v, __m128 gain) {
+		Accumulate(dst, _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), gain);
+		Accumulate(dst + 4, _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), gain);
+	}
+
+	int Mix8Bit(const void* src, float* dst, int count, __m128 gain, __m128i bias) {
+		auto* samples = static_cast<const uint8_t*>(src);
+		int i = 0;
+		for (; i + 16 <= count; i += 16) {
+			auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), bias);
+			Accumulate16(dst + i, _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8), gain);
+			Accumulate16(dst + i + 8, _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8), gain);
+		}
+		return i;
+	}
+
+	int Mix16Bit(const void* src, float* dst, int count, __m128 gain, __m128i bias) {
+		auto* samples = static_cast<const uint16_t*>(src);
+		int i = 0;
+		for (; i + 8 <= count; i += 8) {
+			auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), bias);
+			Accumulate16(dst + i, v, gain);
+		}
+		return i;
+	}
+
+	int Mix32Bit(const void* src, float* dst, int count, __m128 gain, __m128i bias) {
+		auto* samples = static_cast<const uint32_t*>(src);
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i)), bias);
+			Accumulate(dst + i, v, gain);
+		}
+		return i;
+	}
+
+	int MixFloat(const void* src, float* dst, int count, __m128 gain) {
+		auto* samples = static_cast<const float*>(src);
+		int i = 0;
+		for (; i + 4 <= count; i += 4) {
+			Accumulate(dst + i, _mm_loadu_ps(samples + i), gain);
+		}
+		return i;
+	}
+
+	inline __m128 Compress(__m128 sample, __m128 threshold, __m128 ratio) {
+		const auto sign_mask = _mm_set1_ps(-0.0f);
+		auto sign = _mm_and_ps(sample, sign_mask);
+		auto level = _mm_andnot_ps(sign_mask, sample);
+		auto loud = _mm_cmpgt_ps(level, threshold);
+		auto compressed = _mm_add_ps(threshold, _mm_mul_ps(_mm_sub_ps(level, threshold), ratio));
+		level = _mm_or_ps(_mm_and_ps(loud, compressed), _mm_andnot_ps(loud, level));
+		return _mm_or_ps(level, sign);
+	}
+
+	inline __m128i ToInt(__m128 sample) {
+		sample = _mm_mul_ps(sample, _mm_set1_ps(32768.0f));
+		sample = _mm_min_ps(_mm_max_ps(sample, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f));
+		return _mm_cvttps_epi32(sample);
+	}
+}
+
+void AudioKernels::detail::MixSSE2(Format format, const void* src, float* dst, int count, float volume) {
+	const auto gain = _mm_set1_ps(volume * SampleScale(format));
+	int done = 0;
+	int samplesize = 1;
+
+	switch (format) {
+		case Format::S8:
+			done = Mix8Bit(src, dst, count, gain, _mm_setzero_si128());
+			break;
+		case Format::U8:
+			done = Mix8Bit(src, dst, count, gain, _mm_set1_epi8(static_cast<char>(0x80)));
+			break;
+		case Format::S16:
+			done = Mix16Bit(src, dst, count, gain, _mm_setzero_si128());
+			samplesize = 2;
+			break;
+		case Format::U16:
+			done = Mix16Bit(src, dst, count, gain, _mm_set1_epi16(static_cast<short>(0x8000)));
+			samplesize = 2;
+			break;
+		case Format::S32:
+			done = Mix32Bit(src, dst, count, gain, _mm_setzero_si128());
+			samplesize = 4;
+			break;
+		case Format::U32:
+			done = Mix32Bit(src, dst, count, gain, _mm_set1_epi32(static_cast<int>(0x80000000u)));
+			samplesize = 4;
+			break;
+		case Format::F32:
+			done = MixFloat(src, dst, count, gain);
+			samplesize = 4;
+			break;
+	}
+
+	MixScalar(format, static_cast<const uint8_t*>(src) + done * samplesize, dst + done, count - done, volume);
+}
+
+void AudioKernels::detail::ToS16SSE2(const float* src, int16_t* dst, int count, float total_volume) {
+	const bool compress = total_volume > 1.0f;
+	const auto threshold = _mm_set1_ps(compress_threshold);
+	const auto ratio = _mm_set1_ps(compress ? (1.0f - compress_threshold) / (total_volume - compress_threshold) : 1.0f);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		auto lo = _mm_loadu_ps(src + i);
+		auto hi = _mm_loadu_ps(src + i + 4);
+		if (compress) {
+			lo = Compress(lo, threshold, ratio);
+			hi = Compress(hi, threshold, ratio);
+		}
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_packs_epi32(ToInt(lo), ToInt(hi)));
+	}
+
+	ToS16Scalar(src + i, dst + i, count - i, total_volume);
+}
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(__GNUC__)
+#  pragma GCC pop_options
+#endif
+
+#endif
@@ -18,65 +18,170 @@
 // Headers
 #include <cassert>
 #include <cstring>
-#include <map>
+#include <functional>
 #include <memory>
-#include <set>
+#include <unordered_map>
 #include "audio_resampler.h"
 #include "audio_secache.h"
-#include "game_clock.h"
 #include "filefinder.h"
 #include "output.h"
 
-using namespace std::chrono_literals;
-
 namespace {
-	typedef std::map<std::string, AudioSeRef> cache_type;
+	struct CacheKey {
+		std::string filename;
+		/** Pitch and output format of a resampled variant, all 0 for the decoded sample */
+		int pitch = 0;
+		int frequency = 0;
+		int format = 0;
+		int channels = 0;
+
+		bool operator==(const CacheKey& o) const {
+			return pitch == o.pitch && frequency == o.frequency && format == o.format
+				&& channels == o.channels && filename == o.filename;
+		}
+	};
+
+	struct CacheKeyHash {
+		size_t operator()(const CacheKey& key) const {
+			size_t h = std::hash<std::string>()(key.filename);
+			for (int v : { key.pitch, key.frequency, key.format, key.channels }) {
+				h ^= std::hash<int>()(v) + 0x9e3779b9 + (h << 6) + (h >> 2);
+			}
+			return h;
+		}
+	};
+
+	struct CacheItem {
+		AudioSeRef se;
+		const CacheKey* key = nullptr;
+		// Doubly linked list in least recently used order
+		CacheItem* prev = nullptr;
+		CacheItem* next = nullptr;
+	};
+
+	using cache_type = std::unordered_map<CacheKey, CacheItem, CacheKeyHash>;
 
 	cache_type cache;
+	CacheItem* lru_head = nullptr;
+	CacheItem* lru_tail = nullptr;
 
-	constexpr int cache_limit = 3 * 1024 * 1024;
-	int cache_size = 0;
+	size_t cache_limit = 8 * 1024 * 1024;
+	size_t cache_size = 0;
 
-	void FreeCacheMemory() {
-		auto cur_time = Game_Clock::GetFrameTime();
+	CacheKey MakeKey(const std::string& filename) {
+		CacheKey key;
+		key.filename = filename;
+		return key;
+	}
 
-		for (auto it = cache.begin(); it != cache.end(); ) {
-			if (it->second.use_count() > 1) {
-				// SE is currently playing
-				++it;
-				continue;
-			}
+	CacheKey MakeKey(const std::string& filename, int pitch, int frequency, AudioDecoder::Format format, int channels) {
+		CacheKey key;
+		key.filename = filename;
+		key.pitch = pitch;
+		key.frequency = frequency;
+		key.format = static_cast<int>(format) + 1;
+		key.channels = channels;
+		return key;
+	}
 
-			if (cache_size <= cache_limit && cur_time - it->second->last_access < 3s) {
-				// Below memory limit and last access < 3s
-				++it;
-				continue;
+	void Unlink(CacheItem& item) {
+		(item.prev ? item.prev->next : lru_head) = item.next;
+		(item.next ? item.next->prev : lru_tail) = item.prev;
+		item.prev = nullptr;
+		item.next = nullptr;
+	}
+
+	void Append(CacheItem& item) {
+		item.prev = lru_tail;
+		item.next = nullptr;
+		(lru_tail ? lru_tail->next : lru_head) = &item;
+		lru_tail = &item;
+	}
+
+	void Touch(CacheItem& item) {
+		if (lru_tail != &item) {
+			Unlink(item);
+			Append(item);
+		}
+	}
+
+	void Evict(CacheItem& item) {
+#ifdef CACHE_DEBUG
+		Output::Debug("SE: Freeing memory of {} ({})", item.key->filename, item.key->pitch);
+#endif
+		cache_size -= item.se->buffer.size();
+		Unlink(item);
+		cache.erase(*item.key);
+	}
+
+	void FreeCacheMemory() {
+		for (CacheItem* item = lru_head; item && cache_size > cache_limit; ) {
+			CacheItem* next = item->next;
+			// Samples which are still referenced are playing
+			if (item->se.use_count() == 1) {
+				Evict(*item);
 			}
+			item = next;
+		}
 
 #ifdef CACHE_DEBUG
-			Output::Debug("SE: Freeing memory of {}", it->first);
+		Output::Debug("SE cache size: {}", cache_size / 1024.0 / 1024);
 #endif
+	}
 
-			cache_size -= it->second->buffer.size();
+	AudioSeRef Find(const CacheKey& key) {
+		auto it = cache.find(key);
+		if (it == cache.end()) {
+			return nullptr;
+		}
+		Touch(it->second);
+		return it->second.se;
+	}
 
-			it = cache.erase(it);
+	/**
+	 * Adds a sample to the cache and frees the least recently used samples
+	 * when the limit is exceeded.
+	 * Preloaded samples are only added when they fit, they never free others.
+	 *
+	 * @return whether the sample was added
+	 */
+	bool Insert(CacheKey key, const AudioSeRef& se, bool preload) {
+		if (preload && cache_size + se->buffer.size() > cache_limit) {
+			return false;
 		}
 
+		auto it = cache.find(key);
+		if (it != cache.end()) {
+			Evict(it->second);
+		}
+
+		it = cache.emplace(std::move(key), CacheItem()).first;
+		auto& item = it->second;
+		item.se = se;
+		item.key = &it->first;
+		Append(item);
+
+		cache_size += se->buffer.size();
+
 #ifdef CACHE_DEBUG
-		Output::Debug("SE cache size: {}", cache_size / 1024.0 / 1024);
+		Output::Debug("SE cache size (Add): {}", cache_size / 1024.0 / 1024.0);
 #endif
+
+		if (!preload) {
+			// The caller holds a reference, so se itself is not freed
+			FreeCacheMemory();
+		}
+		return true;
 	}
 }
 
 std::unique_ptr<AudioSeCache> AudioSeCache::Create(Filesystem_Stream::InputStream stream) {
 	std::unique_ptr<AudioSeCache> se;
 
-	auto const it = cache.find(ToString(stream.GetName()));
-
 	se = std::make_unique<AudioSeCache>();
 	se->filename = ToString(stream.GetName());
 
-	if (it == cache.end()) {
+	if (!se->IsCached()) {
 		// Not in cache
 		if (!stream) {
 			se.reset();
@@ -113,16 +218,16 @@ void AudioSeCache::GetFormat(int& frequency, AudioDecoder::Format& format, int&
 }
 
 bool AudioSeCache::IsCached() const {
-	return cache.find(filename) != cache.end();
+	return cache.find(MakeKey(filename)) != cache.end();
 }
 
 bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format, int& channels) const {
-	cache_type::const_iterator it = cache.find(filename);
+	cache_type::const_iterator it = cache.find(MakeKey(filename));
 
 	if (it != cache.end()) {
-		frequency = (*it).second->frequency;
-		format = (*it).second->format;
-		channels = (*it).second->channels;
+		frequency = (*it).second.se->frequency;
+		format = (*it).second.se->format;
+		channels = (*it).second.se->channels;
 
 		return true;
 	}
@@ -130,66 +235,125 @@ bool AudioSeCache::GetCachedFormat(int& frequency, AudioDecoder::Format& format,
 	return false;
 }
 
-std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
-	AudioSeRef se;
-
-	if (IsCached()) {
-		se = cache.find(filename)->second;
-		se->last_access = Game_Clock::GetFrameTime();
-
-		std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
-#ifdef USE_AUDIO_RESAMPLER
-		dec = std::make_unique<AudioResampler>(std::move(dec));
-#endif
-		Filesystem_Stream::InputStream is;
-		dec->Open(std::move(is));
-		return dec;
+AudioSeRef AudioSeCache::GetOrDecode(bool preload) {
+	auto key = MakeKey(filename);
+	AudioSeRef se = Find(key);
+	if (se) {
+		return se;
 	}
 
 	// Not cached yet: Decode the sample without any resampling
-
-	if (!se) {
-		se.reset(new AudioSeData());
-	}
-
 	assert(audio_decoder);
 
+	se = std::make_shared<AudioSeData>();
 	audio_decoder->GetFormat(se->frequency, se->format, se->channels);
 	se->buffer = audio_decoder->DecodeAll();
+	audio_decoder.reset();
 
-	cache.insert(std::make_pair(filename, se));
+	if (!Insert(std::move(key), se, preload)) {
+		return nullptr;
+	}
+	return se;
+}
 
-	cache_size += se->buffer.size();
+AudioSeRef AudioSeCache::GetOrResample(int pitch, int frequency, AudioDecoder::Format format, int channels, bool preload) {
+	auto key = MakeKey(filename, pitch, frequency, format, channels);
+	AudioSeRef se = Find(key);
+	if (se) {
+		return se;
+	}
 
-#ifdef CACHE_DEBUG
-	Output::Debug("SE cache size (Add): {}", cache_size / 1024.0 / 1024.0);
+	AudioSeRef raw = GetOrDecode(preload);
+	if (!raw) {
+		return nullptr;
+	}
+	if (pitch == 100 && raw->frequency == frequency && raw->format == format && raw->channels == channels) {
+		// Already in the output format
+		return raw;
+	}
+
+#ifdef USE_AUDIO_RESAMPLER
+	std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioResampler>(std::make_unique<AudioSeDecoder>(raw));
+	Filesystem_Stream::InputStream is;
+	dec->Open(std::move(is));
+	dec->SetPitch(pitch);
+	dec->SetFormat(frequency, format, channels);
+
+	se = std::make_shared<AudioSeData>();
+	dec->GetFormat(se->frequency, se->format, se->channels);
+	if (se->frequency != frequency || se->channels != channels) {
+		// The resampler can't produce this output, the mixer would have to convert it again
+		return nullptr;
+	}
+	se->buffer = dec->DecodeAll();
+
+	if (!Insert(std::move(key), se, preload)) {
+		return nullptr;
+	}
+	return se;
+#else
+	return nullptr;
 #endif
+}
 
-	FreeCacheMemory();
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder() {
+	AudioSeRef se = GetOrDecode(false);
 
-	std::unique_ptr<AudioDecoderBase> dec = std::unique_ptr<AudioDecoderBase>(new AudioSeDecoder(se));
+	std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
 #ifdef USE_AUDIO_RESAMPLER
-	dec = std::unique_ptr<AudioDecoderBase>(new AudioResampler(std::move(dec)));
+	dec = std::make_unique<AudioResampler>(std::move(dec));
 #endif
 	Filesystem_Stream::InputStream is;
 	dec->Open(std::move(is));
 	return dec;
 }
 
+std::unique_ptr<AudioDecoderBase> AudioSeCache::CreateSeDecoder(int pitch, int frequency, AudioDecoder::Format format, int channels) {
+	AudioSeRef se = GetOrResample(pitch, frequency, format, channels, false);
+	if (!se) {
+		auto dec = CreateSeDecoder();
+		dec->SetPitch(pitch);
+		dec->SetFormat(frequency, format, channels);
+		return dec;
+	}
+
+	// Plays the variant as is, pitch and format are already applied
+	std::unique_ptr<AudioDecoderBase> dec = std::make_unique<AudioSeDecoder>(se);
+	Filesystem_Stream::InputStream is;
+	dec->Open(std::move(is));
+	return dec;
+}
+
+bool AudioSeCache::Preload(int pitch, int frequency, AudioDecoder::Format format, int channels) {
+	if (cache.find(MakeKey(filename, pitch, frequency, format, channels)) != cache.end()) {
+		return true;
+	}
+	if (cache_size >= cache_limit) {
+		return false;
+	}
+	return GetOrResample(pitch, frequency, format, channels, true) != nullptr;
+}
+
 AudioSeRef AudioSeCache::GetSeData() const {
-    assert(IsCached());
+	assert(IsCached());
 
-    return cache.find(filename)->second;
+	return cache.find(MakeKey(filename))->second.se;
 };
 
 void AudioSeCache::Clear() {
 	cache_size = 0;
+	lru_head = nullptr;
+	lru_tail = nullptr;
 	cache.clear();
 }
 
+void AudioSeCache::SetLimit(size_t bytes) {
+	cache_limit = bytes;
+	FreeCacheMemory();
+}
+
 AudioSeDecoder::AudioSeDecoder(AudioSeRef se) :
 	se(se) {
-	se->last_access = Game_Clock::GetFrameTime();
 }
 
 bool AudioSeDecoder::IsFinished() const {
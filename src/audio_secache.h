@@ -23,7 +23,6 @@
 #include <string>
 #include <vector>
 #include <memory>
-#include <map>
 
 #include "audio_decoder.h"
 #include "game_clock.h"
@@ -36,7 +35,6 @@ class AudioSeCache;
 class AudioSeData {
 public:
 	std::vector<uint8_t> buffer;
-	Game_Clock::time_point last_access;
 	int frequency;
 	AudioDecoder::Format format;
 	int channels;
@@ -70,14 +68,19 @@ private:
  * AudioSeCache provides an interface for accessing sound effects.
  * It also provides an automatic cache management, any SE is only decoded
  * once, otherwise returned from the cache.
- * The cache is flushed from recently (>10 seconds by default) unused
- * samples when it reaches the memory limit (5 MB by default).
+ * Besides the decoded sample the cache stores variants which are already
+ * resampled to the output format and a pitch, so playing the same SE again
+ * does not need the resampler.
+ * The cache is a hash map with a memory limit (see SetLimit). When the
+ * limit is exceeded the least recently used samples which are not playing
+ * are freed.
  * Uses an internal AudioDecoder for handling the decoding.
  */
 class AudioSeCache {
 public:
 	/**
 	 * Opens the passed filename with the internal audio decoder.
+	 * The decoder is only opened when the sample is not cached yet.
 	 *
 	 * @param stream Stream to the audio file
 	 * @return An AudioSeCache instance when the format was detected, otherwise null
@@ -124,6 +127,34 @@ public:
 	 */
 	std::unique_ptr<AudioDecoderBase> CreateSeDecoder();
 
+	/**
+	 * Like CreateSeDecoder but the sample is resampled to the given pitch
+	 * and output format once and this variant is cached as well.
+	 * When resampling is not available the pitch and format are set on the
+	 * returned decoder instead.
+	 *
+	 * @param pitch Pitch of the SE (100 is normal)
+	 * @param frequency Output frequency
+	 * @param format Output format
+	 * @param channels Output channels
+	 * @return Decoded sound effect
+	 */
+	std::unique_ptr<AudioDecoderBase> CreateSeDecoder(int pitch, int frequency, AudioDecoder::Format format, int channels);
+
+	/**
+	 * Decodes the sample and the variant for the given pitch and output
+	 * format into the cache without playing it.
+	 * Samples which do not fit into the remaining room of the cache are not
+	 * added, preloading never frees other samples.
+	 *
+	 * @param pitch Pitch of the SE (100 is normal)
+	 * @param frequency Output frequency
+	 * @param format Output format
+	 * @param channels Output channels
+	 * @return whether the variant is cached
+	 */
+	bool Preload(int pitch, int frequency, AudioDecoder::Format format, int channels);
+
 	/**
 	 * Returns the SE sample data handled by this SeCache.
 	 *
@@ -132,7 +163,26 @@ public:
 	AudioSeRef GetSeData() const;
 
 	static void Clear();
+
+	/**
+	 * Sets the memory limit of the cache.
+	 *
+	 * @param bytes limit in bytes
+	 */
+	static void SetLimit(size_t bytes);
 private:
+	/**
+	 * @param preload only cache the sample when it fits without freeing others
+	 * @return cached sample, nullptr when a preloaded sample did not fit
+	 */
+	AudioSeRef GetOrDecode(bool preload);
+
+	/**
+	 * @param preload only cache the variant when it fits without freeing others
+	 * @return cached variant, nullptr when it did not fit or resampling is not possible
+	 */
+	AudioSeRef GetOrResample(int pitch, int frequency, AudioDecoder::Format format, int channels, bool preload);
+
 	std::unique_ptr<AudioDecoderBase> audio_decoder;
 
 	std::string filename;
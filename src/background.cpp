@@ -115,10 +115,21 @@ int Background::Scale(int x) {
 }
 
 void Background::Draw(Bitmap& dst) {
-	Rect dst_rect = dst.GetRect();
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
+}
+
+Drawable::BandDraw Background::PrepareBandDraw(Bitmap& dst) {
+	prepared_dst_rect = dst.GetRect();
+
+	prepared_dst_rect.x += Main_Data::game_screen->GetShakeOffsetX();
+	prepared_dst_rect.y += Main_Data::game_screen->GetShakeOffsetY();
+	return BandDraw::Ready;
+}
 
-	dst_rect.x += Main_Data::game_screen->GetShakeOffsetX();
-	dst_rect.y += Main_Data::game_screen->GetShakeOffsetY();
+void Background::DrawBand(Bitmap& dst) const {
+	const auto& dst_rect = prepared_dst_rect;
 
 	if (bg_bitmap)
 		dst.TiledBlit(-Scale(bg_x), -Scale(bg_y), bg_bitmap->GetRect(), *bg_bitmap, dst_rect, 255);
@@ -31,6 +31,10 @@ public:
 	Background(int terrain_id);
 
 	void Draw(Bitmap& dst) override;
+
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
 	void Update();
 	Tone GetTone() const;
 	void SetTone(Tone tone);
@@ -54,6 +58,8 @@ private:
 	int fg_vscroll = 0;
 	int fg_x = 0;
 	int fg_y = 0;
+	/** Screen area drawn by DrawBand, moved by the screen shaking */
+	Rect prepared_dst_rect;
 
 	FileRequestBinding request_id;
 };
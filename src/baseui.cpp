@@ -61,12 +61,22 @@ BaseUi::BaseUi(const Game_ConfigVideo& cfg)
 	fps_render_window = cfg.fps_render_window.Get();
 	fps_limit = cfg.fps_limit.Get();
 	frame_limit = (fps_limit == 0 ? Game_Clock::duration(0) : Game_Clock::TimeStepFromFps(fps_limit));
+	display_scaler.SetFilter(DisplayScaler::FilterFromName(cfg.scaling_filter.Get()));
 }
 
 BitmapRef BaseUi::CaptureScreen() {
 	return Bitmap::Create(*main_surface, main_surface->GetRect());
 }
 
+bool BaseUi::QueueDisplay() {
+	UpdateDisplay();
+	return true;
+}
+
+bool BaseUi::FlushDisplay() {
+	return false;
+}
+
 void BaseUi::CleanDisplay() {
 	main_surface->Clear();
 }
@@ -30,6 +30,7 @@
 #include "keys.h"
 #include "game_config.h"
 #include "game_clock.h"
+#include "display_scaler.h"
 
 #ifdef SUPPORT_AUDIO
 	struct AudioInterface;
@@ -79,6 +80,22 @@ public:
 	 */
 	virtual void UpdateDisplay() = 0;
 
+	/**
+	 * Updates video buffer like UpdateDisplay, but the frame may be shown
+	 * by a later call while it is post-processed on the present thread.
+	 *
+	 * @return whether a frame was shown
+	 */
+	virtual bool QueueDisplay();
+
+	/**
+	 * Shows a frame passed to QueueDisplay which was not shown yet.
+	 * Called when the display surface did not change.
+	 *
+	 * @return whether a frame was shown
+	 */
+	virtual bool FlushDisplay();
+
 	/**
 	 * Gets a copy of the display surface.
 	 *
@@ -160,6 +177,12 @@ public:
 	/** @return true if the display manages the framerate */
 	bool IsFrameRateSynchronized() const;
 
+	/**
+	 * @return true if every frame simulates exactly one game time step,
+	 * independent of the real time which passed
+	 */
+	bool IsTimeStepFixed() const;
+
 	/** @return true if we should render the fps counter to the screen */
 	bool RenderFps() const;
 
@@ -182,6 +205,7 @@ protected:
 	explicit BaseUi(const Game_ConfigVideo& cfg);
 
 	void SetFrameRateSynchronized(bool value);
+	void SetTimeStepFixed(bool value);
 	void SetIsFullscreen(bool value);
 
 	/**
@@ -207,6 +231,9 @@ protected:
 	/** Surface used for zoom. */
 	BitmapRef main_surface;
 
+	/** Scaling of main_surface to the window in software, for UIs which support it */
+	DisplayScaler display_scaler;
+
 	/** Mouse position on screen relative to the window. */
 	Point mouse_pos;
 
@@ -228,6 +255,9 @@ protected:
 	/** Ui manages frame rate externally */
 	bool external_frame_rate = false;
 
+	/** One game time step per frame */
+	bool fixed_time_step = false;
+
 	/** Whether UI is currently fullscreen */
 	bool is_fullscreen = false;
 
@@ -249,6 +279,14 @@ inline void BaseUi::SetFrameRateSynchronized(bool value) {
 	external_frame_rate = value;
 }
 
+inline bool BaseUi::IsTimeStepFixed() const {
+	return fixed_time_step;
+}
+
+inline void BaseUi::SetTimeStepFixed(bool value) {
+	fixed_time_step = value;
+}
+
 inline bool BaseUi::IsFullscreen() const {
 	return is_fullscreen;
 }
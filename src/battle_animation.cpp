@@ -90,6 +90,10 @@ void BattleAnimation::OnBattle2SpriteReady(FileRequestResult* result) {
 	SetSrcRect(Rect(0, 0, 0, 0));
 }
 
+Drawable::BandDraw BattleAnimation::PrepareBandDraw(Bitmap& /* dst */) {
+	return BandDraw::Unsupported;
+}
+
 void BattleAnimation::DrawAt(Bitmap& dst, int x, int y) {
 	if (IsDone()) {
 		return;
@@ -124,13 +128,13 @@ void BattleAnimation::DrawAt(Bitmap& dst, int x, int y) {
 		SetZoomX(cell.zoom / 100.0);
 		SetZoomY(cell.zoom / 100.0);
 		SetFlipX(invert);
-		Sprite::Draw(dst);
+		BlitScreen(dst);
 	}
 
 	if (anim_frame.cells.empty()) {
 		// Draw an empty sprite when no cell is available in the animation
 		SetSrcRect(Rect(0, 0, 0, 0));
-		Sprite::Draw(dst);
+		BlitScreen(dst);
 	}
 }
 
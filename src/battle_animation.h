@@ -59,6 +59,16 @@ public:
 	/** @return true if the animation has finished **/
 	bool IsDone() const;
 
+	/**
+	 * The cells are placed around targets which move on their own and change
+	 * every frame while the animation plays, so the area is only known once
+	 * nothing is drawn anymore.
+	 */
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
+	/** Every cell is drawn with different sprite settings, which needs the serial path */
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
 	/** @return true if the animation only plays audio and doesn't display **/
 	bool IsOnlySound() const;
 
@@ -176,4 +186,8 @@ inline int BattleAnimation::GetAnimationCellHeight() const {
 	return (animation.large ? 128 : 96);
 }
 
+inline bool BattleAnimation::UpdateDamage(const Bitmap& /* dst */, Rect& /* rect */) {
+	return IsOnlySound() || IsDone();
+}
+
 #endif
@@ -39,6 +39,7 @@
 #include "output.h"
 #include "util_macro.h"
 #include "bitmap_hslrgb.h"
+#include "pixel_kernels.h"
 #include <iostream>
 
 BitmapRef Bitmap::Create(int width, int height, const Color& color) {
@@ -243,6 +244,8 @@ ImageOpacity Bitmap::ComputeImageOpacity(Rect rect) const {
 }
 
 void Bitmap::CheckPixels(uint32_t flags) {
+	++revision;
+
 	if (flags & Flag_System) {
 		DynamicFormat format(32,8,24,8,16,8,8,8,0,PF::Alpha);
 		uint32_t pixel;
@@ -277,6 +280,8 @@ void Bitmap::CheckPixels(uint32_t flags) {
 }
 
 void Bitmap::HueChangeBlit(int x, int y, Bitmap const& src, Rect const& src_rect_, double hue_) {
+	++revision;
+
 	Rect dst_rect(x, y, 0, 0), src_rect = src_rect_;
 
 	if (!Rect::AdjustRectangles(src_rect, dst_rect, src.GetRect()))
@@ -520,9 +525,34 @@ void* Bitmap::pixels() {
 	if (!bitmap) {
 		return nullptr;
 	}
-
 	return (void*) pixman_image_get_data(bitmap.get());
 }
+
+void* Bitmap::MutablePixels() {
+	++revision;
+	return pixels();
+}
+void Bitmap::SetClipRect(const Rect& rect) {
+	clip_rect = rect;
+	clip_rect.Adjust(GetRect());
+	has_clip = true;
+
+	pixman_region32_t region;
+	pixman_region32_init_rect(&region, clip_rect.x, clip_rect.y,
+		std::max(clip_rect.width, 0), std::max(clip_rect.height, 0));
+	pixman_image_set_clip_region32(bitmap.get(), &region);
+	pixman_region32_fini(&region);
+}
+
+void Bitmap::ClearClipRect() {
+	if (!has_clip) {
+		return;
+	}
+
+	has_clip = false;
+	pixman_image_set_clip_region32(bitmap.get(), nullptr);
+}
+
 void const* Bitmap::pixels() const {
 	return (void const*) pixman_image_get_data(bitmap.get());
 }
@@ -572,6 +602,8 @@ namespace {
 } // anonymous namespace
 
 void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -588,6 +620,8 @@ void Bitmap::Blit(int x, int y, Bitmap const& src, Rect const& src_rect, Opacity
 }
 
 void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, Opacity const & opacity) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -603,8 +637,16 @@ void Bitmap::BlitFast(int x, int y, Bitmap const & src, Rect const & src_rect, O
 
 PixmanImagePtr Bitmap::GetSubimage(Bitmap const& src, const Rect& src_rect) {
 	uint8_t* pixels = (uint8_t*) src.pixels() + src_rect.x * src.bpp() + src_rect.y * src.pitch();
-	return PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
+	auto image = PixmanImagePtr{ pixman_image_create_bits(src.pixman_format, src_rect.width, src_rect.height,
 									(uint32_t*) pixels, src.pitch()) };
+	if (src.format.bits == 8) {
+		pixman_image_set_indexed(image.get(), &palette);
+	}
+	return image;
+}
+
+BitmapRef Bitmap::CreateView() {
+	return Create(pixels(), width(), height(), pitch(), format);
 }
 
 void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
@@ -612,6 +654,8 @@ void Bitmap::TiledBlit(Rect const& src_rect, Bitmap const& src, Rect const& dst_
 }
 
 void Bitmap::TiledBlit(int ox, int oy, Rect const& src_rect, Bitmap const& src, Rect const& dst_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -640,6 +684,8 @@ void Bitmap::StretchBlit(Bitmap const&  src, Rect const& src_rect, Opacity const
 }
 
 void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -649,28 +695,31 @@ void Bitmap::StretchBlit(Rect const& dst_rect, Bitmap const& src, Rect const& sr
 
 	Transform xform = Transform::Scale(zoom_x, zoom_y);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+	// The transform is set on a private image, src can be drawn from several threads
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
 
 	pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
-							 src.bitmap.get(), mask.get(), bitmap.get(),
+							 src_img.get(), mask.get(), bitmap.get(),
 							 src_rect.x / zoom_x, src_rect.y / zoom_y,
 							 0, 0,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.width, dst_rect.height);
-
-	pixman_image_set_transform(src.bitmap.get(), nullptr);
 }
 
 void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const& src, Rect const& src_rect, int depth, double phase, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
 	Transform xform = Transform::Scale(1.0 / zoom_x, 1.0 / zoom_y);
 
-	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
+	auto src_img = GetSubimage(src, src.GetRect());
+	pixman_image_set_transform(src_img.get(), &xform.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &xform);
 
@@ -689,14 +738,12 @@ void Bitmap::WaverBlit(int x, int y, double zoom_x, double zoom_y, Bitmap const&
 		const int offset = 2 * zoom_x * depth * std::sin(phase + sy);
 
 		pixman_image_composite32(src.GetOperator(mask.get(), blend_mode),
-								 src.bitmap.get(), mask.get(), bitmap.get(),
+								 src_img.get(), mask.get(), bitmap.get(),
 								 xoff, yoff + i,
 								 0, i,
 								 x + offset, dy,
 								 width, 1);
 	}
-
-	pixman_image_set_transform(src.bitmap.get(), nullptr);
 }
 
 static pixman_color_t PixmanColor(const Color &color) {
@@ -709,6 +756,8 @@ static pixman_color_t PixmanColor(const Color &color) {
 }
 
 void Bitmap::Fill(const Color &color) {
+	++revision;
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	pixman_box32_t box = { 0, 0, width(), height() };
@@ -717,6 +766,8 @@ void Bitmap::Fill(const Color &color) {
 }
 
 void Bitmap::FillRect(Rect const& dst_rect, const Color &color) {
+	++revision;
+
 	pixman_color_t pcolor = PixmanColor(color);
 
 	auto timage = PixmanImagePtr{pixman_image_create_solid_fill(&pcolor)};
@@ -730,15 +781,24 @@ void Bitmap::FillRect(Rect const& dst_rect, const Color &color) {
 }
 
 void Bitmap::Clear() {
+	++revision;
+
 	if (!pixels()) {
 		// Happens when height or width of bitmap are 0
 		return;
 	}
 
+	if (has_clip) {
+		ClearRect(clip_rect);
+		return;
+	}
+
 	memset(pixels(), '\0', height() * pitch());
 }
 
 void Bitmap::ClearRect(Rect const& dst_rect) {
+	++revision;
+
 	pixman_color_t pcolor = {};
 	pixman_box32_t box = {
 		dst_rect.x,
@@ -750,65 +810,15 @@ void Bitmap::ClearRect(Rect const& dst_rect) {
 	pixman_image_fill_boxes(PIXMAN_OP_CLEAR, bitmap.get(), &pcolor, 1, &box);
 }
 
-// Hard light lookup table mapping source color to destination color
-// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
-struct HardLightTable {
-	uint8_t table[256][256] = {};
-};
-
-static constexpr HardLightTable make_hard_light_lookup() {
-	HardLightTable hl;
-	for (int i = 0; i < 256; ++i) {
-		for (int j = 0; j < 256; ++j) {
-			int res = 0;
-			if (i <= 128)
-				res = (2 * i * j) / 255;
-			else
-				res = 255 - 2 * (255 - i) * (255 - j) / 255;
-			hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
-		}
-	}
-	return hl;
-}
-
-constexpr auto hard_light = make_hard_light_lookup();
-
-// Saturation Tone Inline: Changes a pixel saturation
-static inline void saturation_tone(uint32_t &src_pixel, int saturation, int rs, int gs, int bs, int as) {
-	// Algorithm from OpenPDN (MIT license)
-	// Transformation in Y'CbCr color space
-	uint8_t r = (src_pixel >> rs) & 0xFF;
-	uint8_t g = (src_pixel >> gs) & 0xFF;
-	uint8_t b = (src_pixel >> bs) & 0xFF;
-	uint8_t a = (src_pixel >> as) & 0xFF;
-
-	// Y' = 0.299 R' + 0.587 G' + 0.114 B'
-	uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect_, const Tone &tone, Opacity const& opacity, bool check_alpha) {
+	++revision;
 
-	// Scale Cb/Cr by scale factor "sat"
-	int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
-	red = red > 255 ? 255 : red < 0 ? 0 : red;
-	int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
-	green = green > 255 ? 255 : green < 0 ? 0 : green;
-	int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
-	blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
-
-	src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
-}
-
-// Color Tone Inline: Changes color of a pixel by hard light table
-static inline void color_tone(uint32_t &src_pixel, Tone tone, int rs, int gs, int bs, int as) {
-	src_pixel = ((uint32_t)hard_light.table[tone.red][(src_pixel >> rs) & 0xFF] << rs)
-		| ((uint32_t)hard_light.table[tone.green][(src_pixel >> gs) & 0xFF] << gs)
-		| ((uint32_t)hard_light.table[tone.blue][(src_pixel >> bs) & 0xFF] << bs)
-		| ((uint32_t)((src_pixel >> as) & 0xFF) << as);
-}
-
-void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Tone &tone, Opacity const& opacity, bool check_alpha) {
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
+	Rect src_rect = src_rect_;
+
 	if (tone == Tone(128,128,128,128)) {
 		if (&src != this) {
 			Blit(x, y, src, src_rect, opacity);
@@ -816,6 +826,18 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 		return;
 	}
 
+	if (has_clip) {
+		// The pixels are toned in place below, which bypasses the pixman clip region
+		Rect dst_rect(x, y, src_rect.width, src_rect.height);
+		dst_rect.Adjust(clip_rect);
+		if (dst_rect.IsEmpty()) {
+			return;
+		}
+		src_rect = Rect(src_rect.x + dst_rect.x - x, src_rect.y + dst_rect.y - y, dst_rect.width, dst_rect.height);
+		x = dst_rect.x;
+		y = dst_rect.y;
+	}
+
 	// Only needed here, other codepaths are sanity checked by pixman
 	if (x < 0 || y < 0 || x >= width() || y >= height()) {
 		return;
@@ -829,96 +851,39 @@ void Bitmap::ToneBlit(int x, int y, Bitmap const& src, Rect const& src_rect, con
 		x, y,
 		src_rect.width, src_rect.height);
 
-	int as = pixel_format.a.shift;
-	int rs = pixel_format.r.shift;
-	int gs = pixel_format.g.shift;
-	int bs = pixel_format.b.shift;
 	int next_row = pitch() / sizeof(uint32_t);
 	uint32_t* pixels = (uint32_t*)this->pixels();
-	pixels = pixels + (y - 1) * next_row + x;
+	pixels = pixels + y * next_row + x;
 
 	uint16_t limit_height = std::min<uint16_t>(src_rect.height, height());
 	uint16_t limit_width = std::min<uint16_t>(src_rect.width, width());
 
-	// If Saturation + Color:
-	if (tone.gray != 128 && (tone.red != 128 || tone.green != 128 || tone.blue != 128)) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
-
-		if (&src != this || check_alpha) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					if ((uint8_t)((pixels[j] >> as) & 0xFF) == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		}
-		else {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		}
-	}
-
-	// If Only Saturation:
-	else if (tone.gray != 128) {
-		int sat = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
-
-		if (&src != this || check_alpha) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					if ((uint8_t)((pixels[j] >> as) & 0xFF) == 0)
-						continue;
-
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		}
-		else {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					saturation_tone(pixels[j], sat, rs, gs, bs, as);
-				}
-			}
-		}
+	PixelKernels::ToneParams params;
+	params.as = pixel_format.a.shift;
+	params.rs = pixel_format.r.shift;
+	params.gs = pixel_format.g.shift;
+	params.bs = pixel_format.b.shift;
+	params.saturate = tone.gray != 128;
+	params.saturation = tone.gray > 128 ? 1024 + (tone.gray - 128) * 16 : tone.gray * 8;
+	params.color = tone.red != 128 || tone.green != 128 || tone.blue != 128;
+	params.red = tone.red;
+	params.green = tone.green;
+	params.blue = tone.blue;
+	params.skip_transparent = &src != this || check_alpha;
+
+	if (!params.saturate && !params.color) {
+		return;
 	}
 
-	// If Only Color:
-	else if (tone.red != 128 || tone.green != 128 || tone.blue != 128) {
-		if (&src != this || check_alpha) {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					if ((uint8_t)((pixels[j] >> as) & 0xFF) == 0)
-						continue;
-
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		}
-		else {
-			for (uint16_t i = 0; i < limit_height; ++i) {
-				pixels += next_row;
-				for (uint16_t j = 0; j < limit_width; ++j) {
-					color_tone(pixels[j], tone, rs, gs, bs, as);
-				}
-			}
-		}
-
+	for (uint16_t i = 0; i < limit_height; ++i) {
+		PixelKernels::ToneRow(pixels, limit_width, params);
+		pixels += next_row;
 	}
-
 }
 
 void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, const Color& color, Opacity const& opacity) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -949,6 +914,8 @@ void Bitmap::BlendBlit(int x, int y, Bitmap const& src, Rect const& src_rect, co
 }
 
 void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool horizontal, bool vertical, Opacity const& opacity, Bitmap::BlendMode blend_mode) {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
@@ -977,6 +944,8 @@ void Bitmap::FlipBlit(int x, int y, Bitmap const& src, Rect const& src_rect, boo
 }
 
 void Bitmap::Flip(bool horizontal, bool vertical) {
+	++revision;
+
 	if (!horizontal && !vertical) {
 		return;
 	}
@@ -1001,6 +970,8 @@ void Bitmap::Flip(bool horizontal, bool vertical) {
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Color const& color) {
+	++revision;
+
 	pixman_color_t tcolor = {
 		static_cast<uint16_t>(color.red << 8),
 		static_cast<uint16_t>(color.green << 8),
@@ -1018,6 +989,8 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my, Bitmap const& src, int sx, int sy) {
+	++revision;
+
 	pixman_image_composite32(PIXMAN_OP_OVER,
 							 src.bitmap.get(), mask.bitmap.get(), bitmap.get(),
 							 sx, sy,
@@ -1027,6 +1000,8 @@ void Bitmap::MaskedBlit(Rect const& dst_rect, Bitmap const& mask, int mx, int my
 }
 
 void Bitmap::Blit2x(Rect const& dst_rect, Bitmap const& src, Rect const& src_rect) {
+	++revision;
+
 	Transform xform = Transform::Scale(0.5, 0.5);
 
 	pixman_image_set_transform(src.bitmap.get(), &xform.matrix);
@@ -1073,12 +1048,12 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 		Bitmap const& src, Rect const& src_rect,
 		double angle, double zoom_x, double zoom_y, Opacity const& opacity, Bitmap::BlendMode blend_mode)
 {
+	++revision;
+
 	if (opacity.IsTransparent()) {
 		return;
 	}
 
-	auto* src_img = src.bitmap.get();
-
 	Transform fwd = Transform::Translation(x, y);
 	fwd *= Transform::Rotation(angle);
 	if (zoom_x != 1.0 || zoom_y != 1.0) {
@@ -1093,26 +1068,20 @@ void Bitmap::RotateZoomOpacityBlit(int x, int y, int ox, int oy,
 
 	auto inv = fwd.Inverse();
 
-	PixmanImagePtr temp;
-	if (src_rect != src.GetRect()) {
-		temp = GetSubimage(src, src_rect);
-		src_img = temp.get();
-	}
-
-	pixman_image_set_transform(src_img, &inv.matrix);
+	// The transform is set on a private image, src can be drawn from several threads
+	auto src_img = GetSubimage(src, src_rect);
+	pixman_image_set_transform(src_img.get(), &inv.matrix);
 
 	auto mask = CreateMask(opacity, src_rect, &inv);
 
 	// OP_SRC draws a black rectangle around the rotated image making this operator unusable here
 	blend_mode = (blend_mode == BlendMode::Default ? BlendMode::Normal : blend_mode);
 	pixman_image_composite32(GetOperator(mask.get(), blend_mode),
-							 src_img, mask.get(), bitmap.get(),
+							 src_img.get(), mask.get(), bitmap.get(),
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.x, dst_rect.y,
 							 dst_rect.width, dst_rect.height);
-
-	pixman_image_set_transform(src_img, nullptr);
 }
 
 void Bitmap::ZoomOpacityBlit(int x, int y, int ox, int oy,
@@ -1178,6 +1147,8 @@ pixman_op_t Bitmap::GetOperator(pixman_image_t* mask, Bitmap::BlendMode blend_mo
 }
 
 void Bitmap::EdgeMirrorBlit(int x, int y, Bitmap const& src, Rect const& src_rect, bool mirror_x, bool mirror_y, Opacity const& opacity) {
+	++revision;
+
 	if (opacity.IsTransparent())
 		return;
 
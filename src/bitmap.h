@@ -223,6 +223,42 @@ public:
 	 */
 	StringView GetFilename() const;
 
+	/**
+	 * Gets a counter which changes whenever the pixels are modified.
+	 * Used by drawables to detect changed content.
+	 *
+	 * @return revision counter
+	 */
+	uint32_t GetRevision() const;
+
+	/**
+	 * Restricts all drawing operations on this bitmap to a rectangle.
+	 *
+	 * @param rect clip rectangle
+	 */
+	void SetClipRect(const Rect& rect);
+
+	/**
+	 * Removes the clip rectangle set by SetClipRect.
+	 */
+	void ClearClipRect();
+
+	/**
+	 * Gets the clip rectangle.
+	 *
+	 * @return clip rectangle or the whole bitmap when none is set
+	 */
+	Rect GetClipRect() const;
+
+	/**
+	 * Creates a bitmap sharing the pixels of this bitmap.
+	 * The view has its own clip rect and revision, so several threads can
+	 * draw into different areas of the pixels through separate views.
+	 *
+	 * @return bitmap using the same pixel memory
+	 */
+	BitmapRef CreateView();
+
 	void CheckPixels(uint32_t flags);
 
 	/**
@@ -571,6 +607,14 @@ public:
 
 	void* pixels();
 	void const* pixels() const;
+
+	/**
+	 * Accessor for writing to the pixels directly.
+	 * Unlike pixels() this counts as a change of the bitmap (see GetRevision).
+	 *
+	 * @return pixel data
+	 */
+	void* MutablePixels();
 	int width() const;
 	int height() const;
 	int bpp() const;
@@ -592,6 +636,10 @@ protected:
 	PixmanImagePtr bitmap;
 	pixman_format_code_t pixman_format;
 
+	Rect clip_rect;
+	bool has_clip = false;
+	uint32_t revision = 0;
+
 	void Init(int width, int height, void* data, int pitch = 0, bool destroy = true);
 	void ConvertImage(int& width, int& height, void*& pixels, bool transparent);
 
@@ -661,4 +709,12 @@ inline StringView Bitmap::GetFilename() const {
 	return filename;
 }
 
+inline uint32_t Bitmap::GetRevision() const {
+	return revision;
+}
+
+inline Rect Bitmap::GetClipRect() const {
+	return has_clip ? clip_rect : GetRect();
+}
+
 #endif
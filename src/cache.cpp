@@ -20,11 +20,13 @@
 #  pragma warning(disable: 4003)
 #endif
 
-#include <map>
-#include <tuple>
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <cstdint>
 #include <cassert>
 
+#include "async_decoder.h"
 #include "async_handler.h"
 #include "cache.h"
 #include "filefinder.h"
@@ -33,8 +35,10 @@
 #include "bitmap.h"
 #include "output.h"
 #include "player.h"
+#include "utils.h"
 #include <lcf/data.h>
 #include "game_clock.h"
+#include "instrumentation.h"
 
 using namespace std::chrono_literals;
 
@@ -43,84 +47,261 @@ namespace {
 		return ToString(folder_name) + ":" + ToString(filename) + ":" + (transparent ? "T" : " ");
 	}
 
-	std::string MakeTileHashKey(StringView chipset_name, int id) {
-		std::string key;
-		key.reserve(chipset_name.size() + sizeof(int) + 2);
-		key.append(reinterpret_cast<char*>(&id), sizeof(id));
-		key.append(1, ':');
-		key.append(chipset_name.begin(), chipset_name.end());
+	// Chipset names used by Cache::Tile, the index is stored in the upper half of the tile key
+	std::vector<std::string> tile_chipsets;
 
-		return key;
-	}
+	uint64_t MakeTileHashKey(StringView chipset_name, int id) {
+		// Tiles of one chipset are requested in a row, so remember the last match
+		static size_t last_chipset = 0;
 
-	int IdFromTileHash(StringView key) {
-		int id = 0;
-		if (key.size() > sizeof(id)) {
-			std::memcpy(&id, key.data(), sizeof(id));
+		if (last_chipset >= tile_chipsets.size() || StringView(tile_chipsets[last_chipset]) != chipset_name) {
+			auto it = std::find_if(tile_chipsets.begin(), tile_chipsets.end(),
+					[&](const std::string& name) { return StringView(name) == chipset_name; });
+			if (it == tile_chipsets.end()) {
+				it = tile_chipsets.insert(it, ToString(chipset_name));
+			}
+			last_chipset = it - tile_chipsets.begin();
 		}
-		return id;
+
+		return (static_cast<uint64_t>(last_chipset) << 32) | static_cast<uint32_t>(id);
 	}
 
-	const char* NameFromTileHash(StringView key) {
-		int offset = sizeof(int) + 1;
-		if (static_cast<int>(key.size()) < offset) {
-			return "";
-		}
-		return key.data() + offset;
+	int IdFromTileHash(uint64_t key) {
+		return static_cast<int>(static_cast<uint32_t>(key));
+	}
+
+	const char* NameFromTileHash(uint64_t key) {
+		size_t index = static_cast<size_t>(key >> 32);
+		return index < tile_chipsets.size() ? tile_chipsets[index].c_str() : "";
 	}
 
+	using key_type = std::string;
+
+	struct Material {
+		enum Type {
+			REND = -1,
+			Backdrop,
+			Battle,
+			Charset,
+			Chipset,
+			Faceset,
+			Gameover,
+			Monster,
+			Panorama,
+			Picture,
+			System,
+			Title,
+			System2,
+			Battle2,
+			Battlecharset,
+			Battleweapon,
+			Frame,
+			END
+		};
+
+	}; // struct Material
+
+	// Bitmaps of each material are kept in their own recency list, the ExFont uses the last one
+	constexpr int num_cache_lists = Material::END + 1;
+	constexpr int exfont_list = Material::END;
+
 	struct CacheItem {
 		BitmapRef bitmap;
 		Game_Clock::time_point last_access;
+		int material = 0;
+		// Neighbours in the recency list of the material, least recently used first
+		CacheItem* prev = nullptr;
+		CacheItem* next = nullptr;
+		const key_type* key = nullptr;
 	};
 
-	using key_type = std::string;
 	std::unordered_map<key_type, CacheItem> cache;
 
-	using tile_key_type = std::string;
-	std::unordered_map<tile_key_type, std::weak_ptr<Bitmap>> cache_tiles;
+	struct CacheList {
+		CacheItem* head = nullptr;
+		CacheItem* tail = nullptr;
+	};
+	std::array<CacheList, num_cache_lists> cache_lists;
+	std::array<Cache::MaterialStats, num_cache_lists> cache_stats;
+
+	/**
+	 * Lookup table of bitmaps which are owned by their users.
+	 * Entries only hold weak references, dead ones are swept periodically
+	 * and the table is emptied when it grows past its limit anyway.
+	 */
+	template <typename Key, typename Value, typename Hash = std::hash<Key>>
+	struct WeakCache {
+		static constexpr size_t limit = 4096;
+		static constexpr int sweep_interval = 256;
+
+		std::unordered_map<Key, Value, Hash> entries;
+		Cache::MaterialStats stats;
+		int misses_since_sweep = 0;
+
+		/** Called before inserting a new entry */
+		void Prune() {
+			if (++misses_since_sweep < sweep_interval && entries.size() < limit) {
+				return;
+			}
+			misses_since_sweep = 0;
+
+			for (auto it = entries.begin(); it != entries.end();) {
+				if (it->second.expired()) {
+					it = entries.erase(it);
+					++stats.evictions;
+				} else {
+					++it;
+				}
+			}
+
+			if (entries.size() >= limit) {
+				// Only forgets the bitmaps, they stay alive as long as they are used
+				stats.evictions += static_cast<int>(entries.size());
+				entries.clear();
+			}
+		}
+
+		void Clear() {
+			entries.clear();
+			misses_since_sweep = 0;
+		}
+	};
+
+	WeakCache<uint64_t, std::weak_ptr<Bitmap>> cache_tiles;
+
+	struct EffectKey {
+		// Only used for hashing, EffectEntry::src guards against address reuse
+		const Bitmap* src;
+		Rect rect;
+		bool flip_x;
+		bool flip_y;
+		Tone tone;
+		Color blend;
+	};
+
+	bool operator==(const EffectKey& l, const EffectKey& r) {
+		return l.src == r.src
+			&& l.rect == r.rect
+			&& l.flip_x == r.flip_x
+			&& l.flip_y == r.flip_y
+			&& l.tone == r.tone
+			&& l.blend == r.blend;
+	}
+
+	struct EffectKeyHash {
+		size_t operator()(const EffectKey& k) const {
+			uint64_t h = reinterpret_cast<uintptr_t>(k.src);
+			auto mix = [&h](uint64_t v) {
+				h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+			};
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(k.rect.x)) << 32) | static_cast<uint32_t>(k.rect.y));
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(k.rect.width)) << 32) | static_cast<uint32_t>(k.rect.height));
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(k.tone.red)) << 32) | static_cast<uint32_t>(k.tone.green));
+			mix((static_cast<uint64_t>(static_cast<uint32_t>(k.tone.blue)) << 32) | static_cast<uint32_t>(k.tone.gray));
+			mix((static_cast<uint64_t>(k.blend.red) << 24) | (k.blend.green << 16) | (k.blend.blue << 8) | k.blend.alpha
+				| (static_cast<uint64_t>(k.flip_x) << 32) | (static_cast<uint64_t>(k.flip_y) << 33));
+			return static_cast<size_t>(h);
+		}
+	};
+
+	struct EffectEntry {
+		std::weak_ptr<Bitmap> src;
+		std::weak_ptr<Bitmap> bitmap;
+
+		bool expired() const {
+			return src.expired() || bitmap.expired();
+		}
+	};
 
-	// rect, flip_x, flip_y, tone, blend
-	using effect_key_type = std::tuple<BitmapRef, Rect, bool, bool, Tone, Color>;
-	std::map<effect_key_type, std::weak_ptr<Bitmap>> cache_effects;
+	WeakCache<EffectKey, EffectEntry, EffectKeyHash> cache_effects;
 
 	std::string system_name;
 
 	std::string system2_name;
 
-	constexpr int cache_limit = 10 * 1024 * 1024;
+	// Images being decoded by AsyncDecoder, by cache key
+	struct PendingDecode {
+		int material;
+		std::vector<std::function<void()>> listeners;
+	};
+	std::unordered_map<key_type, PendingDecode> pending_decodes;
+
+	size_t cache_limit = 10 * 1024 * 1024;
 	size_t cache_size = 0;
 
+	void Unlink(CacheItem& item) {
+		auto& list = cache_lists[item.material];
+		(item.prev ? item.prev->next : list.head) = item.next;
+		(item.next ? item.next->prev : list.tail) = item.prev;
+		item.prev = nullptr;
+		item.next = nullptr;
+	}
+
+	void Append(CacheItem& item) {
+		auto& list = cache_lists[item.material];
+		item.prev = list.tail;
+		item.next = nullptr;
+		(list.tail ? list.tail->next : list.head) = &item;
+		list.tail = &item;
+	}
+
+	void Touch(CacheItem& item) {
+		item.last_access = Game_Clock::GetFrameTime();
+		if (cache_lists[item.material].tail != &item) {
+			Unlink(item);
+			Append(item);
+		}
+	}
+
+	void Evict(CacheItem& item) {
+#ifdef CACHE_DEBUG
+		Output::Debug("Freeing memory of {}", *item.key);
+#endif
+		auto& stats = cache_stats[item.material];
+		size_t size = item.bitmap ? item.bitmap->GetSize() : 0;
+		cache_size -= size;
+		stats.bytes -= size;
+		--stats.count;
+		++stats.evictions;
+
+		Unlink(item);
+		cache.erase(*item.key);
+	}
+
 	void FreeBitmapMemory() {
 		auto cur_ticks = Game_Clock::GetFrameTime();
 
-		for (auto it = cache.begin(); it != cache.end();) {
-			if (it->second.bitmap.use_count() != 1) {
-				// Bitmap is referenced
-				++it;
-				continue;
+		for (;;) {
+			// The least recently used bitmap is at the head of one of the lists
+			CacheItem* oldest = nullptr;
+			for (auto& list : cache_lists) {
+				if (list.head && (!oldest || list.head->last_access < oldest->last_access)) {
+					oldest = list.head;
+				}
+			}
+			if (!oldest) {
+				break;
 			}
 
-			auto last_access = cur_ticks - it->second.last_access;
+			auto last_access = cur_ticks - oldest->last_access;
 			bool cache_exhausted = cache_size > cache_limit;
 			if (cache_exhausted) {
 				if (last_access <= 50ms) {
 					// Used during the last 3 frames, must be important, keep it.
-					++it;
-					continue;
+					// All other bitmaps were used even more recently.
+					break;
 				}
 			} else if (last_access <= 3s) {
-				++it;
-				continue;
+				break;
 			}
 
-#ifdef CACHE_DEBUG
-			Output::Debug("Freeing memory of {}/{}", std::get<0>(i.first), std::get<1>(i.first));
-#endif
-
-			cache_size -= it->second.bitmap->GetSize();
+			if (oldest->bitmap.use_count() != 1) {
+				// Bitmap is referenced, so it is still in use
+				Touch(*oldest);
+				continue;
+			}
 
-			it = cache.erase(it);
+			Evict(*oldest);
 		}
 
 #ifdef CACHE_DEBUG
@@ -128,40 +309,32 @@ namespace {
 #endif
 	}
 
-	BitmapRef AddToCache(const std::string& key, BitmapRef bmp) {
+	BitmapRef AddToCache(const std::string& key, BitmapRef bmp, int material) {
+		auto it = cache.find(key);
+		if (it != cache.end()) {
+			Evict(it->second);
+		}
+
+		auto& stats = cache_stats[material];
 		if (bmp) {
 			cache_size += bmp->GetSize();
+			stats.bytes += bmp->GetSize();
 #ifdef CACHE_DEBUG
 			Output::Debug("Bitmap cache size (Add): {}", cache_size / 1024.0 / 1024.0);
 #endif
 		}
+		++stats.count;
 
-		return (cache[key] = {bmp, Game_Clock::GetFrameTime()}).bitmap;
-	}
-
-	struct Material {
-		enum Type {
-			REND = -1,
-			Backdrop,
-			Battle,
-			Charset,
-			Chipset,
-			Faceset,
-			Gameover,
-			Monster,
-			Panorama,
-			Picture,
-			System,
-			Title,
-			System2,
-			Battle2,
-			Battlecharset,
-			Battleweapon,
-			Frame,
-			END
-		};
+		it = cache.emplace(key, CacheItem()).first;
+		auto& item = it->second;
+		item.bitmap = std::move(bmp);
+		item.last_access = Game_Clock::GetFrameTime();
+		item.material = material;
+		item.key = &it->first;
+		Append(item);
 
-	}; // struct Material
+		return item.bitmap;
+	}
 
 	using DummyRenderer = BitmapRef(*)();
 
@@ -257,9 +430,13 @@ namespace {
 			}
 
 			if (!bmp) {
+				static Instrumentation::Zone zone("Cache::LoadBitmap");
+				Instrumentation::Scope scope(zone);
+
 				auto is = FileFinder::OpenImage(s.directory, filename);
 
 				FreeBitmapMemory();
+				++cache_stats[T].misses;
 
 				if (!is) {
 					if (s.warn_missing) {
@@ -284,9 +461,10 @@ namespace {
 				bmp = LoadDummyBitmap<T>(s.directory, filename, transparent);
 			}
 
-			bmp = AddToCache(key, bmp);
+			bmp = AddToCache(key, bmp, T);
 		} else {
-			it->second.last_access = Game_Clock::GetFrameTime();
+			Touch(it->second);
+			++cache_stats[T].hits;
 			bmp = it->second.bitmap;
 		}
 
@@ -405,18 +583,23 @@ BitmapRef Cache::Exfont() {
 			exfont_img = Bitmap::Create(exfont_h, sizeof(exfont_h), true);
 		}
 
-		return AddToCache(key, exfont_img);
+		++cache_stats[exfont_list].misses;
+		return AddToCache(key, exfont_img, exfont_list);
 	} else {
-		it->second.last_access = Game_Clock::GetFrameTime();
+		Touch(it->second);
+		++cache_stats[exfont_list].hits;
 		return it->second.bitmap;
 	}
 }
 
 BitmapRef Cache::Tile(StringView filename, int tile_id) {
 	const auto key = MakeTileHashKey(filename, tile_id);
-	auto it = cache_tiles.find(key);
+	auto it = cache_tiles.entries.find(key);
+
+	if (it == cache_tiles.entries.end() || it->second.expired()) {
+		++cache_tiles.stats.misses;
+		cache_tiles.Prune();
 
-	if (it == cache_tiles.end() || it->second.expired()) {
 		BitmapRef chipset = Cache::Chipset(filename);
 		Rect rect = Rect(0, 0, 16, 16);
 
@@ -441,13 +624,18 @@ BitmapRef Cache::Tile(StringView filename, int tile_id) {
 		rect.x += sub_tile_id % 6 * 16;
 		rect.y += sub_tile_id / 6 * 16;
 
-		return(cache_tiles[key] = Bitmap::Create(*chipset, rect)).lock();
-	} else { return it->second.lock(); }
+		BitmapRef tile = Bitmap::Create(*chipset, rect);
+		cache_tiles.entries[key] = tile;
+		return tile;
+	} else {
+		++cache_tiles.stats.hits;
+		return it->second.lock();
+	}
 }
 
 BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, bool flip_x, bool flip_y, const Tone& tone, const Color& blend) {
-	const effect_key_type key {
-		src_bitmap,
+	const EffectKey key {
+		src_bitmap.get(),
 		rect,
 		flip_x,
 		flip_y,
@@ -455,9 +643,12 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 		blend
 	};
 
-	const auto it = cache_effects.find(key);
+	const auto it = cache_effects.entries.find(key);
+
+	if (it == cache_effects.entries.end() || it->second.expired()) {
+		++cache_effects.stats.misses;
+		cache_effects.Prune();
 
-	if (it == cache_effects.end() || it->second.expired()) {
 		BitmapRef bitmap_effects;
 
 		auto create = [&rect] () -> BitmapRef {
@@ -491,16 +682,27 @@ BitmapRef Cache::SpriteEffect(const BitmapRef& src_bitmap, const Rect& rect, boo
 
 		assert(bitmap_effects && "Effect cache used but no effect applied!");
 
-		return(cache_effects[key] = bitmap_effects).lock();
-	} else { return it->second.lock(); }
+		cache_effects.entries[key] = { src_bitmap, bitmap_effects };
+		return bitmap_effects;
+	} else {
+		++cache_effects.stats.hits;
+		return it->second.bitmap.lock();
+	}
 }
 
 void Cache::Clear() {
-	cache_effects.clear();
+	DumpStats();
+
+	cache_effects.Clear();
 	cache.clear();
 	cache_size = 0;
+	cache_lists = {};
+	for (auto& stats : cache_stats) {
+		stats.bytes = 0;
+		stats.count = 0;
+	}
 
-	for (auto& kv : cache_tiles) {
+	for (auto& kv : cache_tiles.entries) {
 		auto& key = kv.first;
 		if (kv.second.expired()) {
 			continue;
@@ -509,12 +711,105 @@ void Cache::Clear() {
 				NameFromTileHash(key), IdFromTileHash(key));
 	}
 
-	cache_tiles.clear();
+	cache_tiles.Clear();
+	tile_chipsets.clear();
 
 	system_name.clear();
 	system2_name.clear();
 }
 
+bool Cache::DecodeAsync(StringView folder_name, StringView filename, std::function<void()> on_done) {
+	if (!AsyncDecoder::IsSupported() || filename == CACHE_DEFAULT_BITMAP) {
+		return false;
+	}
+
+	// Only large images shown during gameplay, everything else is decoded when used
+	int material;
+	if (folder_name == spec[Material::Picture].directory) {
+		material = Material::Picture;
+	} else if (folder_name == spec[Material::Panorama].directory) {
+		material = Material::Panorama;
+	} else {
+		return false;
+	}
+
+	const Spec& s = spec[material];
+	const auto key = MakeHashKey(s.directory, filename, s.transparent);
+	if (cache.find(key) != cache.end()) {
+		return false;
+	}
+
+	auto it = pending_decodes.find(key);
+	if (it == pending_decodes.end()) {
+		auto is = FileFinder::OpenImage(s.directory, filename);
+		if (!is) {
+			// Reported when the image is loaded
+			return false;
+		}
+		AsyncDecoder::Submit(key, Utils::ReadStream(is), s.transparent, Bitmap::Flag_ReadOnly);
+		it = pending_decodes.emplace(key, PendingDecode{ material, {} }).first;
+	}
+	it->second.listeners.push_back(std::move(on_done));
+
+	return true;
+}
+
+void Cache::UpdateAsyncDecodes() {
+	for (auto& result : AsyncDecoder::TakeFinished()) {
+		Output::WriteMessages(result.log);
+
+		auto it = pending_decodes.find(result.key);
+		if (it == pending_decodes.end()) {
+			continue;
+		}
+		auto pending = std::move(it->second);
+		pending_decodes.erase(it);
+
+		// Invalid images are not cached, loading them reports the error
+		if (result.bitmap && cache.find(result.key) == cache.end()) {
+			FreeBitmapMemory();
+			++cache_stats[pending.material].misses;
+			AddToCache(result.key, std::move(result.bitmap), pending.material);
+		}
+
+		for (auto& listener : pending.listeners) {
+			listener();
+		}
+	}
+}
+
+std::vector<Cache::MaterialStats> Cache::GetStats() {
+	std::vector<MaterialStats> result(cache_stats.begin(), cache_stats.end());
+	for (int i = 0; i < num_cache_lists; ++i) {
+		result[i].name = (i == exfont_list) ? "ExFont" : spec[i].directory;
+	}
+
+	// Tiles and sprite effects are owned by their users, only the table entries are counted
+	auto add_weak_stats = [&result](const char* name, const MaterialStats& stats, size_t count) {
+		result.push_back(stats);
+		result.back().name = name;
+		result.back().count = static_cast<int>(count);
+	};
+	add_weak_stats("Tile", cache_tiles.stats, cache_tiles.entries.size());
+	add_weak_stats("SpriteEffect", cache_effects.stats, cache_effects.entries.size());
+	return result;
+}
+
+void Cache::DumpStats() {
+	for (auto& stats : GetStats()) {
+		if (stats.hits == 0 && stats.misses == 0) {
+			continue;
+		}
+		Output::Debug("Cache {}: {} hits, {} misses, {} evictions, {} bitmaps ({:.2f} MiB)",
+				stats.name, stats.hits, stats.misses, stats.evictions, stats.count, stats.bytes / 1024.0 / 1024.0);
+	}
+	Output::Debug("Cache total: {:.2f} of {:.2f} MiB", cache_size / 1024.0 / 1024.0, cache_limit / 1024.0 / 1024.0);
+}
+
+void Cache::SetBitmapLimit(size_t bytes) {
+	cache_limit = bytes;
+}
+
 void Cache::SetSystemName(std::string filename) {
 	system_name = std::move(filename);
 }
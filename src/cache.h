@@ -19,6 +19,7 @@
 #define EP_CACHE_H
 
 // Headers
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -59,6 +60,51 @@ namespace Cache {
 
 	void Clear();
 
+	/**
+	 * Starts decoding a Picture or Panorama on a worker thread.
+	 * When the image is in the cache on_done is invoked by UpdateAsyncDecodes,
+	 * so loading it afterwards does not block.
+	 *
+	 * @param folder_name material folder
+	 * @param filename image file
+	 * @param on_done invoked on the main thread when decoding finished
+	 * @return false when the image is not decoded in the background, on_done is not invoked then
+	 */
+	bool DecodeAsync(StringView folder_name, StringView filename, std::function<void()> on_done);
+
+	/** Moves images decoded in the background into the cache, called once per frame */
+	void UpdateAsyncDecodes();
+
+	/** Usage statistics of the cached bitmaps of one material */
+	struct MaterialStats {
+		/** Material name, e.g. "CharSet" */
+		const char* name = "";
+		/** Lookups served from the cache */
+		int hits = 0;
+		/** Lookups which loaded the image */
+		int misses = 0;
+		/** Bitmaps freed to stay below the memory limit */
+		int evictions = 0;
+		/** Number of cached bitmaps */
+		int count = 0;
+		/** Memory used by the cached bitmaps */
+		size_t bytes = 0;
+	};
+
+	/** @return statistics of every material, hits, misses and evictions are counted since startup */
+	std::vector<MaterialStats> GetStats();
+
+	/** Writes the statistics of all used materials to the log */
+	void DumpStats();
+
+	/**
+	 * Sets the memory limit of the bitmap cache. Unused bitmaps are freed
+	 * earlier when the cache is larger than this.
+	 *
+	 * @param bytes limit in bytes
+	 */
+	void SetBitmapLimit(size_t bytes);
+
 	/** @return the configured system bitmap, or nullptr if there is no system */
 	BitmapRef System();
 
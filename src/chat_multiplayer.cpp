@@ -1,6 +1,8 @@
 #include "chat_multiplayer.h"
 #include <memory>
-#include <emscripten/emscripten.h>
+#ifdef EMSCRIPTEN
+#  include <emscripten/emscripten.h>
+#endif
 #include <vector>
 #include <utility>
 #include <regex>
@@ -549,7 +551,9 @@ void Chat_Multiplayer::processInputs() {
 					}
 				} else { //inputting trip
 					// send
+				#ifdef EMSCRIPTEN
 					EM_ASM({ SendProfileInfo(UTF8ToString($0), UTF8ToString($1)); }, cacheName.c_str(), Utils::EncodeUTF(typeText).c_str());
+				#endif
 					// reset typebox
 					typeText.clear();
 					typeCaretIndex = 0;
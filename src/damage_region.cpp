@@ -0,0 +1,93 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <algorithm>
+#include "damage_region.h"
+
+namespace {
+	Rect Union(const Rect& l, const Rect& r) {
+		int x1 = std::min(l.x, r.x);
+		int y1 = std::min(l.y, r.y);
+		int x2 = std::max(l.x + l.width, r.x + r.width);
+		int y2 = std::max(l.y + l.height, r.y + r.height);
+		return Rect(x1, y1, x2 - x1, y2 - y1);
+	}
+
+	int Area(const Rect& rect) {
+		return rect.width * rect.height;
+	}
+}
+
+void DamageRegion::Reset(const Rect& nbounds) {
+	bounds = nbounds;
+	rects.clear();
+	full = false;
+}
+
+void DamageRegion::Add(Rect rect) {
+	if (full) {
+		return;
+	}
+
+	rect.Adjust(bounds);
+	if (rect.IsEmpty()) {
+		return;
+	}
+
+	// Merging can make the rect overlap rects which were checked before, so restart
+	for (size_t i = 0; i < rects.size();) {
+		if (!rects[i].IsOutOfBounds(rect)) {
+			rect = Union(rects[i], rect);
+			rects.erase(rects.begin() + i);
+			i = 0;
+		} else {
+			++i;
+		}
+	}
+	rects.push_back(rect);
+
+	if (static_cast<int>(rects.size()) > max_rects) {
+		Rect all = rects.front();
+		for (auto& r : rects) {
+			all = Union(all, r);
+		}
+		rects.assign(1, all);
+	}
+
+	int area = 0;
+	for (auto& r : rects) {
+		area += Area(r);
+	}
+	// Redrawing in pieces only pays off when a good part of the screen is unchanged
+	if (area * 4 >= Area(bounds) * 3) {
+		AddAll();
+	}
+}
+
+void DamageRegion::AddAll() {
+	full = true;
+	rects.clear();
+}
+
+bool DamageRegion::Intersects(const Rect& rect) const {
+	if (full) {
+		return true;
+	}
+
+	return std::any_of(rects.begin(), rects.end(), [&](const Rect& r) { return !r.IsOutOfBounds(rect); });
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DAMAGE_REGION_H
+#define EP_DAMAGE_REGION_H
+
+// Headers
+#include <vector>
+#include "rect.h"
+
+/**
+ * Collects the areas of the screen which changed and must be redrawn.
+ *
+ * Overlapping rectangles are merged. When too many rectangles are added
+ * or they cover most of the screen the region becomes full, which means
+ * the whole screen is redrawn.
+ */
+class DamageRegion {
+public:
+	/** Maximum number of separate rectangles */
+	static constexpr int max_rects = 8;
+
+	/**
+	 * Sets the screen area and removes all damage.
+	 *
+	 * @param bounds screen area, added rectangles are clipped to it
+	 */
+	void Reset(const Rect& bounds);
+
+	/**
+	 * Marks an area as damaged.
+	 *
+	 * @param rect damaged area
+	 */
+	void Add(Rect rect);
+
+	/** Marks the whole screen as damaged. */
+	void AddAll();
+
+	/** @return true when nothing is damaged */
+	bool IsEmpty() const;
+
+	/** @return true when the whole screen is damaged */
+	bool IsFull() const;
+
+	/**
+	 * Checks if a rectangle overlaps the damaged area.
+	 *
+	 * @param rect area to check
+	 * @return whether rect has to be redrawn
+	 */
+	bool Intersects(const Rect& rect) const;
+
+	/** @return the damaged rectangles, only meaningful when the region is not full */
+	const std::vector<Rect>& GetRects() const;
+
+	/** @return the screen area */
+	const Rect& GetBounds() const;
+
+private:
+	Rect bounds;
+	std::vector<Rect> rects;
+	bool full = false;
+};
+
+inline bool DamageRegion::IsEmpty() const {
+	return !full && rects.empty();
+}
+
+inline bool DamageRegion::IsFull() const {
+	return full;
+}
+
+inline const std::vector<Rect>& DamageRegion::GetRects() const {
+	return rects;
+}
+
+inline const Rect& DamageRegion::GetBounds() const {
+	return bounds;
+}
+
+#endif
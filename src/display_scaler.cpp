@@ -0,0 +1,280 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "display_scaler.h"
+#include "instrumentation.h"
+#include "bitmap.h"
+#include "pixel_kernels.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace {
+	const uint32_t* Row(const Bitmap& bitmap, int y) {
+		return reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(bitmap.pixels()) + y * bitmap.pitch());
+	}
+
+	uint32_t* Row(Bitmap& bitmap, int y) {
+		return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(bitmap.pixels()) + y * bitmap.pitch());
+	}
+
+	void ScaleInteger(const Bitmap& src, Bitmap& dst) {
+		const int factor = dst.width() / src.width();
+		const size_t row_size = dst.width() * sizeof(uint32_t);
+
+		for (int y = 0; y < src.height(); ++y) {
+			auto* first = Row(dst, y * factor);
+			PixelKernels::ScaleRow(Row(src, y), first, src.width(), factor);
+			for (int i = 1; i < factor; ++i) {
+				std::memcpy(Row(dst, y * factor + i), first, row_size);
+			}
+		}
+	}
+
+	void ScaleNearest(const Bitmap& src, Bitmap& dst) {
+		const int sw = src.width();
+		const int sh = src.height();
+		const int dw = dst.width();
+		const int dh = dst.height();
+		const size_t row_size = dw * sizeof(uint32_t);
+
+		std::vector<int> columns(dw);
+		for (int x = 0; x < dw; ++x) {
+			columns[x] = static_cast<int>(static_cast<int64_t>(x) * sw / dw);
+		}
+
+		int last_sy = -1;
+		for (int y = 0; y < dh; ++y) {
+			const int sy = static_cast<int>(static_cast<int64_t>(y) * sh / dh);
+			auto* out = Row(dst, y);
+			if (sy == last_sy) {
+				// Enlarged rows are copies of the row above
+				std::memcpy(out, Row(dst, y - 1), row_size);
+				continue;
+			}
+			last_sy = sy;
+
+			const auto* in = Row(src, sy);
+			for (int x = 0; x < dw; ++x) {
+				out[x] = in[columns[x]];
+			}
+		}
+	}
+
+	void ScaleScale2x(const Bitmap& src, Bitmap& dst) {
+		const int h = src.height();
+		for (int y = 0; y < h; ++y) {
+			const auto* above = Row(src, y > 0 ? y - 1 : y);
+			const auto* below = Row(src, y + 1 < h ? y + 1 : y);
+			PixelKernels::Scale2xRow(above, Row(src, y), below, Row(dst, 2 * y), Row(dst, 2 * y + 1), src.width());
+		}
+	}
+}
+
+DisplayScaler::~DisplayScaler() {
+#ifdef HAVE_PRESENT_THREAD
+	if (thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		work_cv.notify_all();
+		thread.join();
+	}
+#endif
+}
+
+bool DisplayScaler::IsThreaded() {
+#ifdef HAVE_PRESENT_THREAD
+	return true;
+#else
+	return false;
+#endif
+}
+
+DisplayScaler::Filter DisplayScaler::FilterFromName(StringView name) {
+	if (name == "nearest") {
+		return Filter::Nearest;
+	}
+	if (name == "integer") {
+		return Filter::Integer;
+	}
+	if (name == "scale2x") {
+		return Filter::Scale2x;
+	}
+	return Filter::None;
+}
+
+void DisplayScaler::SetFilter(Filter new_filter) {
+	WaitJob();
+	filter = new_filter;
+	submitted = false;
+	back_returned = false;
+	front_ready = false;
+}
+
+void DisplayScaler::Submit(const Bitmap& frame, int width, int height) {
+	assert(filter != Filter::None);
+	assert(frame.bpp() == 4);
+
+	WaitJob();
+
+	if (submitted) {
+		// The finished image becomes the front buffer
+		front_ready = !back_returned;
+		back ^= 1;
+	}
+
+	int out_width, out_height;
+	GetOutputSize(filter, frame.width(), frame.height(), width, height, out_width, out_height);
+
+	auto& out = outputs[back];
+	if (!out || out->width() != out_width || out->height() != out_height) {
+		out = Bitmap::Create(out_width, out_height, false);
+	}
+
+	if (!input || input->width() != frame.width() || input->height() != frame.height()) {
+		input = Bitmap::Create(frame.width(), frame.height(), false);
+	}
+	const size_t row_size = frame.width() * sizeof(uint32_t);
+	for (int y = 0; y < frame.height(); ++y) {
+		std::memcpy(Row(*input, y), Row(frame, y), row_size);
+	}
+
+	submitted = true;
+	back_returned = false;
+	StartJob();
+}
+
+const Bitmap* DisplayScaler::TakeReady() {
+	if (!front_ready) {
+		return nullptr;
+	}
+	front_ready = false;
+	return outputs[back ^ 1].get();
+}
+
+const Bitmap* DisplayScaler::Finish() {
+	if (!submitted || back_returned) {
+		return nullptr;
+	}
+
+	WaitJob();
+	back_returned = true;
+	// Never show an older image after this one
+	front_ready = false;
+	return outputs[back].get();
+}
+
+void DisplayScaler::GetOutputSize(Filter filter, int src_width, int src_height, int width, int height, int& out_width, int& out_height) {
+	switch (filter) {
+		case Filter::Nearest: {
+			// Largest size with the aspect ratio of the screen
+			if (static_cast<int64_t>(width) * src_height <= static_cast<int64_t>(height) * src_width) {
+				out_width = width;
+				out_height = static_cast<int>(static_cast<int64_t>(width) * src_height / src_width);
+			} else {
+				out_width = static_cast<int>(static_cast<int64_t>(height) * src_width / src_height);
+				out_height = height;
+			}
+			out_width = std::max(out_width, 1);
+			out_height = std::max(out_height, 1);
+			return;
+		}
+		case Filter::Integer: {
+			const int factor = std::max(1, std::min(width / src_width, height / src_height));
+			out_width = src_width * factor;
+			out_height = src_height * factor;
+			return;
+		}
+		case Filter::Scale2x:
+			out_width = src_width * 2;
+			out_height = src_height * 2;
+			return;
+		case Filter::None:
+			break;
+	}
+	out_width = src_width;
+	out_height = src_height;
+}
+
+void DisplayScaler::Scale(Filter filter, const Bitmap& src, Bitmap& dst) {
+	static Instrumentation::Zone zone("DisplayScaler::Scale");
+	Instrumentation::Scope scope(zone);
+
+	switch (filter) {
+		case Filter::Nearest:
+			ScaleNearest(src, dst);
+			break;
+		case Filter::Integer:
+			ScaleInteger(src, dst);
+			break;
+		case Filter::Scale2x:
+			ScaleScale2x(src, dst);
+			break;
+		case Filter::None:
+			assert(false);
+			break;
+	}
+}
+
+#ifdef HAVE_PRESENT_THREAD
+void DisplayScaler::StartJob() {
+	if (!thread.joinable()) {
+		thread = std::thread(&DisplayScaler::ThreadMain, this);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job_running = true;
+	}
+	work_cv.notify_one();
+}
+
+void DisplayScaler::WaitJob() {
+	std::unique_lock<std::mutex> lock(mutex);
+	done_cv.wait(lock, [this] { return !job_running; });
+}
+
+void DisplayScaler::ThreadMain() {
+	Instrumentation::SetThreadName("Present");
+
+	std::unique_lock<std::mutex> lock(mutex);
+	for (;;) {
+		work_cv.wait(lock, [this] { return quit || job_running; });
+		if (quit) {
+			return;
+		}
+
+		// The main thread does not touch input and outputs[back] while the job runs
+		lock.unlock();
+		Scale(filter, *input, *outputs[back]);
+		lock.lock();
+
+		job_running = false;
+		done_cv.notify_all();
+	}
+}
+#else
+void DisplayScaler::StartJob() {
+	Scale(filter, *input, *outputs[back]);
+}
+
+void DisplayScaler::WaitJob() {
+}
+#endif
@@ -0,0 +1,171 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DISPLAY_SCALER_H
+#define EP_DISPLAY_SCALER_H
+
+// Headers
+#include <array>
+#include <vector>
+#include "memory_management.h"
+#include "string_view.h"
+
+#ifdef HAVE_PRESENT_THREAD
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#endif
+
+/**
+ * Post-process stage of the display: scales the game screen to the window
+ * size in software, so that every UI gets the same pixel art filters.
+ *
+ * Scaling runs on a present thread. The scaled images are double
+ * buffered: while the UI shows frame N the thread scales frame N + 1,
+ * which overlaps the scaling with the game logic of the next frame.
+ */
+class DisplayScaler {
+public:
+	/** Scaling filters */
+	enum class Filter {
+		/** No post-processing, the UI scales the screen itself */
+		None,
+		/** Nearest neighbour scaling to the largest size which fits */
+		Nearest,
+		/** Scaling by the largest integer factor which fits */
+		Integer,
+		/** Scale2x pixel art filter, the UI scales the result to the window */
+		Scale2x
+	};
+
+	DisplayScaler() = default;
+	~DisplayScaler();
+
+	DisplayScaler(const DisplayScaler&) = delete;
+	DisplayScaler& operator=(const DisplayScaler&) = delete;
+
+	/**
+	 * @return whether scaling runs on a present thread, otherwise Submit
+	 * scales the frame before returning
+	 */
+	static bool IsThreaded();
+
+	/**
+	 * @param name filter name: none, nearest, integer or scale2x
+	 * @return filter, None for unknown names
+	 */
+	static Filter FilterFromName(StringView name);
+
+	/** @return the current filter */
+	Filter GetFilter() const;
+
+	/**
+	 * Changes the filter. Images not shown yet are discarded.
+	 *
+	 * @param filter new filter
+	 */
+	void SetFilter(Filter filter);
+
+	/**
+	 * Starts scaling of a frame. The frame is copied and can be changed
+	 * after the call. Waits until the previously submitted frame is scaled.
+	 *
+	 * @param frame game screen, 32 bit
+	 * @param width width of the display area in pixels
+	 * @param height height of the display area in pixels
+	 */
+	void Submit(const Bitmap& frame, int width, int height);
+
+	/**
+	 * Returns the scaled image of the frame submitted before the last
+	 * Submit call when it was not shown yet.
+	 *
+	 * @return scaled image or nullptr
+	 */
+	const Bitmap* TakeReady();
+
+	/**
+	 * Waits until the last submitted frame is scaled.
+	 *
+	 * @return scaled image or nullptr when it was already returned
+	 */
+	const Bitmap* Finish();
+
+	/** @return whether a scaled image was not returned yet */
+	bool IsPending() const;
+
+	/**
+	 * Calculates the size of the scaled image.
+	 *
+	 * @param filter scaling filter
+	 * @param src_width width of the game screen
+	 * @param src_height height of the game screen
+	 * @param width width of the display area
+	 * @param height height of the display area
+	 * @param out_width width of the scaled image
+	 * @param out_height height of the scaled image
+	 */
+	static void GetOutputSize(Filter filter, int src_width, int src_height, int width, int height, int& out_width, int& out_height);
+
+	/**
+	 * Scales src into dst with the filter.
+	 *
+	 * @param filter scaling filter, not None
+	 * @param src source image, 32 bit
+	 * @param dst destination image, 32 bit with the size of GetOutputSize
+	 */
+	static void Scale(Filter filter, const Bitmap& src, Bitmap& dst);
+
+private:
+	void StartJob();
+	void WaitJob();
+
+	Filter filter = Filter::None;
+
+	/** Copy of the submitted frame */
+	BitmapRef input;
+	/** Scaled images, the last submitted frame is scaled into outputs[back] */
+	std::array<BitmapRef, 2> outputs;
+	int back = 0;
+	/** A frame was submitted since the buffers were swapped */
+	bool submitted = false;
+	/** outputs[back] was returned by Finish */
+	bool back_returned = false;
+	/** outputs[back ^ 1] is finished and was not returned yet */
+	bool front_ready = false;
+
+#ifdef HAVE_PRESENT_THREAD
+	void ThreadMain();
+
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	bool job_running = false;
+	bool quit = false;
+#endif
+};
+
+inline DisplayScaler::Filter DisplayScaler::GetFilter() const {
+	return filter;
+}
+
+inline bool DisplayScaler::IsPending() const {
+	return front_ready || (submitted && !back_returned);
+}
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "draw_workers.h"
+#include "instrumentation.h"
+#include "utils.h"
+#include <vector>
+
+#ifdef HAVE_PARALLEL_DRAW
+#  include <condition_variable>
+#  include <mutex>
+#  include <thread>
+#endif
+
+namespace {
+	int thread_count = 1;
+}
+
+#ifdef HAVE_PARALLEL_DRAW
+namespace {
+	std::mutex mutex;
+	std::condition_variable work_cv;
+	std::condition_variable done_cv;
+	std::vector<std::thread> workers;
+	bool quit = false;
+
+	/** Current job, only valid while Run waits for it */
+	const std::function<void(int)>* job = nullptr;
+	int job_count = 0;
+	int next_task = 0;
+	int finished_tasks = 0;
+	/** Incremented for every job, wakes the workers */
+	unsigned job_generation = 0;
+
+	void RunTasks(std::unique_lock<std::mutex>& lock) {
+		while (next_task < job_count) {
+			const int index = next_task++;
+			const auto& task = *job;
+			lock.unlock();
+
+			task(index);
+
+			lock.lock();
+			if (++finished_tasks == job_count) {
+				done_cv.notify_all();
+			}
+		}
+	}
+
+	void WorkerMain() {
+		Instrumentation::SetThreadName("Draw worker");
+
+		std::unique_lock<std::mutex> lock(mutex);
+		unsigned generation = job_generation;
+		for (;;) {
+			work_cv.wait(lock, [&] { return quit || job_generation != generation; });
+			if (quit) {
+				return;
+			}
+			generation = job_generation;
+			RunTasks(lock);
+		}
+	}
+
+	void StopWorkers() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		work_cv.notify_all();
+		for (auto& worker : workers) {
+			worker.join();
+		}
+		workers.clear();
+		quit = false;
+	}
+
+	void StartWorkers() {
+		if (static_cast<int>(workers.size()) == thread_count - 1) {
+			return;
+		}
+		StopWorkers();
+		for (int i = 1; i < thread_count; ++i) {
+			workers.emplace_back(WorkerMain);
+		}
+	}
+}
+#endif
+
+bool DrawWorkers::IsSupported() {
+#ifdef HAVE_PARALLEL_DRAW
+	return true;
+#else
+	return false;
+#endif
+}
+
+void DrawWorkers::SetThreadCount(int count) {
+#ifdef HAVE_PARALLEL_DRAW
+	thread_count = Utils::Clamp(count, 1, 16);
+#else
+	(void)count;
+#endif
+}
+
+int DrawWorkers::GetThreadCount() {
+	return thread_count;
+}
+
+void DrawWorkers::Run(int count, const std::function<void(int)>& task) {
+#ifdef HAVE_PARALLEL_DRAW
+	if (thread_count > 1 && count > 1) {
+		StartWorkers();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		job = &task;
+		job_count = count;
+		next_task = 0;
+		finished_tasks = 0;
+		++job_generation;
+		work_cv.notify_all();
+
+		RunTasks(lock);
+		done_cv.wait(lock, [] { return finished_tasks == job_count; });
+
+		job = nullptr;
+		job_count = 0;
+		return;
+	}
+#endif
+
+	for (int i = 0; i < count; ++i) {
+		task(i);
+	}
+}
+
+void DrawWorkers::Quit() {
+#ifdef HAVE_PARALLEL_DRAW
+	StopWorkers();
+#endif
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_DRAW_WORKERS_H
+#define EP_DRAW_WORKERS_H
+
+// Headers
+#include <functional>
+
+/**
+ * DrawWorkers runs the band drawing of the screen on worker threads.
+ *
+ * The main thread takes part in the work, so N threads means N - 1 worker
+ * threads. With one thread or without thread support everything runs on
+ * the main thread. All functions must be called from the main thread.
+ */
+namespace DrawWorkers {
+	/** @return whether drawing can be split across threads */
+	bool IsSupported();
+
+	/**
+	 * Sets how many threads draw the screen.
+	 * The worker threads are started on the next call to Run.
+	 *
+	 * @param count number of threads including the main thread, 1 disables the workers
+	 */
+	void SetThreadCount(int count);
+
+	/** @return number of threads drawing the screen, 1 when not supported */
+	int GetThreadCount();
+
+	/**
+	 * Calls task(0) to task(count - 1), spread across the threads,
+	 * and returns when all calls finished.
+	 *
+	 * @param count number of tasks
+	 * @param task function called with the task index
+	 */
+	void Run(int count, const std::function<void(int)>& task);
+
+	/** Stops the worker threads. */
+	void Quit();
+}
+
+#endif
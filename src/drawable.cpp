@@ -24,10 +24,25 @@ Drawable::~Drawable() {
 }
 
 void Drawable::SetZ(int nz) {
-	if (_z != nz) DrawableMgr::OnUpdateZ(this);
+	if (_z != nz) {
+		DrawableMgr::OnUpdateZ(this);
+		// The drawing order against overlapping drawables changed
+		_damaged = true;
+	}
 	_z = nz;
 }
 
+Drawable::BandDraw Drawable::PrepareBandDraw(Bitmap& /* dst */) {
+	return BandDraw::Unsupported;
+}
+
+void Drawable::DrawBand(Bitmap& /* dst */) const {
+}
+
+bool Drawable::UpdateDamage(const Bitmap& /* dst */, Rect& /* rect */) {
+	return false;
+}
+
 int Drawable::GetPriorityForMapLayer(int which) {
 	switch (which) {
 		case lcf::rpg::SavePicture::MapLayer_parallax:
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include "rect.h"
 
 class Bitmap;
 class Drawable;
@@ -68,6 +69,16 @@ public:
 		Default = None
 	};
 
+	/** Result of PrepareBandDraw */
+	enum class BandDraw {
+		/** DrawBand() is not supported, the frame is drawn serially with Draw() */
+		Unsupported,
+		/** Nothing is drawn this frame */
+		Skip,
+		/** DrawBand() draws the prepared state */
+		Ready
+	};
+
 	Drawable(int z, Flags flags = Flags::Default);
 
 	Drawable(const Drawable&) = delete;
@@ -77,6 +88,27 @@ public:
 
 	virtual void Draw(Bitmap& dst) = 0;
 
+	/**
+	 * First step of drawing the screen in bands on several threads.
+	 * Called on the main thread once per frame. Everything Draw() does
+	 * besides drawing onto dst (refreshing cached bitmaps, reading the game
+	 * state) must happen here.
+	 *
+	 * @param dst bitmap which will be drawn onto, must not be modified
+	 * @return whether DrawBand() can draw the prepared state
+	 */
+	virtual BandDraw PrepareBandDraw(Bitmap& dst);
+
+	/**
+	 * Second step of drawing the screen in bands.
+	 * Called from several threads at once with a different clip rect on
+	 * dst, so it must only read the state prepared by PrepareBandDraw().
+	 * The pixels outside of the clip rect must not be touched.
+	 *
+	 * @param dst bitmap to draw onto
+	 */
+	virtual void DrawBand(Bitmap& dst) const;
+
 	int GetZ() const;
 
 	void SetZ(int z);
@@ -97,6 +129,25 @@ public:
 	 */
 	void SetVisible(bool value);
 
+	/**
+	 * Reports the area covered on dst for damage tracking.
+	 * Called every frame before drawing. Implementations call SetDamaged()
+	 * when the content changed without the area changing.
+	 *
+	 * @param dst bitmap which will be drawn onto
+	 * @param rect set to the covered area, empty when nothing is drawn
+	 * @return false when the area is unknown, the whole screen is redrawn every frame then
+	 */
+	virtual bool UpdateDamage(const Bitmap& dst, Rect& rect);
+
+	/**
+	 * Marks the drawable to be redrawn on the next frame.
+	 */
+	void SetDamaged();
+
+	/** @return true if the drawable changed since the last frame */
+	bool IsDamaged() const;
+
 	/**
 	 * Converts a RPG Maker map layer value into a EasyRPG priority value.
 	 *
@@ -111,8 +162,13 @@ public:
 	 */
 	static int GetPriorityForBattleLayer(int which);
 private:
+	friend class DrawableList;
+
 	int32_t _z = 0;
 	Flags _flags = Flags::Default;
+	/** Area covered on the last frame */
+	Rect _damage_rect;
+	bool _damaged = true;
 };
 
 inline Drawable::Flags operator|(Drawable::Flags l, Drawable::Flags r) {
@@ -157,4 +213,12 @@ inline void Drawable::SetVisible(bool value) {
 	_flags = value ? _flags & ~Flags::Invisible : _flags | Flags::Invisible;
 }
 
+inline void Drawable::SetDamaged() {
+	_damaged = true;
+}
+
+inline bool Drawable::IsDamaged() const {
+	return _damaged;
+}
+
 #endif
@@ -18,6 +18,10 @@
 // Headers
 #include "drawable_list.h"
 #include "drawable_mgr.h"
+#include "instrumentation.h"
+#include "damage_region.h"
+#include "draw_workers.h"
+#include "bitmap.h"
 #include <algorithm>
 #include <cassert>
 
@@ -69,6 +73,10 @@ Drawable* DrawableList::Take(Drawable* ptr) {
 	auto ret = *iter;
 	// FIXME: Can we remove this O(N) operation here?
 	_list.erase(iter);
+
+	if (!ret->_damage_rect.IsEmpty()) {
+		_removed_rects.push_back(ret->_damage_rect);
+	}
 	return ret;
 
 	// Removing doesn't change sorted order, so not dirty flag.
@@ -91,6 +99,9 @@ void DrawableList::TakeFrom(DrawableList& other) noexcept {
 }
 
 void DrawableList::Draw(Bitmap& dst, int min_z, int max_z) {
+	static Instrumentation::Zone zone("DrawableList::Draw");
+	Instrumentation::Scope scope(zone);
+
 	if (IsDirty()) {
 		Sort();
 	} else {
@@ -111,3 +122,156 @@ void DrawableList::Draw(Bitmap& dst, int min_z, int max_z) {
 	}
 }
 
+
+void DrawableList::Draw(Bitmap& dst, const Rect& area, int min_z, int max_z) {
+	static Instrumentation::Zone zone("DrawableList::Draw");
+	Instrumentation::Scope scope(zone);
+
+	if (IsDirty()) {
+		Sort();
+	} else {
+		assert(IsSorted());
+	}
+
+	for (auto* drawable : _list) {
+		auto z = drawable->GetZ();
+		if (z < min_z) {
+			continue;
+		}
+		if (z > max_z) {
+			break;
+		}
+		if (drawable->IsVisible() && !drawable->_damage_rect.IsOutOfBounds(area)) {
+			drawable->Draw(dst);
+		}
+	}
+}
+
+void DrawableList::DrawBands(Bitmap& dst, const std::vector<Rect>& areas, int bands, int min_z, int max_z) {
+	static Instrumentation::Zone zone("DrawableList::Draw");
+	Instrumentation::Scope scope(zone);
+
+	if (IsDirty()) {
+		Sort();
+	} else {
+		assert(IsSorted());
+	}
+
+	auto in_areas = [&areas](const Drawable* drawable) {
+		return std::any_of(areas.begin(), areas.end(), [drawable](const Rect& area) {
+			return !drawable->_damage_rect.IsOutOfBounds(area);
+		});
+	};
+
+	const auto first = std::find_if(_list.begin(), _list.end(), [min_z](Drawable* drawable) {
+		return drawable->GetZ() >= min_z;
+	});
+	const auto last = std::find_if(first, _list.end(), [max_z](Drawable* drawable) {
+		return drawable->GetZ() > max_z;
+	});
+
+	// All state changes happen here on the calling thread
+	_band_list.clear();
+	auto iter = first;
+	for (; iter != last; ++iter) {
+		auto* drawable = *iter;
+		if (!drawable->IsVisible() || !in_areas(drawable)) {
+			continue;
+		}
+
+		auto state = drawable->PrepareBandDraw(dst);
+		if (state == Drawable::BandDraw::Unsupported) {
+			break;
+		}
+		if (state == Drawable::BandDraw::Ready) {
+			_band_list.push_back(drawable);
+		}
+	}
+
+	if (iter != last) {
+		// Draw() of the prepared drawables is the same as DrawBand(), so
+		// they are drawn from their prepared state and the rest normally
+		for (auto& area : areas) {
+			dst.SetClipRect(area);
+			for (auto* drawable : _band_list) {
+				if (!drawable->_damage_rect.IsOutOfBounds(area)) {
+					drawable->DrawBand(dst);
+				}
+			}
+			for (auto it = iter; it != last; ++it) {
+				auto* drawable = *it;
+				if (drawable->IsVisible() && !drawable->_damage_rect.IsOutOfBounds(area)) {
+					drawable->Draw(dst);
+				}
+			}
+		}
+		dst.ClearClipRect();
+		return;
+	}
+
+	const int width = dst.GetWidth();
+	const int height = dst.GetHeight();
+	bands = std::max(1, std::min(bands, height));
+
+	// Every band draws through its own view of the pixels, a clip rect on
+	// dst would be shared between the threads. The views are created here,
+	// creating them touches dst.
+	std::vector<BitmapRef> views;
+	views.reserve(bands);
+	for (int band = 0; band < bands; ++band) {
+		views.push_back(dst.CreateView());
+	}
+
+	DrawWorkers::Run(bands, [&](int band) {
+		static Instrumentation::Zone band_zone("DrawableList::DrawBand");
+		Instrumentation::Scope band_scope(band_zone);
+
+		const int band_y = height * band / bands;
+		const Rect band_rect(0, band_y, width, height * (band + 1) / bands - band_y);
+
+		// Blits give the same pixels no matter how they are clipped, so the
+		// bands add up to the serial result.
+		auto& view = views[band];
+		for (auto& area : areas) {
+			Rect clip = area;
+			clip.Adjust(band_rect);
+			if (clip.IsEmpty()) {
+				continue;
+			}
+
+			view->SetClipRect(clip);
+			for (auto* drawable : _band_list) {
+				if (!drawable->_damage_rect.IsOutOfBounds(area)) {
+					drawable->DrawBand(*view);
+				}
+			}
+		}
+	});
+}
+
+void DrawableList::CollectDamage(const Bitmap& dst, DamageRegion& damage) {
+	for (auto& rect : _removed_rects) {
+		damage.Add(rect);
+	}
+	_removed_rects.clear();
+
+	for (auto* drawable : _list) {
+		Rect rect;
+		bool known = true;
+		if (drawable->IsVisible()) {
+			known = drawable->UpdateDamage(dst, rect);
+		}
+
+		if (!known) {
+			// Unknown area, assume it covers everything and changes every frame
+			rect = dst.GetRect();
+			damage.AddAll();
+		} else if (drawable->_damaged || rect != drawable->_damage_rect) {
+			damage.Add(drawable->_damage_rect);
+			damage.Add(rect);
+		}
+
+		drawable->_damage_rect = rect;
+		drawable->_damaged = false;
+	}
+}
@@ -19,10 +19,13 @@
 #define EP_DRAWABLE_LIST_H
 
 #include "drawable.h"
+#include "rect.h"
 #include <memory>
 #include <vector>
 #include <limits>
 
+class DamageRegion;
+
 /** A list of Drawable objects. These are used by the graphics engine store and
  * to render all drawable objects.
  */
@@ -131,8 +134,50 @@ class DrawableList {
 		 */
 		void Draw(Bitmap& dst, int min_z, int max_z);
 
+		/**
+		 * Sort the list if it's dirty, then call Draw() on every drawable which
+		 * covered area on the last CollectDamage() call overlaps area.
+		 *
+		 * @param dst The bitmap to draw onto
+		 * @param area Skip any drawables outside of this area
+		 * @param min_z Skip any drawables with z < min_z
+		 * @param max_z Skip any drawables with z > max_z
+		 */
+		void Draw(Bitmap& dst, const Rect& area, int min_z, int max_z);
+
+		/**
+		 * Sort the list if it's dirty, then draw every area like Draw(dst, area, min_z, max_z)
+		 * does. The screen is split into horizontal bands which are drawn in
+		 * parallel by the DrawWorkers threads.
+		 *
+		 * Every drawable is prepared on the calling thread first. When a drawable
+		 * does not support band drawing the remaining drawables are drawn
+		 * serially, so the result is always the same as with Draw().
+		 *
+		 * @param dst The bitmap to draw onto
+		 * @param areas Areas to draw, must not overlap
+		 * @param bands Number of horizontal bands
+		 * @param min_z Skip any drawables with z < min_z
+		 * @param max_z Skip any drawables with z > max_z
+		 */
+		void DrawBands(Bitmap& dst, const std::vector<Rect>& areas, int bands, int min_z, int max_z);
+
+		/**
+		 * Adds the areas which changed since the last call to damage.
+		 * This includes the old and new area of moved drawables and the
+		 * area of removed drawables.
+		 *
+		 * @param dst The bitmap that will be drawn onto
+		 * @param damage receives the changed areas
+		 */
+		void CollectDamage(const Bitmap& dst, DamageRegion& damage);
+
 	private:
 		std::vector<Drawable*> _list;
+		/** Areas of removed drawables which were not collected yet */
+		std::vector<Rect> _removed_rects;
+		/** Drawables prepared by DrawBands */
+		std::vector<Drawable*> _band_list;
 		bool _dirty = false;
 
 		void SetClean();
@@ -244,7 +244,7 @@ Font::GlyphRet BitmapFont::Glyph(char32_t code) {
 	auto height = glyph->fullHeight? FULL_HEIGHT : HALF_HEIGHT;
 
 	glyph_bm->Clear();
-	uint8_t* data = reinterpret_cast<uint8_t*>(glyph_bm->pixels());
+	uint8_t* data = reinterpret_cast<uint8_t*>(glyph_bm->MutablePixels());
 	int pitch = glyph_bm->pitch();
 	for(size_t y_ = 0; y_ < height; ++y_)
 		for(size_t x_ = 0; x_ < width; ++x_)
@@ -306,7 +306,7 @@ Font::GlyphRet FTFont::Glyph(char32_t glyph) {
 	int const height = ft_bitmap.rows;
 
 	BitmapRef bm = Bitmap::Create(nullptr, width, height, 0, DynamicFormat(8,8,0,8,0,8,0,8,0,PF::Alpha));
-	uint8_t* data = reinterpret_cast<uint8_t*>(bm->pixels());
+	uint8_t* data = reinterpret_cast<uint8_t*>(bm->MutablePixels());
 	int dst_pitch = bm->pitch();
 
 	for(int row = 0; row < height; ++row) {
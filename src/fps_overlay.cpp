@@ -62,6 +62,20 @@ bool FpsOverlay::Update() {
 	return true;
 }
 
+bool FpsOverlay::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	if (!draw_fps && last_speed_mod <= 1) {
+		return true;
+	}
+
+	if (fps_dirty || speedup_dirty) {
+		SetDamaged();
+	}
+
+	// Both texts are in the top line of the screen
+	rect = Rect(0, 0, dst.GetWidth(), Font::Default()->GetSize(text).height + 2);
+	return true;
+}
+
 void FpsOverlay::Draw(Bitmap& dst) {
 	if (draw_fps) {
 		if (fps_dirty) {
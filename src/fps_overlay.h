@@ -35,6 +35,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	/**
 	 * Update the fps overlay.
 	 *
@@ -42,11 +42,27 @@ void Frame::Update() {
 }
 
 void Frame::Draw(Bitmap& dst) {
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
+}
+
+Drawable::BandDraw Frame::PrepareBandDraw(Bitmap& /* dst */) {
+	return frame_bitmap ? BandDraw::Ready : BandDraw::Skip;
+}
+
+void Frame::DrawBand(Bitmap& dst) const {
+	dst.Blit(0, 0, *frame_bitmap, frame_bitmap->GetRect(), 255);
+}
+
+bool Frame::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
 	if (frame_bitmap) {
-		dst.Blit(0, 0, *frame_bitmap, frame_bitmap->GetRect(), 255);
+		rect = frame_bitmap->GetRect();
 	}
+	return true;
 }
 
 void Frame::OnFrameGraphicReady(FileRequestResult* result) {
 	frame_bitmap = Cache::Frame(result->file);
+	SetDamaged();
 }
@@ -32,8 +32,14 @@ public:
 	Frame();
 
 	void Draw(Bitmap& dst) override;
+
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
 	void Update();
 
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 private:
 	void OnFrameGraphicReady(FileRequestResult* result);
 
@@ -0,0 +1,74 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "frame_stats.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <fmt/format.h>
+
+namespace {
+	double ToMs(Game_Clock::duration dt) {
+		return std::chrono::duration<double, std::milli>(dt).count();
+	}
+
+	double Percentile(const std::vector<double>& sorted, double p) {
+		auto rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+		return sorted[std::max<size_t>(rank, 1) - 1];
+	}
+}
+
+void FrameStats::AddUpdate(const std::string& scene, Game_Clock::duration dt) {
+	scenes[scene].update.push_back(ToMs(dt));
+}
+
+void FrameStats::AddDraw(const std::string& scene, Game_Clock::duration dt) {
+	scenes[scene].draw.push_back(ToMs(dt));
+}
+
+FrameStats::Summary FrameStats::Summarize(std::vector<double> samples) {
+	Summary s;
+	if (samples.empty()) {
+		return s;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	s.count = static_cast<int>(samples.size());
+	s.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+	s.p50 = Percentile(samples, 0.5);
+	s.p99 = Percentile(samples, 0.99);
+	return s;
+}
+
+std::vector<std::string> FrameStats::GetReport() const {
+	std::vector<std::string> lines;
+	lines.push_back(fmt::format("{:<12} {:>7} | {:>27} | {:>27}", "Scene", "Frames", "Update mean/p50/p99 (ms)", "Draw mean/p50/p99 (ms)"));
+
+	for (auto& scene : scenes) {
+		auto update = Summarize(scene.second.update);
+		auto draw = Summarize(scene.second.draw);
+		lines.push_back(fmt::format("{:<12} {:>7} | {:>8.3f} {:>8.3f} {:>9.3f} | {:>8.3f} {:>8.3f} {:>9.3f}",
+			scene.first, std::max(update.count, draw.count),
+			update.mean, update.p50, update.p99,
+			draw.mean, draw.p50, draw.p99));
+	}
+
+	return lines;
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_FRAME_STATS_H
+#define EP_FRAME_STATS_H
+
+// Headers
+#include <map>
+#include <string>
+#include <vector>
+#include "game_clock.h"
+
+/**
+ * Collects the update and draw time of every frame of a benchmark run,
+ * grouped by the scene which was active.
+ */
+class FrameStats {
+public:
+	/** Statistics of a series of durations in milliseconds */
+	struct Summary {
+		int count = 0;
+		double mean = 0.0;
+		double p50 = 0.0;
+		double p99 = 0.0;
+	};
+
+	/**
+	 * Adds the time of the game logic of a frame.
+	 *
+	 * @param scene name of the scene
+	 * @param dt time spent
+	 */
+	void AddUpdate(const std::string& scene, Game_Clock::duration dt);
+
+	/**
+	 * Adds the time of drawing a frame.
+	 *
+	 * @param scene name of the scene
+	 * @param dt time spent
+	 */
+	void AddDraw(const std::string& scene, Game_Clock::duration dt);
+
+	/**
+	 * Formats a table with the update and draw statistics of every scene.
+	 *
+	 * @return one entry per line
+	 */
+	std::vector<std::string> GetReport() const;
+
+	/**
+	 * Calculates mean and percentiles, nearest rank method.
+	 *
+	 * @param samples durations in milliseconds
+	 * @return statistics, all zero for no samples
+	 */
+	static Summary Summarize(std::vector<double> samples);
+
+private:
+	struct Samples {
+		std::vector<double> update;
+		std::vector<double> draw;
+	};
+
+	std::map<std::string, Samples> scenes;
+};
+
+#endif
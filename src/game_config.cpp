@@ -19,6 +19,7 @@
 #include "cmdline_parser.h"
 #include "filefinder.h"
 #include "output.h"
+#include "utils.h"
 #include <lcf/inireader.h>
 #include <cstring>
 
@@ -116,6 +117,37 @@ void Game_Config::LoadFromArgs(CmdlineParser& cp) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 1, "--cache-size")) {
+			if (arg.ParseValue(0, li_value)) {
+				video.cache_size.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--tone-cache-size")) {
+			if (arg.ParseValue(0, li_value)) {
+				video.tone_cache_size.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--se-cache-size")) {
+			if (arg.ParseValue(0, li_value)) {
+				audio.se_cache_size.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--render-threads")) {
+			if (arg.ParseValue(0, li_value)) {
+				video.render_threads.Set(li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--scaling-filter")) {
+			std::string svalue;
+			if (arg.ParseValue(0, svalue)) {
+				video.scaling_filter.Set(Utils::LowerCase(svalue));
+			}
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--autobattle-algo")) {
 			std::string svalue;
 			if (arg.ParseValue(0, svalue)) {
@@ -180,8 +212,23 @@ void Game_Config::LoadFromConfig(const std::string& path) {
 	if (ini.HasValue("video", "window-zoom")) {
 		video.window_zoom.Set(ini.GetInteger("video", "window-zoom", 0));
 	}
+	if (ini.HasValue("video", "cache-size")) {
+		video.cache_size.Set(ini.GetInteger("video", "cache-size", 0));
+	}
+	if (ini.HasValue("video", "tone-cache-size")) {
+		video.tone_cache_size.Set(ini.GetInteger("video", "tone-cache-size", 0));
+	}
+	if (ini.HasValue("video", "render-threads")) {
+		video.render_threads.Set(ini.GetInteger("video", "render-threads", 0));
+	}
+	if (ini.HasValue("video", "scaling-filter")) {
+		video.scaling_filter.Set(Utils::LowerCase(ini.GetString("video", "scaling-filter", "none")));
+	}
 
 	/** AUDIO SECTION */
+	if (ini.HasValue("audio", "se-cache-size")) {
+		audio.se_cache_size.Set(ini.GetInteger("audio", "se-cache-size", 0));
+	}
 
 	/** INPUT SECTION */
 }
@@ -221,10 +268,28 @@ void Game_Config::WriteToConfig(const std::string& path) const {
 	if (video.window_zoom.Enabled()) {
 		of << "window-zoom=" << video.window_zoom.Get() << "\n";
 	}
+	if (video.cache_size.Enabled()) {
+		of << "cache-size=" << video.cache_size.Get() << "\n";
+	}
+	if (video.tone_cache_size.Enabled()) {
+		of << "tone-cache-size=" << video.tone_cache_size.Get() << "\n";
+	}
+	if (video.render_threads.Enabled()) {
+		of << "render-threads=" << video.render_threads.Get() << "\n";
+	}
+	if (video.scaling_filter.Enabled()) {
+		of << "scaling-filter=" << video.scaling_filter.Get() << "\n";
+	}
 	of << "\n";
 
 	/** AUDIO SECTION */
 
+	of << "[audio]\n";
+	if (audio.se_cache_size.Enabled()) {
+		of << "se-cache-size=" << audio.se_cache_size.Get() << "\n";
+	}
+	of << "\n";
+
 	/** INPUT SECTION */
 }
 
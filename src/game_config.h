@@ -35,9 +35,19 @@ struct Game_ConfigVideo {
 	BoolConfigParam fps_render_window{ false };
 	RangeConfigParam<int> fps_limit{ DEFAULT_FPS, 0, std::numeric_limits<int>::max() };
 	RangeConfigParam<int> window_zoom{ 2, 1, std::numeric_limits<int>::max() };
+	/** Memory limit of the bitmap cache in MiB */
+	RangeConfigParam<int> cache_size{ 10, 1, std::numeric_limits<int>::max() };
+	/** Memory limit of the toned chipset copies in MiB */
+	RangeConfigParam<int> tone_cache_size{ 8, 0, std::numeric_limits<int>::max() };
+	/** Number of threads drawing the frame, 1 draws on the main thread only */
+	RangeConfigParam<int> render_threads{ 1, 1, 16 };
+	/** Software scaling filter of the display, see DisplayScaler */
+	SetConfigParam<std::string> scaling_filter{ "none", { "none", "nearest", "integer", "scale2x" } };
 };
 
 struct Game_ConfigAudio {
+	/** Memory limit of the decoded sound effects in MiB */
+	RangeConfigParam<int> se_cache_size{ 8, 0, std::numeric_limits<int>::max() };
 };
 
 struct Game_ConfigInput {
@@ -23,6 +23,7 @@
 #include <cassert>
 #include <ctime>
 #include "game_interpreter.h"
+#include "instrumentation.h"
 #include "audio.h"
 #include "dynrpg.h"
 #include "filefinder.h"
@@ -336,6 +337,9 @@ int Game_Interpreter::GetSubcommandIndex(int indent) const {
 
 // Update
 void Game_Interpreter::Update(bool reset_loop_count) {
+	static Instrumentation::Zone zone("Game_Interpreter::Update");
+	Instrumentation::Scope scope(zone);
+
 	if (reset_loop_count) {
 		loop_count = 0;
 	}
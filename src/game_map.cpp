@@ -21,6 +21,7 @@
 #include <sstream>
 #include <algorithm>
 #include <climits>
+#include <map>
 
 #include "async_handler.h"
 #include "system.h"
@@ -51,6 +52,7 @@
 #include <lcf/rpg/save.h>
 #include "scene_gameover.h"
 #include "game_multiplayer.h"
+#include "instrumentation.h"
 
 namespace {
 	lcf::rpg::SaveMapInfo map_info;
@@ -75,6 +77,46 @@ namespace {
 	//FIXME: Find a better way to do this.
 	bool reset_panorama_x_on_next_init = true;
 	bool reset_panorama_y_on_next_init = true;
+
+	/**
+	 * Maximum number of sound effects preloaded per map.
+	 * Every preload decodes the whole file while the map is loaded.
+	 */
+	constexpr size_t max_preloaded_sounds = 16;
+
+	/** Decodes the most used sound effects of the map events in advance with the pitches they are played with */
+	void PreloadSoundEffects(const lcf::rpg::Map& map) {
+		std::map<std::pair<std::string, int>, int> uses;
+
+		for (const auto& ev : map.events) {
+			for (const auto& page : ev.pages) {
+				for (const auto& com : page.event_commands) {
+					if (static_cast<lcf::rpg::EventCommand::Code>(com.code) == lcf::rpg::EventCommand::Code::PlaySound
+							&& com.parameters.size() >= 2 && com.parameters[0] > 0) {
+						++uses[{ ToString(com.string), com.parameters[1] }];
+					}
+				}
+				for (const auto& move_command : page.move_route.move_commands) {
+					if (static_cast<lcf::rpg::MoveCommand::Code>(move_command.command_id) == lcf::rpg::MoveCommand::Code::play_sound_effect
+							&& move_command.parameter_a > 0) {
+						++uses[{ ToString(move_command.parameter_string), move_command.parameter_b }];
+					}
+				}
+			}
+		}
+
+		std::vector<std::pair<std::pair<std::string, int>, int>> sounds(uses.begin(), uses.end());
+		std::stable_sort(sounds.begin(), sounds.end(), [](const auto& l, const auto& r) {
+			return l.second > r.second;
+		});
+		if (sounds.size() > max_preloaded_sounds) {
+			sounds.resize(max_preloaded_sounds);
+		}
+
+		for (const auto& sound : sounds) {
+			Main_Data::game_system->SePreload(sound.first.first, sound.first.second);
+		}
+	}
 }
 
 namespace Game_Map {
@@ -355,6 +397,8 @@ void Game_Map::SetupCommon() {
 	for (const auto& ev : map->events) {
 		events.emplace_back(GetMapId(), &ev);
 	}
+
+	PreloadSoundEffects(*map);
 }
 
 void Game_Map::PrepareSave(lcf::rpg::Save& save) {
@@ -941,6 +985,9 @@ int Game_Map::CheckEvent(int x, int y) {
 }
 
 void Game_Map::Update(MapUpdateAsyncContext& actx, bool is_preupdate) {
+	static Instrumentation::Zone zone("Game_Map::Update");
+	Instrumentation::Scope scope(zone);
+
 	if (GetNeedRefresh()) {
 		Refresh();
 	}
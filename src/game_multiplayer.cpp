@@ -1,9 +1,16 @@
-#include <map>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
 #include <memory>
-#include <queue>
 #include <set>
-#include <emscripten/emscripten.h>
-#include <emscripten/websocket.h>
+#include <unordered_map>
+#include <vector>
+#ifdef EMSCRIPTEN
+#  include <emscripten/emscripten.h>
+#endif
 
 #include "game_multiplayer.h"
 #include "chat_multiplayer.h"
@@ -23,14 +30,185 @@
 #include "game_switches.h"
 #include "game_map.h"
 #include "player.h"
+#include "multiplayer_transport.h"
+#include "multiplayer_packet.h"
+#include "multiplayer_stats_overlay.h"
+#include "game_clock.h"
+#include "utils.h"
+
+//all nicknames are rendered once into one shared bitmap, equal names share an entry
+class NicknameAtlas {
+	public:
+	//returns the area of the rendered text in GetBitmap(), adds a reference
+	Rect Acquire(const std::string& text) {
+		CheckStyle();
+		auto it = entries.find(text);
+		if (it == entries.end()) {
+			Entry entry;
+			Rect size = Font::Tiny()->GetSize(text);
+			entry.rect = Allocate(size.width + 1, size.height + 1);
+			it = entries.emplace(text, entry).first;
+			Render(it->first, it->second.rect);
+		}
+		++it->second.refs;
+		return it->second.rect;
+	}
+
+	//drops a reference, the entry is evicted when no player uses the name anymore
+	void Release(const std::string& text) {
+		auto it = entries.find(text);
+		if (it == entries.end())
+			return;
+		if (--it->second.refs > 0)
+			return;
+		bitmap->ClearRect(it->second.rect);
+		Free(it->second.rect);
+		entries.erase(it);
+	}
+
+	const Bitmap& GetBitmap() const {
+		return *bitmap;
+	}
+
+	//system graphic change: all names are drawn again with the new colors
+	//called every frame by the names, so existing names follow the change
+	void CheckStyle() {
+		auto current = Cache::SystemOrBlack();
+		if (current == system)
+			return;
+		system = current;
+		if (!bitmap)
+			return;
+		bitmap->Clear();
+		for (auto& e : entries) {
+			Render(e.first, e.second.rect);
+		}
+	}
+
+	private:
+	struct Entry {
+		Rect rect;
+		int refs = 0;
+	};
+
+	//a row of equal height, free holds the unused [x, x + width) spans
+	struct Shelf {
+		int y;
+		int height;
+		std::vector<std::pair<int, int>> free;
+	};
+
+	//widened for names which don't fit
+	int atlasWidth = 256;
+
+	void Render(const std::string& text, Rect rect) {
+		Color shadowColor = Color(0, 0, 0, 255); // shadow color
+		Text::Draw(*bitmap, rect.x + 1, rect.y + 1, *Font::Tiny(), shadowColor, text); // draw black fallback shadow
+		Text::Draw(*bitmap, rect.x, rect.y, *Font::Tiny(), *system, 0, text);
+	}
+
+	Rect Allocate(int width, int height) {
+		Widen(width);
+		for (auto& shelf : shelves) {
+			if (shelf.height != height)
+				continue;
+			for (auto& span : shelf.free) {
+				if (span.second < width)
+					continue;
+				Rect rect(span.first, shelf.y, width, height);
+				span.first += width;
+				span.second -= width;
+				return rect;
+			}
+		}
+
+		Shelf shelf;
+		shelf.y = shelves.empty() ? 0 : shelves.back().y + shelves.back().height;
+		shelf.height = height;
+		shelf.free.emplace_back(width, atlasWidth - width);
+		shelves.push_back(shelf);
+		Grow(shelf.y + height);
+		return Rect(0, shelf.y, width, height);
+	}
+
+	void Free(Rect rect) {
+		for (auto& shelf : shelves) {
+			if (shelf.y != rect.y)
+				continue;
+			auto& free = shelf.free;
+			auto it = std::lower_bound(free.begin(), free.end(), std::make_pair(rect.x, 0));
+			it = free.insert(it, std::make_pair(rect.x, rect.width));
+			//merge with the following and the preceding span
+			auto next = it + 1;
+			if (next != free.end() && it->first + it->second == next->first) {
+				it->second += next->second;
+				free.erase(next);
+			}
+			if (it != free.begin()) {
+				auto prev = it - 1;
+				if (prev->first + prev->second == it->first) {
+					prev->second += it->second;
+					free.erase(it);
+				}
+			}
+			return;
+		}
+	}
+
+	//the width doubles until the name fits, every shelf gets the new space
+	void Widen(int width) {
+		if (width <= atlasWidth)
+			return;
+		int new_width = atlasWidth;
+		while (new_width < width)
+			new_width *= 2;
+		for (auto& shelf : shelves) {
+			auto& free = shelf.free;
+			if (!free.empty() && free.back().first + free.back().second == atlasWidth) {
+				free.back().second += new_width - atlasWidth;
+			} else {
+				free.emplace_back(atlasWidth, new_width - atlasWidth);
+			}
+		}
+		atlasWidth = new_width;
+		if (bitmap)
+			Grow(bitmap->GetHeight());
+	}
+
+	//the bitmap doubles in height, entries keep their position
+	void Grow(int height) {
+		if (bitmap && bitmap->GetHeight() >= height && bitmap->GetWidth() == atlasWidth)
+			return;
+		int new_height = bitmap ? bitmap->GetHeight() : 32;
+		while (new_height < height)
+			new_height *= 2;
+		auto grown = Bitmap::Create(atlasWidth, new_height, true);
+		if (bitmap)
+			grown->Blit(0, 0, *bitmap, bitmap->GetRect(), Opacity::Opaque());
+		bitmap = grown;
+	}
+
+	BitmapRef bitmap;
+	BitmapRef system;
+	std::unordered_map<std::string, Entry> entries;
+	std::vector<Shelf> shelves;
+};
+
+static NicknameAtlas nickname_atlas;
 
 class MultiplayerText : Drawable {
 	public:
+		using Drawable::SetVisible;
 
 		MultiplayerText() : Drawable(Priority_Frame) {
 		DrawableMgr::Register(this);
 	}
 
+	~MultiplayerText() override {
+		if (!text.empty())
+			nickname_atlas.Release(text);
+	}
+
 	//sets character that text will be drawn on top
 	void SetAnchorCharacter(std::shared_ptr<Game_Character> anchor) {
 		this->anchor = anchor;
@@ -40,63 +218,97 @@ class MultiplayerText : Drawable {
 		this->anchor.reset();
 	}
 
-	//sets text and draws in into bitmap
+	//sets text and takes its entry from the nickname atlas
 	void SetText(std::string text) {
+		if (text == this->text)
+			return;
+		if (!this->text.empty())
+			nickname_atlas.Release(this->text);
+
 		this->text = text;
+		SetDamaged();
 
 		if(text == "")
 			return;
 
-		/*Rect textrect = Font::Default()->GetSize(text);
-		Rect scaledrect = textrect;
-
-		if(scaledrect.width > maxWidth) {
-			scaledrect = Rect(0, 0, maxWidth, scaledrect.height * maxWidth / scaledrect.width);
-		}
-
-		textbitmap = Bitmap::Create(textrect.width + 1, textrect.height + 1, true);
-		scaledbitmap = Bitmap::Create(scaledrect.width + 1, scaledrect.height + 1);
-		Color color = Color(255, 255, 255, 255);
-		Text::Draw(*textbitmap, 0, 0, *Font::Default(), color, text);
-		scaledbitmap->StretchBlit(*textbitmap, textbitmap->GetRect(), Opacity::Opaque());*/
-
-		Rect textrect = Font::Tiny()->GetSize(text);
-		scaledbitmap = Bitmap::Create(textrect.width+1, textrect.height+1);
-		Color shadowColor = Color(0, 0, 0, 255); // shadow color
-		Text::Draw(*scaledbitmap, 1, 1, *Font::Tiny(), shadowColor, text); // draw black fallback shadow
-		Text::Draw(*scaledbitmap, 0, 0, *Font::Tiny(), *Cache::SystemOrBlack(), 0, text);
+		rect = nickname_atlas.Acquire(text);
 	}
 
 	void SetMaxWidth(int width) {
 		this->maxWidth = width;
 	}
 
+	bool UpdateDamage(const Bitmap& /* dst */, Rect& damage_rect) override {
+		if (text == "" || !anchor)
+			return true;
+
+		// the atlas is redrawn when the system graphic changes
+		nickname_atlas.CheckStyle();
+		auto revision = nickname_atlas.GetBitmap().GetRevision();
+		if (revision != atlasRevision) {
+			atlasRevision = revision;
+			SetDamaged();
+		}
+
+		damage_rect = Rect(GetDrawX(), GetDrawY(), rect.width, rect.height);
+		return true;
+	}
+
 	void Draw(Bitmap& dst) override {
-		if(text == "")
-			return;
+		if (PrepareBandDraw(dst) == BandDraw::Ready) {
+			DrawBand(dst);
+		}
+	}
 
-		Rect rect = scaledbitmap->GetRect();
+	BandDraw PrepareBandDraw(Bitmap& /* dst */) override {
+		return text == "" ? BandDraw::Skip : BandDraw::Ready;
+	}
 
-		dst.Blit(anchor->GetScreenX() - rect.width / 2, anchor->GetScreenY() - rect.height - TILE_SIZE * 1.75, *scaledbitmap, rect, Opacity::Opaque());
+	void DrawBand(Bitmap& dst) const override {
+		dst.Blit(GetDrawX(), GetDrawY(), nickname_atlas.GetBitmap(), rect, Opacity::Opaque());
 	}
 
 	private:
+	int GetDrawX() const {
+		return anchor->GetScreenX() - rect.width / 2;
+	}
+
+	int GetDrawY() const {
+		return anchor->GetScreenY() - rect.height - TILE_SIZE * 1.75;
+	}
+
 	std::shared_ptr<Game_Character> anchor;
 	std::string text;
-	//BitmapRef textbitmap;
-	BitmapRef scaledbitmap;
+	//area of the text in the nickname atlas
+	Rect rect;
+	uint32_t atlasRevision = 0;
 	int maxWidth;
 	int ttl;
 	bool ttluse;
 };
 
+//received position, frame is the Player::GetFrames() it is due for playback
+struct MPSnapshot {
+	int x = 0;
+	int y = 0;
+	int frame = 0;
+};
+
 struct MPPlayer {
-	std::queue<std::pair<int,int>> mvq; //queue of move commands
+	int id = -1; //per session id, see playerSlots
+	std::deque<MPSnapshot> mvq; //received positions, played back interpolationDelay frames late
+	MPSnapshot last; //newest received position
+	int interval = 16; //smoothed frames between received positions
+	int lastDir = -1; //direction of the last played step, -1 after a jump
+	int straightSteps = 0; //consecutive played steps in lastDir
+	int extrapolatedSteps = 0; //steps predicted since the last received position
 	std::shared_ptr<Game_PlayerOther> ch; //character
 	//this one is used to save player speed before setting it to max speed when move queue is too long
-	int moveSpeed;
+	int moveSpeed = 4;
 	std::unique_ptr<Sprite_Character> sprite;
 	std::unique_ptr<MultiplayerText> nickname;
+	//false while far away from the screen: no sprite, no movement animation
+	bool active = true;
 };
 
 std::string multiplayer__my_name = "";
@@ -112,8 +324,25 @@ namespace {
 		const uint16_t movementAnimationSpeed = 6;
 		const uint16_t variable = 7;
 		const uint16_t switchsync = 8;
+		//all packets of one frame: [uint16 batch] then ([uint16 size] [packet]) per packet
+		//only sent to servers using schema 1 or newer, older servers get one message per packet
+		const uint16_t batch = 9;
+		//binary inbound: following records of the message apply to this player
+		const uint16_t uid = 10;
+		//binary inbound: player left the room
+		const uint16_t disconnect = 11;
+		//[uint16 protocol] [uint16 version], asks the server for binary inbound messages
+		const uint16_t protocol = 12;
+		//steps since the last position: [uint16 movementDelta] ([uint8 direction] [uint8 steps])...
+		//only sent to servers using schema 2 or newer, movement stays the absolute keyframe
+		const uint16_t movementDelta = 13;
+		//[uint16 ping] [uint32 client time in ms], servers using schema 3 or newer echo it back
+		const uint16_t ping = 14;
 	};
 
+	//newest binary inbound schema this client understands
+	const uint16_t protocolVersion = 3;
+
 	namespace MultiplayerSettings {
 		uint8_t playersVolume = 50;
 		uint8_t mAnimSpeed = 2;
@@ -122,45 +351,239 @@ namespace {
 		uint8_t weatherT = 0;
 		int nextWeatherType = -1;
 		int nextWeatherStrength = -1;
+
+		//remote players up to this many tiles outside of the screen are simulated and drawn
+		int interestMargin = 4;
+		//extra tiles before an active player is parked again, avoids flickering at the border
+		int interestHysteresis = 2;
+
+		//frames received positions are held back, absorbs jitter and bursts
+		int interpolationDelay = 4;
+		//steps a walking player is moved ahead when its next position is late
+		int maxExtrapolationSteps = 1;
+
+		//minimum frames between two movement packets, steps in between are combined
+		int movementSendInterval = 6;
+		//frames between absolute positions while moving, resyncs lost or misapplied deltas
+		int movementKeyframeInterval = 300;
 	
 		int switchsync;
 		std::set<int> syncedswitches = std::set<int>();
 
 		std::string spritesheet = "";
 		int spriteid = 0;
+
+		//game name sent on connect, the web player uses Player::emscripten_game_name
+		std::string game_name = "";
 	}
 
 	std::unique_ptr<Window_Base> conn_status_window;
 	//const std::string server_url = "wss://dry-lowlands-62918.herokuapp.com/";
 	std::string server_url = "";
-	EMSCRIPTEN_WEBSOCKET_T socket;
+	std::unique_ptr<MultiplayerTransport> transport;
 	bool connected = false;
 	std::string myuuid = "";
 	int room_id = -1;
-	std::map<std::string,MPPlayer> players;
+	//binary schema of the server, 0 until the first binary message arrived
+	uint16_t serverProtocolVersion = 0;
+	//remote players, kept dense so Update walks them in order
+	std::vector<MPPlayer> players;
+	//per session player id -> index in players, -1 for unused ids
+	std::vector<int> playerSlots;
+	std::vector<int> freePlayerIds;
+	//server uuid -> per session player id, only used when a uuid is received
+	std::unordered_map<std::string, int> playerIds;
 	const std::string delimchar = "\uffff";
 
 	#define SEND_BUFFER_SIZE 2048
-	#define RECEIVE_BUFFER_SIZE 8192
+	//flush early when a frame produces more than this
+	#define SEND_QUEUE_FLUSH_SIZE 16384
 	char sendBuffer[SEND_BUFFER_SIZE];
-	char receiveBuffer[RECEIVE_BUFFER_SIZE];
 
-	void TrySend(std::string msg) {
-		if (!connected) return;
-		unsigned short ready;
-		emscripten_websocket_get_ready_state(socket, &ready);
-		if (ready == 1) { //1 means OPEN
-			emscripten_websocket_send_binary(socket, (void*)msg.c_str(), msg.length());
+	//packets queued during this frame, already in batch layout
+	std::vector<char> sendQueue;
+	int sendQueueCount = 0;
+
+	//network statistics, counted per second and shown by the stats overlay
+	namespace NetStats {
+		//packet types below this are counted separately, 0 counts JSON messages
+		constexpr int numTypes = 16;
+		const char* const typeNames[numTypes] = {
+			"json", "move", "sprite", "sound", "weather", "name", "speed", "var",
+			"switch", "batch", "uid", "leave", "proto", "delta", "ping", "other"
+		};
+
+		struct Counters {
+			std::array<int, numTypes> packetsSent = {};
+			std::array<int, numTypes> packetsReceived = {};
+			int messagesSent = 0;
+			int bytesSent = 0;
+			int messagesReceived = 0;
+			int bytesReceived = 0;
+			Game_Clock::duration parseTime = {};
+			Game_Clock::duration parseTimeMax = {};
+			int sendQueueMax = 0;
+			int frames = 0;
+		};
+
+		//the second being counted and the last complete one
+		Counters current;
+		Counters last;
+		Game_Clock::duration lastLength = {};
+		Game_Clock::time_point windowStart;
+		Game_Clock::duration frameParseTime = {};
+
+		//round trip time in ms, -1 while the server did not answer a ping
+		int rtt = -1;
+		int rttAvg = -1;
+		Game_Clock::time_point lastPing;
+
+		std::unique_ptr<MultiplayerStatsOverlay> overlay;
+
+		void CountPacket(std::array<int, numTypes>& counts, int type) {
+			++counts[std::min(type, numTypes - 1)];
 		}
 	}
 
+	//sends immediately, used for the connection handshake
+	void SendNow(const void* buffer, size_t size) {
+		if (!connected || !transport) return;
+		transport->Send(buffer, size);
+		++NetStats::current.messagesSent;
+		NetStats::current.bytesSent += size;
+	}
+
+	void SendNow(const std::string& msg) {
+		SendNow(msg.data(), msg.length());
+	}
+
+	void FlushSendQueue() {
+		if (sendQueueCount == 0)
+			return;
+		if (sendQueueCount == 1) {
+			//a single packet goes out as is, without batch overhead
+			const size_t offset = sizeof(uint16_t) * 2;
+			SendNow(sendQueue.data() + offset, sendQueue.size() - offset);
+		} else {
+			SendNow(sendQueue.data(), sendQueue.size());
+		}
+		sendQueue.clear();
+		sendQueueCount = 0;
+	}
+
+	//queues a packet, everything queued is sent by Game_Multiplayer::Flush at frame end
+	//until the server announced a schema that knows batches every packet is sent directly
 	void TrySend(const void* buffer, size_t size) {
-		if (!connected) return;
-		unsigned short ready;
-		emscripten_websocket_get_ready_state(socket, &ready);
-		if (ready == 1) { //1 means OPEN
-			emscripten_websocket_send_binary(socket, (void*)buffer, size);
+		if (!connected || !transport) return;
+		if (size > UINT16_MAX) {
+			Output::Debug("Multiplayer: packet of {} bytes dropped", size);
+			return;
 		}
+		if (size >= sizeof(uint16_t)) {
+			uint16_t type;
+			memcpy(&type, buffer, sizeof(uint16_t));
+			NetStats::CountPacket(NetStats::current.packetsSent, type);
+		}
+		if (serverProtocolVersion < 1) {
+			SendNow(buffer, size);
+			return;
+		}
+		if (sendQueue.empty()) {
+			sendQueue.resize(sizeof(uint16_t));
+			memcpy(sendQueue.data(), &PacketTypes::batch, sizeof(uint16_t));
+		}
+		uint16_t size16 = (uint16_t)size;
+		size_t offset = sendQueue.size();
+		sendQueue.resize(offset + sizeof(uint16_t) + size);
+		memcpy(sendQueue.data() + offset, &size16, sizeof(uint16_t));
+		memcpy(sendQueue.data() + offset + sizeof(uint16_t), buffer, size);
+		++sendQueueCount;
+		if (sendQueue.size() >= SEND_QUEUE_FLUSH_SIZE) {
+			FlushSendQueue();
+		}
+	}
+
+	uint32_t GetPingTime() {
+		return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Game_Clock::now().time_since_epoch()).count();
+	}
+
+	void SendPing() {
+		if (serverProtocolVersion < 3)
+			return;
+		auto now = Game_Clock::now();
+		if (now - NetStats::lastPing < std::chrono::seconds(2))
+			return;
+		NetStats::lastPing = now;
+
+		uint32_t time = GetPingTime();
+		memcpy(sendBuffer, &PacketTypes::ping, sizeof(uint16_t));
+		memcpy(sendBuffer + sizeof(uint16_t), &time, sizeof(uint32_t));
+		TrySend(sendBuffer, sizeof(uint16_t) + sizeof(uint32_t));
+	}
+
+	void UpdateRoundTripTime(uint32_t sent) {
+		//unsigned difference, the ms counter may wrap around
+		int rtt = (int)(GetPingTime() - sent);
+		NetStats::rtt = rtt;
+		NetStats::rttAvg = NetStats::rttAvg < 0 ? rtt : (NetStats::rttAvg * 7 + rtt) / 8;
+	}
+
+	std::vector<std::string> GetStatsText() {
+		using namespace NetStats;
+		double secs = std::chrono::duration<double>(lastLength).count();
+		auto rate = [&](int count) {
+			return secs > 0 ? Utils::RoundTo<int>(count / secs) : 0;
+		};
+		auto usecs = [](Game_Clock::duration d) {
+			return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+		};
+
+		int active = (int)std::count_if(players.begin(), players.end(), [](const MPPlayer& p) { return p.active; });
+
+		std::vector<std::string> lines;
+		lines.push_back(std::string(connected ? "Connected" : "Disconnected") + ", schema " + std::to_string(serverProtocolVersion));
+		lines.push_back("RTT: " + (rtt < 0 ? std::string("-") : std::to_string(rtt) + "ms (avg " + std::to_string(rttAvg) + "ms)"));
+		lines.push_back("Out: " + std::to_string(rate(last.messagesSent)) + " msg/s, " + std::to_string(rate(last.bytesSent)) + " B/s, queue max " + std::to_string(last.sendQueueMax) + " B");
+		lines.push_back("In: " + std::to_string(rate(last.messagesReceived)) + " msg/s, " + std::to_string(rate(last.bytesReceived)) + " B/s");
+		lines.push_back("Parse: " + std::to_string(last.frames > 0 ? usecs(last.parseTime) / last.frames : 0) + "us/frame (max " + std::to_string(usecs(last.parseTimeMax)) + "us)");
+		lines.push_back("Players: " + std::to_string(players.size()) + " (" + std::to_string(active) + " active)");
+
+		//packets per second by type as out/in, idle types are left out
+		std::string types;
+		for (int i = 0; i < numTypes; ++i) {
+			if (last.packetsSent[i] == 0 && last.packetsReceived[i] == 0)
+				continue;
+			std::string entry = std::string(typeNames[i]) + " " + std::to_string(rate(last.packetsSent[i])) + "/" + std::to_string(rate(last.packetsReceived[i]));
+			if (!types.empty() && types.size() + entry.size() > 40) {
+				lines.push_back(types);
+				types.clear();
+			}
+			types += (types.empty() ? "" : "  ") + entry;
+		}
+		if (!types.empty())
+			lines.push_back(types);
+		return lines;
+	}
+
+	//called once per frame, before the send queue is flushed
+	void UpdateStats() {
+		using namespace NetStats;
+		current.parseTime += frameParseTime;
+		current.parseTimeMax = std::max(current.parseTimeMax, frameParseTime);
+		current.sendQueueMax = std::max(current.sendQueueMax, (int)sendQueue.size());
+		++current.frames;
+		frameParseTime = {};
+
+		auto now = Game_Clock::now();
+		if (now - windowStart < std::chrono::seconds(1))
+			return;
+		last = current;
+		lastLength = now - windowStart;
+		current = {};
+		windowStart = now;
+
+		if (overlay)
+			overlay->SetText(GetStatsText());
 	}
 
 	void SetConnStatusWindowText(std::string s) {
@@ -168,9 +591,85 @@ namespace {
 		conn_status_window->GetContents()->TextDraw(0, 0, Font::ColorDefault, s);
 	}
 
-	void SpawnOtherPlayer(std::string uid) {
+	void CreatePlayerSprite(MPPlayer& p) {
+		auto scene_map = Scene::Find(Scene::SceneType::Map);
+		if (scene_map == nullptr) {
+			Output::Debug("unexpected");
+			return;
+		}
+		auto old_list = &DrawableMgr::GetLocalList();
+		DrawableMgr::SetLocalList(&scene_map->GetDrawableList());
+		p.sprite = std::make_unique<Sprite_Character>(p.ch.get());
+		DrawableMgr::SetLocalList(old_list);
+	}
+
+	//distance in tiles between the character and the visible screen, 0 when on screen
+	int GetDistanceFromScreen(const Game_Character& ch) {
+		const int view_w = SCREEN_TARGET_WIDTH / TILE_SIZE;
+		const int view_h = SCREEN_TARGET_HEIGHT / TILE_SIZE;
+
+		auto axis = [](int pos, int view_pos, int view_size, int map_size, bool loop) {
+			int d = pos - view_pos;
+			if (loop) {
+				d = Utils::PositiveModulo(d, map_size);
+				return d < view_size ? 0 : std::min(d - (view_size - 1), map_size - d);
+			}
+			if (d < 0)
+				return -d;
+			return std::max(0, d - (view_size - 1));
+		};
+
+		int out_x = axis(ch.GetX(), Game_Map::GetDisplayX() / SCREEN_TILE_SIZE, view_w, Game_Map::GetWidth(), Game_Map::LoopHorizontal());
+		int out_y = axis(ch.GetY(), Game_Map::GetDisplayY() / SCREEN_TILE_SIZE, view_h, Game_Map::GetHeight(), Game_Map::LoopVertical());
+		return std::max(out_x, out_y);
+	}
+
+	//far away players only keep their position, sprite and animation are dropped
+	void ParkPlayer(MPPlayer& p) {
+		p.active = false;
+		p.sprite.reset();
+		p.nickname->SetVisible(false);
+		p.ch->SetRemainingStep(0);
+	}
+
+	void ActivatePlayer(MPPlayer& p) {
+		p.active = true;
+		p.nickname->SetVisible(true);
+		CreatePlayerSprite(p);
+	}
+
+	void UpdateInterest(MPPlayer& p) {
+		int distance = GetDistanceFromScreen(*p.ch);
+		if (p.active && distance > MultiplayerSettings::interestMargin + MultiplayerSettings::interestHysteresis) {
+			ParkPlayer(p);
+		} else if (!p.active && distance <= MultiplayerSettings::interestMargin) {
+			ActivatePlayer(p);
+		}
+	}
+
+	MPPlayer* GetPlayer(int id) {
+		if (id < 0 || id >= (int)playerSlots.size() || playerSlots[id] < 0)
+			return nullptr;
+		return &players[playerSlots[id]];
+	}
+
+	//returns the id of the new player
+	int SpawnOtherPlayer() {
+		int id;
+		if (!freePlayerIds.empty()) {
+			id = freePlayerIds.back();
+			freePlayerIds.pop_back();
+		} else {
+			id = (int)playerSlots.size();
+			playerSlots.push_back(-1);
+		}
+		playerSlots[id] = (int)players.size();
+		players.emplace_back();
+		auto& p = players.back();
+		p.id = id;
+
 		auto& player = Main_Data::game_player;
-		auto& nplayer = players[uid].ch;
+		auto& nplayer = p.ch;
 		nplayer = std::make_shared<Game_PlayerOther>();
 		nplayer->SetX(player->GetX());
 		nplayer->SetY(player->GetY());
@@ -179,22 +678,26 @@ namespace {
 		nplayer->SetMoveFrequency(player->GetMoveFrequency());
 		nplayer->SetThrough(true);
 		nplayer->SetLayer(player->GetLayer());
-		//to-do: call operator[] once and save reference to use
-		players[uid].nickname = std::make_unique<MultiplayerText>();
-		players[uid].nickname->SetAnchorCharacter(nplayer);
-		players[uid].nickname->SetMaxWidth(TILE_SIZE * 2.2);
-		players[uid].nickname->SetText("Madosussy");
+		p.nickname = std::make_unique<MultiplayerText>();
+		p.nickname->SetAnchorCharacter(nplayer);
+		p.nickname->SetMaxWidth(TILE_SIZE * 2.2);
+		p.nickname->SetText("Madosussy");
 
-		auto scene_map = Scene::Find(Scene::SceneType::Map);
-		if (scene_map == nullptr) {
-			Output::Debug("unexpected");
-			return;
-		}
-		auto old_list = &DrawableMgr::GetLocalList();
-		DrawableMgr::SetLocalList(&scene_map->GetDrawableList());
-		players[uid].sprite = std::make_unique<Sprite_Character>(nplayer.get());
-		DrawableMgr::SetLocalList(old_list);
+		CreatePlayerSprite(p);
+		return id;
 	}
+	//steps of the main player not sent yet, consecutive steps in one direction are one run
+	struct MovementRun {
+		uint8_t dir;
+		uint8_t steps;
+	};
+	std::vector<MovementRun> pendingMovement;
+	//position the server was told about, including sent deltas
+	int sentX = 0;
+	int sentY = 0;
+	int lastMovementSend = 0;
+	int lastMovementKeyframe = 0;
+
 	void SendMainPlayerPos() {
 		auto& player = Main_Data::game_player;
 		uint16_t cmsg[3] = {
@@ -203,6 +706,65 @@ namespace {
 			(uint16_t)player->GetY()
 		};
 		TrySend((void*)cmsg, sizeof(uint16_t) * 3);
+
+		pendingMovement.clear();
+		sentX = player->GetX();
+		sentY = player->GetY();
+		lastMovementSend = Player::GetFrames();
+		lastMovementKeyframe = lastMovementSend;
+	}
+
+	void QueueMainPlayerStep(int dir) {
+		if (!pendingMovement.empty() && pendingMovement.back().dir == dir && pendingMovement.back().steps < UINT8_MAX) {
+			++pendingMovement.back().steps;
+		} else {
+			pendingMovement.push_back({ (uint8_t)dir, 1 });
+		}
+	}
+
+	//sends the pending steps, at most once per movementSendInterval
+	void FlushMainPlayerMovement() {
+		if (!connected)
+			return;
+		auto& player = Main_Data::game_player;
+		const int now = Player::GetFrames();
+		if (now - lastMovementSend < MultiplayerSettings::movementSendInterval)
+			return;
+
+		int x = sentX;
+		int y = sentY;
+		for (auto& run : pendingMovement) {
+			x = Game_Map::RoundX(x + Game_Character::GetDxFromDirection(run.dir) * run.steps);
+			y = Game_Map::RoundY(y + Game_Character::GetDyFromDirection(run.dir) * run.steps);
+		}
+
+		//teleports and blocked steps do not match the deltas
+		bool desync = x != player->GetX() || y != player->GetY();
+		if (pendingMovement.empty() && !desync)
+			return;
+
+		if (desync || now - lastMovementKeyframe >= MultiplayerSettings::movementKeyframeInterval) {
+			SendMainPlayerPos();
+			return;
+		}
+
+		size_t s = sizeof(uint16_t) + pendingMovement.size() * 2;
+		if (s > SEND_BUFFER_SIZE) {
+			SendMainPlayerPos();
+			return;
+		}
+		memcpy(sendBuffer, &PacketTypes::movementDelta, sizeof(uint16_t));
+		char* out = sendBuffer + sizeof(uint16_t);
+		for (auto& run : pendingMovement) {
+			*out++ = (char)run.dir;
+			*out++ = (char)run.steps;
+		}
+		TrySend(sendBuffer, s);
+
+		pendingMovement.clear();
+		sentX = x;
+		sentY = y;
+		lastMovementSend = now;
 	}
 	
 	
@@ -236,7 +798,8 @@ namespace {
 	}
 
 	//this assumes that the player is stopped
-	void MovePlayerToPos(std::shared_ptr<Game_PlayerOther> &player, int x, int y) {
+	//returns the direction of the step or -1 when the player was placed directly
+	int MovePlayerToPos(std::shared_ptr<Game_PlayerOther> &player, int x, int y) {
 		if (!player->IsStopping()) {
 			Output::Debug("MovePlayerToPos unexpected error: the player is busy being animated");
 		}
@@ -245,19 +808,112 @@ namespace {
 		if (abs(dx) > 1 || abs(dy) > 1 || dx == 0 && dy == 0) {
 			player->SetX(x);
 			player->SetY(y);
-			return;
+			return -1;
 		}
 		int dir[3][3] = {{Game_Character::Direction::UpLeft, Game_Character::Direction::Up, Game_Character::Direction::UpRight},
 						 {Game_Character::Direction::Left, 0, Game_Character::Direction::Right},
 						 {Game_Character::Direction::DownLeft, Game_Character::Direction::Down, Game_Character::Direction::DownRight}};
 		player->Move(dir[dy+1][dx+1]);
+		return dir[dy+1][dx+1];
+	}
+
+	//frames one step takes at the given move speed
+	int FramesPerStep(int speed) {
+		return SCREEN_TILE_SIZE >> (1 + Utils::Clamp(speed, 1, 6));
+	}
+
+	void PushSnapshot(MPPlayer& p, int x, int y) {
+		int now = Player::GetFrames();
+		MPSnapshot snap;
+		snap.x = x;
+		snap.y = y;
+		//positions arriving in a burst are spread out to walking pace
+		snap.frame = now;
+		if (!p.mvq.empty()) {
+			snap.frame = std::max(now, p.mvq.back().frame + FramesPerStep(p.moveSpeed));
+		}
+		if (p.last.frame > 0) {
+			int arrival = Utils::Clamp(snap.frame - p.last.frame, 1, 60);
+			p.interval = (p.interval * 3 + arrival) / 4;
+		}
+		p.last = snap;
+		p.mvq.push_back(snap);
+	}
+
+	//plays back received positions with a delay and predicts late steps
+	void UpdateMovement(MPPlayer& p) {
+		auto& q = p.mvq;
+		if (!p.ch->IsStopping())
+			return;
+
+		const int now = Player::GetFrames();
+		const int playback = now - MultiplayerSettings::interpolationDelay;
+
+		while (q.size() > 16)
+			q.pop_front();
+
+		if (!q.empty() && q.front().frame <= playback) {
+			MPSnapshot snap = q.front();
+			q.pop_front();
+
+			//walk faster when the next position is due before this step would end
+			int speed = p.moveSpeed;
+			if (q.size() > 8) {
+				speed = 6;
+			} else if (!q.empty()) {
+				int budget = q.front().frame - playback;
+				while (speed < 6 && FramesPerStep(speed) > budget)
+					++speed;
+			}
+			p.ch->SetMoveSpeed(speed);
+
+			if (p.extrapolatedSteps > 0 && p.ch->GetX() == snap.x && p.ch->GetY() == snap.y) {
+				//the prediction was right, nothing to correct
+				p.extrapolatedSteps = 0;
+				return;
+			}
+
+			int dir = MovePlayerToPos(p.ch, snap.x, snap.y);
+			p.straightSteps = (dir >= 0 && dir == p.lastDir) ? p.straightSteps + 1 : 1;
+			p.lastDir = dir;
+			p.extrapolatedSteps = 0;
+			return;
+		}
+
+		if (!q.empty())
+			return;
+
+		int overdue = playback - (p.last.frame + p.interval);
+		if (overdue <= 0)
+			return;
+
+		if (p.lastDir >= 0 && p.straightSteps > 1 && p.extrapolatedSteps < MultiplayerSettings::maxExtrapolationSteps) {
+			//dead reckoning: the player was walking straight, keep going in the same direction
+			p.ch->SetMoveSpeed(p.moveSpeed);
+			p.ch->Move(p.lastDir);
+			++p.extrapolatedSteps;
+		} else if (p.extrapolatedSteps > 0 && overdue > p.interval * 2) {
+			//no new position arrived, the player stopped: undo the prediction
+			MovePlayerToPos(p.ch, p.last.x, p.last.y);
+			p.extrapolatedSteps = 0;
+			p.lastDir = -1;
+		}
+	}
+
+	std::string GetGameName() {
+	#ifdef EMSCRIPTEN
+		return Player::emscripten_game_name;
+	#else
+		return MultiplayerSettings::game_name;
+	#endif
 	}
 
 	extern "C" {
 	void SlashCommandSetSprite(const char* sheet, int id);
 	}
-	EM_BOOL onopen(int eventType, const EmscriptenWebSocketOpenEvent *websocketEvent, void *userData) {
+	void onopen() {
 		std::string msg = "Connected to room " + std::to_string(room_id);
+	#ifdef EMSCRIPTEN
 		std::string source = "Client";
 		EM_ASM({
 			PrintChatInfo(UTF8ToString($0), UTF8ToString($1));
@@ -270,73 +926,257 @@ namespace {
 		EM_ASM({
 			SetRoomID($0)
 		}, room_id);
+	#else
+		Output::Debug("Multiplayer: {}", msg);
+	#endif
 		SetConnStatusWindowText("Connected");
 		//puts("onopen");
 		connected = true;
 		auto& player = Main_Data::game_player;
-		TrySend(Player::emscripten_game_name + "game");
+		sendQueue.clear();
+		sendQueueCount = 0;
+		SendNow(GetGameName() + "game");
 		uint16_t room_id16[] = {(uint16_t)room_id};
-		TrySend((void*)room_id16, sizeof(uint16_t));
+		SendNow((void*)room_id16, sizeof(uint16_t));
+		//servers that don't know the packet ignore it and keep sending JSON
+		serverProtocolVersion = 0;
+		NetStats::rtt = -1;
+		NetStats::rttAvg = -1;
+		uint16_t protocol[2] = {PacketTypes::protocol, protocolVersion};
+		SendNow(protocol, sizeof(protocol));
 		SendMainPlayerPos();
 		if(MultiplayerSettings::spritesheet != "")
 			SlashCommandSetSprite(MultiplayerSettings::spritesheet.c_str(), MultiplayerSettings::spriteid);
 		SendMainPlayerSprite(player->GetSpriteName(), player->GetSpriteIndex());
 		SendMainPlayerName();
 		SendMainPlayerMoveSpeed((int)(MultiplayerSettings::mAnimSpeed));
-		return EM_TRUE;
 	}
-	EM_BOOL onclose(int eventType, const EmscriptenWebSocketCloseEvent *websocketEvent, void *userData) {
+	void onclose() {
 		SetConnStatusWindowText("Disconnected");
 		//puts("onclose");
 		connected = false;
+	}
+
+	int GetOrSpawnPlayerId(const std::string& uid) {
+		auto it = playerIds.find(uid);
+		if (it == playerIds.end()) {
+			it = playerIds.emplace(uid, SpawnOtherPlayer()).first;
+		}
+		return it->second;
+	}
+
+	MPPlayer& GetOrSpawnPlayer(const std::string& uid) {
+		return *GetPlayer(GetOrSpawnPlayerId(uid));
+	}
+
+	void DisconnectPlayer(const std::string& uid) {
+		auto it = playerIds.find(uid);
+		if (it == playerIds.end())
+			return;
+		int id = it->second;
+		playerIds.erase(it);
+
+		auto scene_map = Scene::Find(Scene::SceneType::Map);
+		auto old_list = &DrawableMgr::GetLocalList();
+		DrawableMgr::SetLocalList(&scene_map->GetDrawableList());
+		int index = playerSlots[id];
+		players[index].nickname->RemoveAnchorCharacter();
+		//the last player takes the free place, only its slot changes
+		if (index != (int)players.size() - 1) {
+			players[index] = std::move(players.back());
+			playerSlots[players[index].id] = index;
+		}
+		players.pop_back();
+		DrawableMgr::SetLocalList(old_list);
+
+		playerSlots[id] = -1;
+		freePlayerIds.push_back(id);
+	}
+
+	void PlayPlayerSound(MPPlayer& p, int volume, int tempo, int balance, std::string name) {
+		lcf::rpg::Sound soundStruct;
+		int dx = p.ch->GetX() - Main_Data::game_player->GetX();
+		int dy = p.ch->GetY() - Main_Data::game_player->GetY();
+		int distance = std::sqrt(dx * dx + dy * dy);
+		soundStruct.volume = std::max(0, 
+		(int)
+		((100.0f - ((float)distance) * 10.0f) * (float(MultiplayerSettings::playersVolume) / 100.0f) * (float(volume) / 100.0f))
+		);
+		soundStruct.tempo = tempo;
+		soundStruct.balance = balance;
+		soundStruct.name = std::move(name);
+
+		Main_Data::game_system->SePlay(soundStruct);
+	}
 
-		return EM_TRUE;
+	void ApplySwitchSync(int id, int value) {
+		if(!MultiplayerSettings::switchsync)
+			return;
+		if(MultiplayerSettings::syncedswitches.find(id) != MultiplayerSettings::syncedswitches.cend()) {
+			Main_Data::game_switches->Set(id, value);
+			Game_Map::SetNeedRefresh(true);
+		}
+		std::string setswtstr = std::to_string(id) + " " + std::to_string(value);
+	#ifdef EMSCRIPTEN
+		EM_ASM({
+			console.log("switch " + UTF8ToString($0));
+		}, setswtstr.c_str());
+	#else
+		Output::Debug("switch {}", setswtstr);
+	#endif
 	}
 
 	void ResolveObjectSyncPacket(const nx_json* json);
+	void ResolveBinaryMessage(const char* data, size_t size);
+
+	void ResolveTextMessage(char* data, size_t size);
+
+	void onmessage(char* data, size_t size, bool is_text) {
+		auto start = Game_Clock::now();
+		++NetStats::current.messagesReceived;
+		NetStats::current.bytesReceived += size;
+		if(!is_text) {
+			ResolveBinaryMessage(data, size);
+		} else {
+			NetStats::CountPacket(NetStats::current.packetsReceived, 0);
+			ResolveTextMessage(data, size);
+		}
+		NetStats::frameParseTime += Game_Clock::now() - start;
+	}
 
-	EM_BOOL onmessage(int eventType, const EmscriptenWebSocketMessageEvent *websocketEvent, void *userData) {
-		if(websocketEvent->isText) {
-			
-			strcpy(receiveBuffer, (char*)websocketEvent->data);
+	void ResolveTextMessage(char* data, size_t size) {
+
+		//JSON fallback for servers that did not accept the binary protocol
+		//the transport null terminates text, so it is parsed in place without a copy
+		const nx_json* json = nx_json_parse(data, NULL);
+		if(json) {
+			const nx_json* typeNode = nx_json_get(json, "type");
 			
-			const nx_json* json = nx_json_parse(receiveBuffer, NULL);
-			if(json) {
-				const nx_json* typeNode = nx_json_get(json, "type");
-				
-				if(typeNode->type == nx_json_type::NX_JSON_STRING) {
-					/*if(strcmp(typeNode->text_value, "fyllSync") == 0) {
-						const nx_json* syncarray = nx_json_get(json, "data");
-						if(syncarray->type == nx_json_type::NX_JSON_ARRAY) {
-							for(int i = 0; i < syncarray->children.length; i++) {
-								ResolveObjectSyncPacket(nx_json_item(syncarray, i));
-							}
+			if(typeNode->type == nx_json_type::NX_JSON_STRING) {
+				//room join snapshot, not limited in size anymore
+				if(strcmp(typeNode->text_value, "fyllSync") == 0) {
+					const nx_json* syncarray = nx_json_get(json, "data");
+					if(syncarray->type == nx_json_type::NX_JSON_ARRAY) {
+						for(const nx_json* item = syncarray->children.first; item; item = item->next) {
+							ResolveObjectSyncPacket(item);
 						}
-					}*/
-
-					if(strcmp(typeNode->text_value, "objectSync") == 0) {
-						ResolveObjectSyncPacket(json);
 					}
-					else
-					if(strcmp(typeNode->text_value, "disconnect") == 0) {
-						auto scene_map = Scene::Find(Scene::SceneType::Map);
-						const nx_json* uid = nx_json_get(json, "uuid");
-						auto old_list = &DrawableMgr::GetLocalList();
-						DrawableMgr::SetLocalList(&scene_map->GetDrawableList());
-						players[uid->text_value].nickname->RemoveAnchorCharacter();
-						players.erase(uid->text_value);
-						DrawableMgr::SetLocalList(old_list);
+				}
+				else
+				if(strcmp(typeNode->text_value, "objectSync") == 0) {
+					ResolveObjectSyncPacket(json);
+				}
+				else
+				if(strcmp(typeNode->text_value, "disconnect") == 0) {
+					const nx_json* uid = nx_json_get(json, "uuid");
+					if(uid->type == nx_json_type::NX_JSON_STRING) {
+						DisconnectPlayer(uid->text_value);
 					}
 				}
-				
 			}
 			
-			nx_json_free(json);
-			
 		}
-		return EM_TRUE;
+		
+		nx_json_free(json);
 	}
 
+	void ResolveBinaryMessage(const char* data, size_t size) {
+		MultiplayerPacketReader msg(data, size);
+		uint16_t version = msg.ReadU16();
+		if(msg.Failed() || version == 0) {
+			Output::Debug("Multiplayer: invalid binary message ({} bytes)", size);
+			return;
+		}
+		serverProtocolVersion = version;
+
+		//records after a uid record apply to that player
+		//the id is looked up again per record, spawning and leaving players move the others
+		int playerId = -1;
+		while(msg.Remaining() > 0) {
+			uint16_t type;
+			auto rec = msg.ReadRecord(type);
+			if(msg.Failed()) {
+				Output::Debug("Multiplayer: truncated binary message ({} bytes)", size);
+				return;
+			}
+			NetStats::CountPacket(NetStats::current.packetsReceived, type);
+
+			MPPlayer* player = GetPlayer(playerId);
+			if(type == PacketTypes::uid) {
+				playerId = GetOrSpawnPlayerId(ToString(rec.ReadRest()));
+			}
+			else if(type == PacketTypes::disconnect) {
+				DisconnectPlayer(ToString(rec.ReadRest()));
+				playerId = -1;
+			}
+			else if(type == PacketTypes::weather) {
+				int weatherType = rec.ReadU16();
+				int strength = rec.ReadU16();
+				if(!rec.Failed())
+					Main_Data::game_screen->SetWeatherEffect(weatherType, strength);
+			}
+			else if(type == PacketTypes::switchsync) {
+				int id = rec.ReadI32();
+				int value = rec.ReadI32();
+				if(!rec.Failed())
+					ApplySwitchSync(id, value);
+			}
+			else if(type == PacketTypes::ping) {
+				uint32_t sent = (uint32_t)rec.ReadI32();
+				if(!rec.Failed())
+					UpdateRoundTripTime(sent);
+			}
+			else if(player == nullptr) {
+				continue;
+			}
+			else if(type == PacketTypes::movement) {
+				int x = rec.ReadU16();
+				int y = rec.ReadU16();
+				if(!rec.Failed())
+					PushSnapshot(*player, x, y);
+			}
+			else if(type == PacketTypes::movementDelta) {
+				//deltas continue from the newest received position
+				int x = player->last.frame > 0 ? player->last.x : player->ch->GetX();
+				int y = player->last.frame > 0 ? player->last.y : player->ch->GetY();
+				while(rec.Remaining() >= 2) {
+					int dir = rec.ReadU8();
+					int steps = rec.ReadU8();
+					if(dir > Game_Character::Direction::UpLeft)
+						break;
+					for(int i = 0; i < steps; ++i) {
+						x = Game_Map::RoundX(x + Game_Character::GetDxFromDirection(dir));
+						y = Game_Map::RoundY(y + Game_Character::GetDyFromDirection(dir));
+						PushSnapshot(*player, x, y);
+					}
+				}
+			}
+			else if(type == PacketTypes::sprite) {
+				int id = rec.ReadU16();
+				auto sheet = rec.ReadRest();
+				if(!rec.Failed())
+					player->ch->SetSpriteGraphic(ToString(sheet), id);
+			}
+			else if(type == PacketTypes::sound) {
+				int volume = rec.ReadU16();
+				int tempo = rec.ReadU16();
+				int balance = rec.ReadU16();
+				auto name = rec.ReadRest();
+				if(!rec.Failed())
+					PlayPlayerSound(*player, volume, tempo, balance, ToString(name));
+			}
+			else if(type == PacketTypes::name) {
+				player->nickname->SetText(ToString(rec.ReadRest()));
+			}
+			else if(type == PacketTypes::movementAnimationSpeed) {
+				int speed = rec.ReadU16();
+				if(!rec.Failed())
+					player->moveSpeed = speed;
+			}
+			//variable sync is disabled, see Game_Multiplayer::VariableSync
+			//unknown records come from newer schema versions and are skipped
+		}
+	}
 
 	void ResolveObjectSyncPacket(const nx_json* json) {
 		if(json->type == nx_json_type::NX_JSON_OBJECT) {
@@ -352,21 +1192,16 @@ namespace {
 			const nx_json* switchsync = nx_json_get(json, "switchsync");
 			
 			if(uid->type == nx_json_type::NX_JSON_STRING) {
-				std::string uids = std::string(uid->text_value);
-				auto player = players.find(uids);
-				if(player == players.cend()) {
-					SpawnOtherPlayer(std::string(uid->text_value));
-				}
-					
+				auto& player = GetOrSpawnPlayer(uid->text_value);
 
 				if(pos->type == nx_json_type::NX_JSON_OBJECT) {
-					players[uids].mvq.push(std::make_pair(nx_json_get(pos, "x")->num.u_value, nx_json_get(pos, "y")->num.u_value));
+					PushSnapshot(player, nx_json_get(pos, "x")->num.u_value, nx_json_get(pos, "y")->num.u_value);
 				}
 				else if(path->type == nx_json_type::NX_JSON_ARRAY) {
 					for(int i = 0; i < path->children.length; i++) {
 						pos = nx_json_item(path, i);
 						if(pos->type == nx_json_type::NX_JSON_OBJECT) {
-							players[uids].mvq.push(std::make_pair(nx_json_get(pos, "x")->num.u_value, nx_json_get(pos, "y")->num.u_value));
+							PushSnapshot(player, nx_json_get(pos, "x")->num.u_value, nx_json_get(pos, "y")->num.u_value);
 						}
 					}
 				}
@@ -374,7 +1209,7 @@ namespace {
 				if(sprite->type == nx_json_type::NX_JSON_OBJECT) {
 					const nx_json* sheet = nx_json_get(sprite, "sheet");
 					const nx_json* id = nx_json_get(sprite, "id");
-					players[uids].ch->SetSpriteGraphic(std::string(sheet->text_value), id->num.u_value);
+					player.ch->SetSpriteGraphic(std::string(sheet->text_value), id->num.u_value);
 				}
 
 				if(sound->type == nx_json_type::NX_JSON_OBJECT) {
@@ -383,24 +1218,11 @@ namespace {
 					const nx_json* balance = nx_json_get(sound, "balance");
 					const nx_json* name = nx_json_get(sound, "name");
 
-					lcf::rpg::Sound soundStruct;
-					auto& p = players[uids];
-					int dx = p.ch->GetX() - Main_Data::game_player->GetX();
-					int dy = p.ch->GetY() - Main_Data::game_player->GetY();
-					int distance = std::sqrt(dx * dx + dy * dy);
-					soundStruct.volume = std::max(0, 
-					(int)
-					((100.0f - ((float)distance) * 10.0f) * (float(MultiplayerSettings::playersVolume) / 100.0f) * (float(volume->num.u_value) / 100.0f))
-					);
-					soundStruct.tempo = tempo->num.u_value;
-					soundStruct.balance = balance->num.u_value;
-					soundStruct.name = std::string(name->text_value);
-
-					Main_Data::game_system->SePlay(soundStruct);
+					PlayPlayerSound(player, volume->num.u_value, tempo->num.u_value, balance->num.u_value, name->text_value);
 				}
 
 				if(name->type == nx_json_type::NX_JSON_STRING) {
-					players[uids].nickname->SetText(name->text_value);
+					player.nickname->SetText(name->text_value);
 				}
 
 				if(weather->type == nx_json_type::NX_JSON_OBJECT) {
@@ -410,7 +1232,7 @@ namespace {
 				}
 
 				if(mAnimSpd->type == nx_json_type::NX_JSON_INTEGER) {
-					players[uids].moveSpeed = mAnimSpd->num.u_value;
+					player.moveSpeed = mAnimSpd->num.u_value;
 				}
 
 				if(variable->type == nx_json_type::NX_JSON_OBJECT && false) {
@@ -420,23 +1242,18 @@ namespace {
 					Game_Map::SetNeedRefresh(true);
 					
 					std::string setvarstr = std::to_string(id->num.u_value) + " " + std::to_string(value->num.s_value);
+				#ifdef EMSCRIPTEN
 					std::string varstr = "var";
 					EM_ASM({
 						PrintChatInfo(UTF8ToString($0), UTF8ToString($1));
 					}, setvarstr.c_str(), varstr.c_str());
+				#endif
 				}
 
-				if(switchsync->type == nx_json_type::NX_JSON_OBJECT && MultiplayerSettings::switchsync) {
+				if(switchsync->type == nx_json_type::NX_JSON_OBJECT) {
 					const nx_json* id = nx_json_get(switchsync, "id");
 					const nx_json* value = nx_json_get(switchsync, "value");
-					if(MultiplayerSettings::syncedswitches.find(id->num.u_value) != MultiplayerSettings::syncedswitches.cend()) {
-						Main_Data::game_switches->Set(id->num.u_value, value->num.s_value);
-						Game_Map::SetNeedRefresh(true);
-					}
-					std::string setswtstr = std::to_string(id->num.u_value) + " " + std::to_string(value->num.s_value);
-					EM_ASM({
-						console.log("switch " + UTF8ToString($0));
-					}, setswtstr.c_str());
+					ApplySwitchSync(id->num.u_value, value->num.s_value);
 				}
 			}
 		}
@@ -465,9 +1282,11 @@ void loadProfileSavedPreferences(const char* name, const char* trip) {
 }
 
 void SendChatMessage(const char* msg) {
+#ifdef EMSCRIPTEN
 	EM_ASM({
 		SendMessageString(UTF8ToString($0));
 	}, msg);
+#endif
 }
 
 void ChangeName(const char* name) {
@@ -486,6 +1305,24 @@ void SetPlayersVolume(int volume) {
 	MultiplayerSettings::playersVolume = volume;
 }
 
+//frames remote players are shown behind, higher values hide more network jitter
+void SetInterpolationDelay(int frames) {
+	MultiplayerSettings::interpolationDelay = Utils::Clamp(frames, 0, 60);
+}
+
+void SetMaxExtrapolationSteps(int steps) {
+	MultiplayerSettings::maxExtrapolationSteps = Utils::Clamp(steps, 0, 8);
+}
+
+//minimum frames between two movement packets, 1 sends every step
+void SetMovementSendInterval(int frames) {
+	MultiplayerSettings::movementSendInterval = Utils::Clamp(frames, 1, 60);
+}
+
+void SetMovementKeyframeInterval(int frames) {
+	MultiplayerSettings::movementKeyframeInterval = Utils::Clamp(frames, 1, 3600);
+}
+
 void SetWSHost(const char* host) {
 	server_url = host;
 }
@@ -508,7 +1345,11 @@ void LogSwitchSyncWhiteList() {
 		liststr += std::to_string(swt) + ",";
 	}
 
+#ifdef EMSCRIPTEN
 	EM_ASM({console.log(UTF8ToString($0));}, liststr.c_str());
+#else
+	Output::Debug("{}", liststr);
+#endif
 }
 }
 void Game_Multiplayer::Connect(int map_id) {
@@ -537,31 +1378,67 @@ void Game_Multiplayer::Connect(int map_id) {
 		Chat_Multiplayer::tryCreateChatWindow();
 	#endif
 
+	if (server_url.empty()) {
+		return;
+	}
+
 	std::string room_url = server_url + std::to_string(map_id);
 	Output::Debug(room_url);
-	EmscriptenWebSocketCreateAttributes ws_attrs = {
-		server_url.c_str(),
-		"binary",
-		EM_TRUE
-	};
 
-	socket = emscripten_websocket_new(&ws_attrs);
-	emscripten_websocket_set_onopen_callback(socket, NULL, onopen);
-	//emscripten_websocket_set_onerror_callback(socket, NULL, onerror);
-	emscripten_websocket_set_onclose_callback(socket, NULL, onclose);
-	emscripten_websocket_set_onmessage_callback(socket, NULL, onmessage);
+	if (!transport) {
+		transport = MultiplayerTransport::Create();
+		if (!transport) {
+			Output::Debug("Multiplayer: No network support on this platform");
+			return;
+		}
+		transport->SetOnOpen(onopen);
+		transport->SetOnClose(onclose);
+		transport->SetOnMessage(onmessage);
+	}
+	transport->Open(server_url);
 }
 
 void Game_Multiplayer::Quit() {
-	emscripten_websocket_deinitialize(); //kills every socket for this thread
+	if (transport) {
+		transport->Close();
+	}
+	connected = false;
+	sendQueue.clear();
+	sendQueueCount = 0;
+	pendingMovement.clear();
 	for(auto& p : players) {
-		p.second.nickname->RemoveAnchorCharacter();
+		p.nickname->RemoveAnchorCharacter();
 	}
 	players.clear();
+	playerSlots.clear();
+	freePlayerIds.clear();
+	playerIds.clear();
+}
+
+void Game_Multiplayer::Poll() {
+	if (transport) {
+		transport->Poll();
+	}
+}
+
+void Game_Multiplayer::Flush() {
+	FlushMainPlayerMovement();
+	SendPing();
+	UpdateStats();
+	FlushSendQueue();
+}
+
+void Game_Multiplayer::SetServer(std::string url, std::string game_name) {
+	server_url = std::move(url);
+	MultiplayerSettings::game_name = std::move(game_name);
 }
 
 void Game_Multiplayer::MainPlayerMoved(int dir) {
-	SendMainPlayerPos();
+	if (serverProtocolVersion < 2) {
+		SendMainPlayerPos();
+		return;
+	}
+	QueueMainPlayerStep(dir);
 }
 
 void Game_Multiplayer::MainPlayerChangedMoveSpeed(int spd) {
@@ -618,24 +1495,42 @@ void Game_Multiplayer::Update() {
 	}
 
 	for (auto& p : players) {
-		auto& q = p.second.mvq;
-		if (!q.empty() && p.second.ch->IsStopping()) {
-			MovePlayerToPos(p.second.ch, q.front().first, q.front().second);
-			if(q.size() > 8) {
-				p.second.ch->SetMoveSpeed(6);
-				while(q.size() > 16)
-						q.pop();
-			} else {
-				p.second.ch->SetMoveSpeed(p.second.moveSpeed);
+		auto& q = p.mvq;
+		UpdateInterest(p);
+		if (!p.active) {
+			//nobody sees the walk, jump to the newest position
+			if (!q.empty()) {
+				p.ch->SetX(q.back().x);
+				p.ch->SetY(q.back().y);
+				q.clear();
 			}
-			q.pop();
+			p.lastDir = -1;
+			p.extrapolatedSteps = 0;
+			continue;
 		}
-		p.second.ch->SetProcessed(false);
-		p.second.ch->Update();
-		p.second.sprite->Update();
+		UpdateMovement(p);
+		p.ch->SetProcessed(false);
+		p.ch->Update();
+		if (p.sprite)
+			p.sprite->Update();
 	}
 	if (Input::IsReleased(Input::InputButton::N3)) {
 		conn_status_window->SetVisible(!conn_status_window->IsVisible());
 	}
+	if (Input::IsReleased(Input::InputButton::N4)) {
+		if (NetStats::overlay) {
+			NetStats::overlay.reset();
+		} else {
+			NetStats::overlay = std::make_unique<MultiplayerStatsOverlay>();
+			NetStats::overlay->SetText(GetStatsText());
+		}
+		DumpStats();
+	}
+}
+
+void Game_Multiplayer::DumpStats() {
+	for (auto& line : GetStatsText()) {
+		Output::Info("Multiplayer: {}", line);
+	}
 }
 
@@ -8,6 +8,14 @@ namespace Game_Multiplayer {
 	void Connect(int map_id);
 	void Quit();
 	void Update();
+	/** Services the network connection, called once per frame from Player::MainLoop */
+	void Poll();
+	/** Sends all packets queued during this frame as one message, called at frame end */
+	void Flush();
+	/** Sets server url and game name, the web player gets these from the page */
+	void SetServer(std::string url, std::string game_name);
+	/** Writes the network statistics shown by the stats overlay (N4) to the log */
+	void DumpStats();
 	void MainPlayerMoved(int dir);
 	void MainPlayerChangedMoveSpeed(int spd);
 	void MainPlayerChangedSpriteGraphic(std::string name, int index);
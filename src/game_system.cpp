@@ -182,6 +182,18 @@ void Game_System::SePlay(const lcf::rpg::Animation &animation) {
 	}
 }
 
+void Game_System::SePreload(const std::string& name, int tempo) {
+	if (name.empty() || name == "(OFF)" || StringView(name).ends_with(".script")) {
+		return;
+	}
+
+	tempo = Utils::Clamp<int32_t>(tempo, 50, 200);
+
+	FileRequestAsync* request = AsyncHandler::RequestFile("Sound", name);
+	se_preload_request_ids[{ name, tempo }] = request->Bind(&Game_System::OnSePreloadReady, this, tempo);
+	request->Start();
+}
+
 StringView Game_System::GetSystemName() {
 	return !data.graphics_name.empty() ?
 		StringView(data.graphics_name) : StringView(lcf::Data::system.system_name);
@@ -567,6 +579,17 @@ void Game_System::OnSeReady(FileRequestResult* result, lcf::rpg::Sound se, bool
 	Audio().SE_Play(std::move(stream), se.volume, se.tempo);
 }
 
+void Game_System::OnSePreloadReady(FileRequestResult* result, int tempo) {
+	se_preload_request_ids.erase({ result->file, tempo });
+
+	Filesystem_Stream::InputStream stream;
+	if (IsStopSoundFilename(result->file, stream) || !stream) {
+		return;
+	}
+
+	Audio().SE_Preload(std::move(stream), tempo);
+}
+
 bool Game_System::IsMessageTransparent() {
 	if (Player::IsRPG2k() && Game_Battle::IsBattleRunning()) {
 		return false;
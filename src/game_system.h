@@ -146,6 +146,14 @@ public:
 	 */
 	void SePlay(const lcf::rpg::Animation& animation);
 
+	/**
+	 * Decodes a sound in advance so playing it later does not stall.
+	 *
+	 * @param name sound file.
+	 * @param tempo pitch the sound will be played with.
+	 */
+	void SePreload(const std::string& name, int tempo);
+
 	/** @return system graphic filename.  */
 	StringView GetSystemName();
 
@@ -489,6 +497,7 @@ private:
 	void OnBgmReady(FileRequestResult* result);
 	void OnBgmInelukiReady(FileRequestResult* result);
 	void OnSeReady(FileRequestResult* result, lcf::rpg::Sound se, bool stop_sounds);
+	void OnSePreloadReady(FileRequestResult* result, int tempo);
 	void OnChangeSystemGraphicReady(FileRequestResult* result);
 private:
 	lcf::rpg::SaveSystem data;
@@ -496,6 +505,7 @@ private:
 	FileRequestBinding music_request_id;
 	FileRequestBinding system_request_id;
 	std::map<std::string, FileRequestBinding> se_request_ids;
+	std::map<std::pair<std::string, int>, FileRequestBinding> se_preload_request_ids;
 	Color bg_color = Color{ 0, 0, 0, 255 };
 	bool bgm_pending = false;
 };
@@ -25,23 +25,35 @@
 #include "player.h"
 #include "fps_overlay.h"
 #include "message_overlay.h"
+#include "profiler_overlay.h"
 #include "transition.h"
 #include "scene.h"
 #include "drawable_mgr.h"
 #include "baseui.h"
 #include "game_clock.h"
+#include "damage_region.h"
+#include "draw_workers.h"
+#include "main_data.h"
+#include "game_system.h"
 
 using namespace std::chrono_literals;
 
 namespace Graphics {
 	void UpdateTitle();
+	void DrawBands(Bitmap& dst, const std::vector<Rect>& areas);
 
 	std::shared_ptr<Scene> current_scene;
 
 	std::unique_ptr<MessageOverlay> message_overlay;
 	std::unique_ptr<FpsOverlay> fps_overlay;
+	std::unique_ptr<ProfilerOverlay> profiler_overlay;
 
 	std::string window_title_key;
+
+	DamageRegion damage;
+	bool force_redraw = true;
+	const Bitmap* last_surface = nullptr;
+	Color last_background;
 }
 
 void Graphics::Init() {
@@ -53,9 +65,12 @@ void Graphics::Init() {
 }
 
 void Graphics::Quit() {
+	profiler_overlay.reset();
 	fps_overlay.reset();
 	message_overlay.reset();
 
+	DrawWorkers::Quit();
+
 	Cache::Clear();
 
 	Scene::PopUntil(Scene::Null);
@@ -71,6 +86,14 @@ void Graphics::Update() {
 		UpdateTitle();
 	}
 	message_overlay->Update();
+
+	if (Player::show_profiler_flag) {
+		// Created here because the command line is parsed after Init()
+		if (!profiler_overlay) {
+			profiler_overlay = std::make_unique<ProfilerOverlay>();
+		}
+		profiler_overlay->Update();
+	}
 }
 
 void Graphics::UpdateTitle() {
@@ -106,18 +129,88 @@ void Graphics::UpdateTitle() {
 #endif
 }
 
-void Graphics::Draw(Bitmap& dst) {
+bool Graphics::Draw(Bitmap& dst) {
 	auto& transition = Transition::instance();
+	auto& drawable_list = DrawableMgr::GetLocalList();
+
+	damage.Reset(dst.GetRect());
+	drawable_list.CollectDamage(dst, damage);
+
+	Color background = Main_Data::game_system ? Main_Data::game_system->GetBackgroundColor() : Color();
+	if (background != last_background || &dst != last_surface) {
+		last_background = background;
+		last_surface = &dst;
+		damage.AddAll();
+	}
+
+	// Transitions render from screenshots of the scene, so they always redraw everything
+	bool transition_shown = transition.IsActive() || transition.IsErasedNotActive();
+	if (force_redraw || transition_shown) {
+		damage.AddAll();
+	}
+	force_redraw = transition_shown;
+
+	if (damage.IsEmpty()) {
+		return false;
+	}
 
 	int min_z = std::numeric_limits<int>::min();
 	int max_z = std::numeric_limits<int>::max();
-	if (transition.IsActive()) {
-		min_z = transition.GetZ();
-	} else if (transition.IsErasedNotActive()) {
-		min_z = transition.GetZ() + 1;
-		dst.Clear();
+	bool parallel = DrawWorkers::GetThreadCount() > 1;
+
+	if (damage.IsFull() && parallel && !transition_shown) {
+		DrawBands(dst, { dst.GetRect() });
+		return true;
+	}
+
+	if (damage.IsFull()) {
+		if (transition.IsActive()) {
+			min_z = transition.GetZ();
+		} else if (transition.IsErasedNotActive()) {
+			min_z = transition.GetZ() + 1;
+			dst.Clear();
+		}
+		LocalDraw(dst, min_z, max_z);
+		return true;
+	}
+
+	if (parallel) {
+		DrawBands(dst, damage.GetRects());
+		return true;
+	}
+
+	for (auto& rect : damage.GetRects()) {
+		dst.SetClipRect(rect);
+		if (!drawable_list.empty()) {
+			current_scene->DrawBackground(dst);
+		}
+		drawable_list.Draw(dst, rect, min_z, max_z);
+	}
+	dst.ClearClipRect();
+
+	return true;
+}
+
+void Graphics::DrawBands(Bitmap& dst, const std::vector<Rect>& areas) {
+	auto& drawable_list = DrawableMgr::GetLocalList();
+
+	if (drawable_list.empty()) {
+		return;
+	}
+
+	for (auto& rect : areas) {
+		dst.SetClipRect(rect);
+		current_scene->DrawBackground(dst);
 	}
-	LocalDraw(dst, min_z, max_z);
+	dst.ClearClipRect();
+
+	// Two bands per thread keep the threads busy when the bands differ in cost
+	drawable_list.DrawBands(dst, areas, DrawWorkers::GetThreadCount() * 2,
+		std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+}
+
+void Graphics::Invalidate() {
+	force_redraw = true;
 }
 
 void Graphics::LocalDraw(Bitmap& dst, int min_z, int max_z) {
@@ -134,6 +227,8 @@ std::shared_ptr<Scene> Graphics::UpdateSceneCallback() {
 	auto prev_scene = current_scene;
 	current_scene = Scene::instance;
 
+	Invalidate();
+
 	if (current_scene) {
 		if (prev_scene) {
 			prev_scene->Suspend(current_scene->type);
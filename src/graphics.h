@@ -48,7 +48,19 @@ namespace Graphics {
 	 */
 	void Update();
 
-	void Draw(Bitmap& dst);
+	/**
+	 * Draws the parts of the screen which changed since the last call.
+	 *
+	 * @param dst screen surface
+	 * @return false when nothing changed and dst was not modified
+	 */
+	bool Draw(Bitmap& dst);
+
+	/**
+	 * Redraws the whole screen on the next call to Draw.
+	 * Needed when the screen surface was modified or lost outside of Draw.
+	 */
+	void Invalidate();
 
 	void LocalDraw(Bitmap& dst, int min_z, int max_z);
 
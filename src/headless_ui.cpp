@@ -0,0 +1,112 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "headless_ui.h"
+#include <chrono>
+#include "bitmap.h"
+#include "filefinder.h"
+#include "output.h"
+
+HeadlessUi::HeadlessUi(long width, long height, const Game_ConfigVideo& cfg, const std::string& timing_path) : BaseUi(cfg)
+{
+	SetIsFullscreen(false);
+
+	current_display_mode.width = width;
+	current_display_mode.height = height;
+	current_display_mode.bpp = 32;
+
+	// Run as fast as possible, one game time step per frame
+	fps_limit = 0;
+	frame_limit = Game_Clock::duration(0);
+	SetTimeStepFixed(true);
+
+	const DynamicFormat format(
+		32,
+		0x00FF0000,
+		0x0000FF00,
+		0x000000FF,
+		0xFF000000,
+		PF::NoAlpha);
+
+	Bitmap::SetFormat(Bitmap::ChooseFormat(format));
+	main_surface = Bitmap::Create(current_display_mode.width,
+		current_display_mode.height,
+		false,
+		current_display_mode.bpp
+	);
+
+	if (!timing_path.empty()) {
+		timing_log = std::make_unique<Filesystem_Stream::OutputStream>(FileFinder::Root().OpenOutputStream(timing_path, std::ios::out | std::ios::trunc));
+
+		if (!*timing_log) {
+			Output::Warning("Failed to open file for frame timing: {}", timing_path);
+			timing_log.reset();
+		} else {
+			*timing_log << "frame,time_us\n";
+		}
+	}
+
+	last_frame_time = Game_Clock::now();
+}
+
+void HeadlessUi::ToggleFullscreen() {
+	// no-op
+}
+
+void HeadlessUi::ToggleZoom() {
+	// no-op
+}
+
+void HeadlessUi::UpdateDisplay() {
+	RecordFrame();
+}
+
+bool HeadlessUi::FlushDisplay() {
+	// The unchanged screen counts as a frame too
+	RecordFrame();
+	return true;
+}
+
+void HeadlessUi::SetTitle(const std::string&) {
+	// no-op
+}
+
+bool HeadlessUi::ShowCursor(bool) {
+	return false;
+}
+
+void HeadlessUi::ProcessEvents() {
+	// no-op, input comes from --replay-input
+}
+
+#ifdef SUPPORT_AUDIO
+AudioInterface& HeadlessUi::GetAudio() {
+	return audio_;
+}
+#endif
+
+void HeadlessUi::RecordFrame() {
+	const auto now = Game_Clock::now();
+	const auto dt = std::chrono::duration_cast<std::chrono::microseconds>(now - last_frame_time);
+	last_frame_time = now;
+
+	if (timing_log) {
+		*timing_log << frame << ',' << dt.count() << '\n';
+	}
+	++frame;
+}
@@ -0,0 +1,81 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_HEADLESS_UI_H
+#define EP_HEADLESS_UI_H
+
+// Headers
+#include <memory>
+#include <string>
+#include "audio.h"
+#include "baseui.h"
+#include "filesystem_stream.h"
+#include "game_clock.h"
+
+/**
+ * HeadlessUi class.
+ *
+ * Draws into an in-memory surface which is never shown and has no audio
+ * output. Every frame simulates exactly one game time step and the frame
+ * rate is not limited, so runs with --replay-input are repeatable and finish
+ * as fast as the machine allows.
+ */
+class HeadlessUi : public BaseUi {
+public:
+	/**
+	 * Constructor.
+	 *
+	 * @param width display surface width.
+	 * @param height display surface height.
+	 * @param cfg video config options
+	 * @param timing_path file the time of every frame is written to, empty to disable
+	 */
+	HeadlessUi(long width, long height, const Game_ConfigVideo& cfg, const std::string& timing_path);
+
+	/**
+	 * Inherited from BaseUi.
+	 */
+	/** @{ */
+
+	void ToggleFullscreen() override;
+	void ToggleZoom() override;
+	void UpdateDisplay() override;
+	bool FlushDisplay() override;
+	void SetTitle(const std::string &title) override;
+	bool ShowCursor(bool flag) override;
+	void ProcessEvents() override;
+
+#ifdef SUPPORT_AUDIO
+	AudioInterface& GetAudio() override;
+#endif
+
+	/** @} */
+
+private:
+	/** Writes the time since the previous frame to the timing log */
+	void RecordFrame();
+
+	std::unique_ptr<Filesystem_Stream::OutputStream> timing_log;
+	Game_Clock::time_point last_frame_time;
+	int frame = 0;
+
+#ifdef SUPPORT_AUDIO
+	EmptyAudio audio_;
+#endif
+};
+
+#endif
@@ -16,12 +16,96 @@
  */
 
 #include "instrumentation.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
 #include "utils.h"
 
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 __itt_domain* Instrumentation::domain = nullptr;
 #endif
 
+std::atomic<bool> Instrumentation::profiler_enabled = { false };
+int Instrumentation::profiler_frames = 0;
+
+namespace {
+	using clock = std::chrono::steady_clock;
+
+	/** Number of scopes kept per thread for the trace, power of two */
+	constexpr uint32_t trace_capacity = 1 << 15;
+
+	struct TraceEvent {
+		const char* name;
+		int64_t begin_ns;
+		int64_t end_ns;
+	};
+
+	/** Ring buffer of the scopes of one thread, only written by that thread */
+	struct ThreadTrace {
+		std::string name;
+		int id = 0;
+		std::unique_ptr<TraceEvent[]> events;
+		std::atomic<uint32_t> head = { 0 };
+	};
+
+	struct Registry {
+		std::mutex mutex;
+		std::vector<Instrumentation::Zone*> zones;
+		std::vector<std::unique_ptr<ThreadTrace>> traces;
+	};
+
+	// Only changed by EnableProfiler before other threads start
+	bool record_trace = false;
+	clock::time_point epoch;
+
+	thread_local ThreadTrace* thread_trace = nullptr;
+
+	Registry& GetRegistry() {
+		static Registry registry;
+		return registry;
+	}
+
+	ThreadTrace& GetThreadTrace() {
+		if (!thread_trace) {
+			auto& registry = GetRegistry();
+			std::lock_guard<std::mutex> lock(registry.mutex);
+
+			auto trace = std::make_unique<ThreadTrace>();
+			trace->id = static_cast<int>(registry.traces.size()) + 1;
+			trace->name = "Thread " + std::to_string(trace->id);
+			trace->events.reset(new TraceEvent[trace_capacity]);
+			thread_trace = trace.get();
+			registry.traces.push_back(std::move(trace));
+		}
+		return *thread_trace;
+	}
+
+	void WriteJsonString(std::ostream& os, const char* str) {
+		os << '"';
+		for (; *str; ++str) {
+			char c = *str;
+			if (c == '"' || c == '\\') {
+				os << '\\' << c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				os << ' ';
+			} else {
+				os << c;
+			}
+		}
+		os << '"';
+	}
+
+	/** Trace timestamps are microseconds, keep the nanoseconds as fraction */
+	void WriteMicroseconds(std::ostream& os, int64_t ns) {
+		const auto frac = static_cast<int>(ns % 1000);
+		os << ns / 1000 << '.' << static_cast<char>('0' + frac / 100)
+			<< static_cast<char>('0' + frac / 10 % 10) << static_cast<char>('0' + frac % 10);
+	}
+}
+
 void Instrumentation::Init(const char* name) {
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(!domain);
@@ -34,3 +118,118 @@ void Instrumentation::Init(const char* name) {
 	(void)name;
 #endif
 }
+
+void Instrumentation::EnableProfiler(bool trace) {
+	if (!IsProfilerEnabled()) {
+		epoch = clock::now();
+	}
+	record_trace = record_trace || trace;
+	profiler_enabled = true;
+}
+
+void Instrumentation::SetThreadName(const char* name) {
+	if (!record_trace) {
+		return;
+	}
+
+	auto& trace = GetThreadTrace();
+	std::lock_guard<std::mutex> lock(GetRegistry().mutex);
+	trace.name = name;
+}
+
+Instrumentation::Zone::Zone(const char* name) : name(name) {
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.zones.push_back(this);
+}
+
+void Instrumentation::EndScope(Zone& zone, std::chrono::steady_clock::time_point begin) {
+	const auto end = clock::now();
+
+	zone.total_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(), std::memory_order_relaxed);
+	zone.calls.fetch_add(1, std::memory_order_relaxed);
+
+	if (record_trace) {
+		auto& trace = GetThreadTrace();
+		const uint32_t head = trace.head.load(std::memory_order_relaxed);
+
+		auto& event = trace.events[head % trace_capacity];
+		event.name = zone.name;
+		event.begin_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch).count();
+		event.end_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - epoch).count();
+
+		trace.head.store(head + 1, std::memory_order_release);
+	}
+}
+
+void Instrumentation::WriteTrace(std::ostream& os) {
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	bool first = true;
+	auto next = [&]() {
+		os << (first ? "\n" : ",\n");
+		first = false;
+	};
+
+	os << "{\"traceEvents\":[";
+	for (auto& trace : registry.traces) {
+		next();
+		os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << trace->id << ",\"args\":{\"name\":";
+		WriteJsonString(os, trace->name.c_str());
+		os << "}}";
+
+		// The thread keeps writing, so skip the oldest half which it may overwrite meanwhile
+		const uint32_t head = trace->head.load(std::memory_order_acquire);
+		const uint32_t count = std::min(head, trace_capacity / 2);
+		for (uint32_t i = head - count; i != head; ++i) {
+			const auto& event = trace->events[i % trace_capacity];
+			next();
+			os << "{\"name\":";
+			WriteJsonString(os, event.name);
+			os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << trace->id << ",\"ts\":";
+			WriteMicroseconds(os, event.begin_ns);
+			os << ",\"dur\":";
+			WriteMicroseconds(os, event.end_ns - event.begin_ns);
+			os << "}";
+		}
+	}
+	os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+std::vector<Instrumentation::ZoneStats> Instrumentation::TakeZoneStats() {
+	std::vector<ZoneStats> stats;
+
+	const int frames = std::max(profiler_frames, 1);
+	profiler_frames = 0;
+
+	auto& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	for (auto* zone : registry.zones) {
+		const auto ns = zone->total_ns.exchange(0, std::memory_order_relaxed);
+		const auto calls = zone->calls.exchange(0, std::memory_order_relaxed);
+		if (calls == 0) {
+			continue;
+		}
+
+		const double ms = ns / 1e6 / frames;
+		const double calls_per_frame = static_cast<double>(calls) / frames;
+
+		auto it = std::find_if(stats.begin(), stats.end(), [&](const ZoneStats& s) {
+			return std::strcmp(s.name, zone->name) == 0;
+		});
+		if (it != stats.end()) {
+			it->ms_per_frame += ms;
+			it->calls_per_frame += calls_per_frame;
+		} else {
+			stats.push_back({ zone->name, ms, calls_per_frame });
+		}
+	}
+
+	std::sort(stats.begin(), stats.end(), [](const ZoneStats& a, const ZoneStats& b) {
+		return a.ms_per_frame > b.ms_per_frame;
+	});
+
+	return stats;
+}
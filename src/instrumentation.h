@@ -25,7 +25,12 @@
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 #include <ittnotify.h>
 #endif
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
 
 class Instrumentation {
 public:
@@ -42,6 +47,95 @@ public:
 	/** Call at the end of a frame */
 	static void FrameEnd();
 
+	/**
+	 * Enables the built-in frame profiler. Must be called before other
+	 * threads are started.
+	 *
+	 * @param record_trace if true every Scope is kept for WriteTrace(),
+	 * otherwise only the per zone totals are collected
+	 */
+	static void EnableProfiler(bool record_trace);
+
+	/** @return whether the frame profiler is enabled */
+	static bool IsProfilerEnabled();
+
+	/**
+	 * Names the calling thread in the trace.
+	 *
+	 * @param name thread name
+	 */
+	static void SetThreadName(const char* name);
+
+	/**
+	 * Writes the recorded scopes in the Chrome trace event format, which
+	 * can be opened in chrome://tracing or Perfetto.
+	 * Only the most recent scopes of each thread are kept.
+	 *
+	 * @param os stream to write the JSON to
+	 */
+	static void WriteTrace(std::ostream& os);
+
+	/** Time spent in a zone */
+	struct ZoneStats {
+		/** Name of the zone */
+		const char* name;
+		/** Time per frame in milliseconds */
+		double ms_per_frame;
+		/** Number of scopes per frame */
+		double calls_per_frame;
+	};
+
+	/**
+	 * Returns the time spent in each zone since the previous call,
+	 * averaged per frame and sorted by time. Zones with the same name are
+	 * combined.
+	 *
+	 * @return zone statistics
+	 */
+	static std::vector<ZoneStats> TakeZoneStats();
+
+	/**
+	 * Named zone of the frame profiler. Declare zones as function local
+	 * statics and time them with a Scope:
+	 *
+	 *   static Instrumentation::Zone zone("Game_Map::Update");
+	 *   Instrumentation::Scope scope(zone);
+	 */
+	class Zone {
+	public:
+		/** @param name zone name, must be a string literal */
+		explicit Zone(const char* name);
+
+		Zone(const Zone&) = delete;
+		Zone& operator=(const Zone&) = delete;
+
+		/** @return zone name */
+		const char* GetName() const;
+
+	private:
+		friend class Instrumentation;
+
+		const char* name;
+		std::atomic<int64_t> total_ns = { 0 };
+		std::atomic<int32_t> calls = { 0 };
+	};
+
+	/** Times the enclosing block as part of a Zone, when the profiler is enabled */
+	class Scope {
+	public:
+		/** @param zone zone the time is added to */
+		explicit Scope(Zone& zone) noexcept;
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+		~Scope();
+
+	private:
+		Zone* zone = nullptr;
+		std::chrono::steady_clock::time_point begin;
+	};
+
 	/** RAII wrapper around FrameBegin() / FrameEnd() */
 	class FrameScope {
 	public:
@@ -74,12 +168,20 @@ public:
 	};
 
 private:
+	static void EndScope(Zone& zone, std::chrono::steady_clock::time_point begin);
+
+	static std::atomic<bool> profiler_enabled;
+	static int profiler_frames;
+
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	static __itt_domain* domain;
 #endif
 };
 
 inline void Instrumentation::FrameBegin() {
+	if (IsProfilerEnabled()) {
+		++profiler_frames;
+	}
 #ifdef PLAYER_INSTRUMENTATION_VTUNE
 	assert(domain);
 	__itt_frame_begin_v3(domain, nullptr);
@@ -92,6 +194,27 @@ inline void Instrumentation::FrameEnd() {
 #endif
 }
 
+inline bool Instrumentation::IsProfilerEnabled() {
+	return profiler_enabled.load(std::memory_order_relaxed);
+}
+
+inline const char* Instrumentation::Zone::GetName() const {
+	return name;
+}
+
+inline Instrumentation::Scope::Scope(Zone& zone) noexcept {
+	if (IsProfilerEnabled()) {
+		this->zone = &zone;
+		begin = std::chrono::steady_clock::now();
+	}
+}
+
+inline Instrumentation::Scope::~Scope() {
+	if (zone) {
+		EndScope(*zone, begin);
+	}
+}
+
 inline Instrumentation::FrameScope::FrameScope(bool frame_begin)
 {
 	if (frame_begin) {
@@ -29,6 +29,21 @@ MessageOverlay::MessageOverlay() : Drawable(Priority_Overlay, Drawable::Flags::G
 	// Graphics::RegisterDrawable is in the Update function
 }
 
+bool MessageOverlay::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
+	if (!bitmap || (!IsAnyMessageVisible() && !show_all)) {
+		return true;
+	}
+
+	// The bitmap is redrawn after blitting it, so the new text appears one frame later
+	if (dirty || bitmap->GetRevision() != bitmap_revision) {
+		bitmap_revision = bitmap->GetRevision();
+		SetDamaged();
+	}
+
+	rect = Rect(ox, oy, bitmap->GetWidth(), bitmap->GetHeight());
+	return true;
+}
+
 void MessageOverlay::Draw(Bitmap& dst) {
 	if (!IsAnyMessageVisible() && !show_all) {
 		// Don't render overlay when no message visible
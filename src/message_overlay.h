@@ -45,6 +45,8 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	void Update();
 
 	void AddMessage(const std::string& message, Color color);
@@ -69,6 +71,8 @@ private:
 
 	bool dirty = false;
 
+	uint32_t bitmap_revision = 0;
+
 	int counter = 0;
 
 	bool show_all = false;
@@ -0,0 +1,161 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MULTIPLAYER_PACKET_H
+#define EP_MULTIPLAYER_PACKET_H
+
+// Headers
+#include <cstddef>
+#include <cstdint>
+#include "string_view.h"
+
+/**
+ * Decodes a binary multiplayer message in place.
+ *
+ * Values are little endian. Every read is bounds checked: reading past the
+ * end marks the reader as failed and returns 0 or an empty string.
+ * Strings are returned as views into the message and are only valid as
+ * long as the message buffer is.
+ *
+ * A message has the layout
+ *   [uint16 schema version] ([uint16 type] [uint16 size] [size bytes payload])...
+ */
+class MultiplayerPacketReader {
+public:
+	/**
+	 * Creates a reader for the given buffer.
+	 *
+	 * @param data message data, not copied
+	 * @param size size of data in bytes
+	 */
+	MultiplayerPacketReader(const char* data, size_t size);
+
+	/** @return next 8 bit unsigned value */
+	uint8_t ReadU8();
+
+	/** @return next 16 bit unsigned value */
+	uint16_t ReadU16();
+
+	/** @return next 32 bit signed value */
+	int32_t ReadI32();
+
+	/**
+	 * @param len number of bytes
+	 * @return view of the next len bytes
+	 */
+	StringView ReadString(size_t len);
+
+	/** @return view of all remaining bytes */
+	StringView ReadRest();
+
+	/**
+	 * Reads a [uint16 type] [uint16 size] record header and returns a reader
+	 * limited to the record payload. The payload is skipped in this reader,
+	 * so unknown records can be ignored.
+	 *
+	 * @param type set to the record type
+	 * @return reader for the payload
+	 */
+	MultiplayerPacketReader ReadRecord(uint16_t& type);
+
+	/** @return number of unread bytes */
+	size_t Remaining() const;
+
+	/** @return whether a read went past the end */
+	bool Failed() const;
+
+private:
+	const unsigned char* Take(size_t n);
+
+	const unsigned char* cur = nullptr;
+	const unsigned char* end = nullptr;
+	bool failed = false;
+};
+
+inline MultiplayerPacketReader::MultiplayerPacketReader(const char* data, size_t size)
+	: cur(reinterpret_cast<const unsigned char*>(data)), end(cur + size)
+{
+}
+
+inline const unsigned char* MultiplayerPacketReader::Take(size_t n) {
+	if (failed || static_cast<size_t>(end - cur) < n) {
+		failed = true;
+		return nullptr;
+	}
+	auto* p = cur;
+	cur += n;
+	return p;
+}
+
+inline uint8_t MultiplayerPacketReader::ReadU8() {
+	auto* p = Take(1);
+	if (!p) {
+		return 0;
+	}
+	return p[0];
+}
+
+inline uint16_t MultiplayerPacketReader::ReadU16() {
+	auto* p = Take(2);
+	if (!p) {
+		return 0;
+	}
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline int32_t MultiplayerPacketReader::ReadI32() {
+	auto* p = Take(4);
+	if (!p) {
+		return 0;
+	}
+	uint32_t v = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+	return static_cast<int32_t>(v);
+}
+
+inline StringView MultiplayerPacketReader::ReadString(size_t len) {
+	auto* p = Take(len);
+	if (!p) {
+		return {};
+	}
+	return StringView(reinterpret_cast<const char*>(p), len);
+}
+
+inline StringView MultiplayerPacketReader::ReadRest() {
+	return ReadString(Remaining());
+}
+
+inline MultiplayerPacketReader MultiplayerPacketReader::ReadRecord(uint16_t& type) {
+	type = ReadU16();
+	uint16_t size = ReadU16();
+	auto* p = Take(size);
+	if (!p) {
+		MultiplayerPacketReader r(nullptr, 0);
+		r.failed = true;
+		return r;
+	}
+	return MultiplayerPacketReader(reinterpret_cast<const char*>(p), size);
+}
+
+inline size_t MultiplayerPacketReader::Remaining() const {
+	return failed ? 0 : static_cast<size_t>(end - cur);
+}
+
+inline bool MultiplayerPacketReader::Failed() const {
+	return failed;
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multiplayer_transport.h"
+
+#ifdef EMSCRIPTEN
+#  include "multiplayer_transport_emscripten.h"
+#elif defined(__unix__) || defined(__APPLE__)
+#  include "multiplayer_transport_native.h"
+#endif
+
+std::unique_ptr<MultiplayerTransport> MultiplayerTransport::Create() {
+#ifdef EMSCRIPTEN
+	return std::make_unique<EmscriptenTransport>();
+#elif defined(__unix__) || defined(__APPLE__)
+	return std::make_unique<NativeTransport>();
+#else
+	return nullptr;
+#endif
+}
+
+void MultiplayerTransport::SetOnOpen(OpenHandler handler) {
+	on_open = std::move(handler);
+}
+
+void MultiplayerTransport::SetOnClose(CloseHandler handler) {
+	on_close = std::move(handler);
+}
+
+void MultiplayerTransport::SetOnMessage(MessageHandler handler) {
+	on_message = std::move(handler);
+}
+
+void MultiplayerTransport::NotifyOpen() {
+	state = State::Open;
+	if (on_open) {
+		on_open();
+	}
+}
+
+void MultiplayerTransport::NotifyClose() {
+	state = State::Closed;
+	if (on_close) {
+		on_close();
+	}
+}
+
+void MultiplayerTransport::NotifyMessage(char* data, size_t size, bool is_text) {
+	if (on_message) {
+		on_message(data, size, is_text);
+	}
+}
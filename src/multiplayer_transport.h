@@ -0,0 +1,124 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MULTIPLAYER_TRANSPORT_H
+#define EP_MULTIPLAYER_TRANSPORT_H
+
+// Headers
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+
+/**
+ * Abstract message based connection used by Game_Multiplayer.
+ *
+ * Implementations deliver whole WebSocket messages through the registered
+ * handlers. All handlers are invoked on the main thread, either from the
+ * browser event loop (Emscripten) or from Poll (native).
+ */
+class MultiplayerTransport {
+public:
+	/** Connection state, values match the WebSocket readyState */
+	enum class State {
+		Connecting = 0,
+		Open = 1,
+		Closing = 2,
+		Closed = 3
+	};
+
+	using OpenHandler = std::function<void()>;
+	using CloseHandler = std::function<void()>;
+	/**
+	 * Receives a message. The data is only valid during the call and may be
+	 * modified in place. Text messages are followed by a null terminator at data[size].
+	 */
+	using MessageHandler = std::function<void(char* data, size_t size, bool is_text)>;
+
+	/**
+	 * Creates the transport for the current platform.
+	 *
+	 * @return transport or nullptr when the platform has no network support.
+	 */
+	static std::unique_ptr<MultiplayerTransport> Create();
+
+	virtual ~MultiplayerTransport() = default;
+
+	/**
+	 * Starts connecting to the given WebSocket url.
+	 * Any previous connection is closed first.
+	 *
+	 * @param url ws:// url of the server
+	 */
+	virtual void Open(const std::string& url) = 0;
+
+	/**
+	 * Closes the connection. No handlers are invoked afterwards.
+	 */
+	virtual void Close() = 0;
+
+	/**
+	 * Sends a binary message.
+	 *
+	 * @param data message payload
+	 * @param size payload size in bytes
+	 * @return whether the message was accepted for sending
+	 */
+	virtual bool Send(const void* data, size_t size) = 0;
+
+	/**
+	 * Processes pending network events and invokes the handlers.
+	 * Must be called once per frame. Event driven implementations do nothing here.
+	 */
+	virtual void Poll() {}
+
+	/** @return current connection state */
+	State GetState() const;
+
+	/** @return whether the connection is open */
+	bool IsOpen() const;
+
+	void SetOnOpen(OpenHandler handler);
+	void SetOnClose(CloseHandler handler);
+	void SetOnMessage(MessageHandler handler);
+
+protected:
+	void SetState(State new_state);
+	void NotifyOpen();
+	void NotifyClose();
+	void NotifyMessage(char* data, size_t size, bool is_text);
+
+private:
+	State state = State::Closed;
+	OpenHandler on_open;
+	CloseHandler on_close;
+	MessageHandler on_message;
+};
+
+inline MultiplayerTransport::State MultiplayerTransport::GetState() const {
+	return state;
+}
+
+inline bool MultiplayerTransport::IsOpen() const {
+	return state == State::Open;
+}
+
+inline void MultiplayerTransport::SetState(State new_state) {
+	state = new_state;
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multiplayer_transport_emscripten.h"
+
+#ifdef EMSCRIPTEN
+
+EmscriptenTransport::~EmscriptenTransport() {
+	Close();
+}
+
+void EmscriptenTransport::Open(const std::string& url) {
+	Close();
+
+	EmscriptenWebSocketCreateAttributes ws_attrs = {
+		url.c_str(),
+		"binary",
+		EM_TRUE
+	};
+
+	socket = emscripten_websocket_new(&ws_attrs);
+	if (socket <= 0) {
+		socket = 0;
+		return;
+	}
+
+	SetState(State::Connecting);
+	emscripten_websocket_set_onopen_callback(socket, this, OnOpen);
+	emscripten_websocket_set_onclose_callback(socket, this, OnClose);
+	emscripten_websocket_set_onmessage_callback(socket, this, OnMessage);
+}
+
+void EmscriptenTransport::Close() {
+	if (socket == 0) {
+		return;
+	}
+
+	// Detach first: the close event must not reach a transport that is gone
+	emscripten_websocket_set_onopen_callback(socket, nullptr, nullptr);
+	emscripten_websocket_set_onclose_callback(socket, nullptr, nullptr);
+	emscripten_websocket_set_onmessage_callback(socket, nullptr, nullptr);
+	emscripten_websocket_close(socket, 1000, "");
+	emscripten_websocket_delete(socket);
+	socket = 0;
+	SetState(State::Closed);
+}
+
+bool EmscriptenTransport::Send(const void* data, size_t size) {
+	if (!IsOpen()) {
+		return false;
+	}
+	return emscripten_websocket_send_binary(socket, const_cast<void*>(data), size) == EMSCRIPTEN_RESULT_SUCCESS;
+}
+
+EM_BOOL EmscriptenTransport::OnOpen(int, const EmscriptenWebSocketOpenEvent*, void* userData) {
+	static_cast<EmscriptenTransport*>(userData)->NotifyOpen();
+	return EM_TRUE;
+}
+
+EM_BOOL EmscriptenTransport::OnClose(int, const EmscriptenWebSocketCloseEvent*, void* userData) {
+	static_cast<EmscriptenTransport*>(userData)->NotifyClose();
+	return EM_TRUE;
+}
+
+EM_BOOL EmscriptenTransport::OnMessage(int, const EmscriptenWebSocketMessageEvent* event, void* userData) {
+	size_t size = event->numBytes;
+	if (event->isText && size > 0) {
+		// Text messages are delivered with a trailing null terminator
+		--size;
+	}
+	static_cast<EmscriptenTransport*>(userData)->NotifyMessage(reinterpret_cast<char*>(event->data), size, event->isText);
+	return EM_TRUE;
+}
+
+#endif
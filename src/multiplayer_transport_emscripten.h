@@ -0,0 +1,50 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MULTIPLAYER_TRANSPORT_EMSCRIPTEN_H
+#define EP_MULTIPLAYER_TRANSPORT_EMSCRIPTEN_H
+
+#ifdef EMSCRIPTEN
+
+// Headers
+#include <emscripten/websocket.h>
+#include "multiplayer_transport.h"
+
+/**
+ * Transport using the browser WebSocket API.
+ * Handlers are invoked from the browser event loop.
+ */
+class EmscriptenTransport : public MultiplayerTransport {
+public:
+	EmscriptenTransport() = default;
+	~EmscriptenTransport() override;
+
+	void Open(const std::string& url) override;
+	void Close() override;
+	bool Send(const void* data, size_t size) override;
+
+private:
+	static EM_BOOL OnOpen(int eventType, const EmscriptenWebSocketOpenEvent* event, void* userData);
+	static EM_BOOL OnClose(int eventType, const EmscriptenWebSocketCloseEvent* event, void* userData);
+	static EM_BOOL OnMessage(int eventType, const EmscriptenWebSocketMessageEvent* event, void* userData);
+
+	EMSCRIPTEN_WEBSOCKET_T socket = 0;
+};
+
+#endif
+
+#endif
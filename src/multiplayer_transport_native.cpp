@@ -0,0 +1,499 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multiplayer_transport_native.h"
+
+#if !defined(EMSCRIPTEN) && (defined(__unix__) || defined(__APPLE__))
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "output.h"
+
+#ifndef MSG_NOSIGNAL
+#  define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+	namespace Opcode {
+		constexpr uint8_t continuation = 0x0;
+		constexpr uint8_t text = 0x1;
+		constexpr uint8_t binary = 0x2;
+		constexpr uint8_t close = 0x8;
+		constexpr uint8_t ping = 0x9;
+		constexpr uint8_t pong = 0xA;
+	}
+
+	constexpr size_t read_chunk_size = 16384;
+
+	std::string Base64Encode(const uint8_t* data, size_t size) {
+		static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string out;
+		out.reserve((size + 2) / 3 * 4);
+		for (size_t i = 0; i < size; i += 3) {
+			uint32_t n = data[i] << 16;
+			if (i + 1 < size) n |= data[i + 1] << 8;
+			if (i + 2 < size) n |= data[i + 2];
+			out += table[(n >> 18) & 63];
+			out += table[(n >> 12) & 63];
+			out += (i + 1 < size) ? table[(n >> 6) & 63] : '=';
+			out += (i + 2 < size) ? table[n & 63] : '=';
+		}
+		return out;
+	}
+
+	bool ParseUrl(const std::string& url, std::string& host, std::string& port, std::string& path) {
+		const std::string scheme = "ws://";
+		if (url.compare(0, scheme.size(), scheme) != 0) {
+			return false;
+		}
+
+		auto rest = url.substr(scheme.size());
+		auto slash = rest.find('/');
+		auto authority = rest.substr(0, slash);
+		path = (slash == std::string::npos) ? "/" : rest.substr(slash);
+
+		auto colon = authority.rfind(':');
+		if (colon != std::string::npos && authority.find(']', colon) == std::string::npos) {
+			host = authority.substr(0, colon);
+			port = authority.substr(colon + 1);
+		} else {
+			host = authority;
+			port = "80";
+		}
+		if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+			host = host.substr(1, host.size() - 2);
+		}
+		return !host.empty() && !port.empty();
+	}
+}
+
+NativeTransport::NativeTransport() : mask_rng(std::random_device{}()) {
+}
+
+NativeTransport::~NativeTransport() {
+	Close();
+}
+
+void NativeTransport::Open(const std::string& url) {
+	Close();
+
+	in_buf.clear();
+	in_pos = 0;
+	out_buf.clear();
+	out_pos = 0;
+	fragment_buf.clear();
+
+	std::string port;
+	if (!ParseUrl(url, host, port, path)) {
+		Output::Warning("Multiplayer: Unsupported server url {} (only ws:// is supported)", url);
+		return;
+	}
+
+	addrinfo hints = {};
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* result = nullptr;
+
+	// Name resolution blocks, but only once per connection attempt
+	int err = getaddrinfo(host.c_str(), port.c_str(), &hints, &result);
+	if (err != 0) {
+		Output::Warning("Multiplayer: Cannot resolve {}: {}", host, gai_strerror(err));
+		return;
+	}
+
+	for (addrinfo* ai = result; ai != nullptr; ai = ai->ai_next) {
+		int s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (s < 0) {
+			continue;
+		}
+
+		fcntl(s, F_SETFL, fcntl(s, F_GETFL, 0) | O_NONBLOCK);
+		int one = 1;
+		setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+#ifdef SO_NOSIGPIPE
+		setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+		if (connect(s, ai->ai_addr, ai->ai_addrlen) == 0 || errno == EINPROGRESS) {
+			fd = s;
+			break;
+		}
+		close(s);
+	}
+	freeaddrinfo(result);
+
+	if (fd < 0) {
+		Output::Warning("Multiplayer: Cannot connect to {}: {}", url, strerror(errno));
+		return;
+	}
+
+	++generation;
+	phase = Phase::TcpConnect;
+	SetState(State::Connecting);
+}
+
+void NativeTransport::Close() {
+	if (fd < 0) {
+		return;
+	}
+
+	if (phase == Phase::Established) {
+		// Best effort, the server may not see it when the socket buffer is full
+		uint8_t status[2] = { 1000 >> 8, 1000 & 0xFF };
+		QueueFrame(Opcode::close, status, sizeof(status));
+		Flush();
+	}
+
+	close(fd);
+	fd = -1;
+	++generation;
+	phase = Phase::None;
+	SetState(State::Closed);
+}
+
+void NativeTransport::Fail(const char* what) {
+	if (what) {
+		Output::Debug("Multiplayer: Connection lost ({})", what);
+	}
+	close(fd);
+	fd = -1;
+	++generation;
+	phase = Phase::None;
+	NotifyClose();
+}
+
+bool NativeTransport::Send(const void* data, size_t size) {
+	if (!IsOpen()) {
+		return false;
+	}
+	QueueFrame(Opcode::binary, data, size);
+	if (!Flush()) {
+		Fail(strerror(errno));
+		return false;
+	}
+	return true;
+}
+
+void NativeTransport::QueueFrame(uint8_t opcode, const void* data, size_t size) {
+	uint8_t header[14];
+	size_t header_size = 2;
+
+	header[0] = 0x80 | opcode;
+	if (size < 126) {
+		header[1] = 0x80 | static_cast<uint8_t>(size);
+	} else if (size <= 0xFFFF) {
+		header[1] = 0x80 | 126;
+		header[2] = static_cast<uint8_t>(size >> 8);
+		header[3] = static_cast<uint8_t>(size);
+		header_size = 4;
+	} else {
+		header[1] = 0x80 | 127;
+		for (int i = 0; i < 8; ++i) {
+			header[2 + i] = static_cast<uint8_t>(static_cast<uint64_t>(size) >> (56 - i * 8));
+		}
+		header_size = 10;
+	}
+
+	// Client to server frames must be masked
+	uint32_t mask = mask_rng();
+	uint8_t* key = header + header_size;
+	std::memcpy(key, &mask, 4);
+	header_size += 4;
+
+	out_buf.insert(out_buf.end(), header, header + header_size);
+	size_t offset = out_buf.size();
+	out_buf.resize(offset + size);
+
+	auto* src = static_cast<const uint8_t*>(data);
+	for (size_t i = 0; i < size; ++i) {
+		out_buf[offset + i] = static_cast<char>(src[i] ^ key[i & 3]);
+	}
+}
+
+bool NativeTransport::Flush() {
+	while (out_pos < out_buf.size()) {
+		ssize_t n = send(fd, out_buf.data() + out_pos, out_buf.size() - out_pos, MSG_NOSIGNAL);
+		if (n < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		out_pos += n;
+	}
+
+	if (out_pos == out_buf.size()) {
+		out_buf.clear();
+		out_pos = 0;
+	}
+	return true;
+}
+
+bool NativeTransport::ReadAvailable() {
+	for (;;) {
+		size_t offset = in_buf.size();
+		in_buf.resize(offset + read_chunk_size);
+		ssize_t n = recv(fd, in_buf.data() + offset, read_chunk_size, 0);
+		if (n > 0) {
+			in_buf.resize(offset + n);
+			continue;
+		}
+		in_buf.resize(offset);
+		if (n == 0) {
+			errno = ECONNRESET;
+			return false;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			return true;
+		}
+		if (errno != EINTR) {
+			return false;
+		}
+	}
+}
+
+bool NativeTransport::ProcessHandshake() {
+	static const char terminator[] = "\r\n\r\n";
+	auto end = std::search(in_buf.begin() + in_pos, in_buf.end(), terminator, terminator + 4);
+	if (end == in_buf.end()) {
+		return true;
+	}
+
+	std::string status_line(in_buf.begin() + in_pos, std::find(in_buf.begin() + in_pos, end, '\r'));
+	if (status_line.find(" 101") == std::string::npos) {
+		Output::Warning("Multiplayer: Handshake rejected: {}", status_line);
+		return false;
+	}
+
+	in_pos = (end - in_buf.begin()) + 4;
+	phase = Phase::Established;
+
+	unsigned gen = generation;
+	NotifyOpen();
+	return gen == generation;
+}
+
+void NativeTransport::NotifyTextInPlace(size_t offset, size_t size) {
+	// Terminate the text inside the receive buffer instead of copying it.
+	// The byte after the payload belongs to the next frame and is restored.
+	size_t term = offset + size;
+	bool appended = term == in_buf.size();
+	if (appended) {
+		in_buf.push_back('\0');
+	}
+	char saved = in_buf[term];
+	in_buf[term] = '\0';
+
+	unsigned gen = generation;
+	NotifyMessage(in_buf.data() + offset, size, true);
+	if (gen != generation) {
+		return;
+	}
+
+	if (appended) {
+		in_buf.pop_back();
+	} else {
+		in_buf[term] = saved;
+	}
+}
+
+bool NativeTransport::ProcessFrames() {
+	unsigned gen = generation;
+
+	while (in_buf.size() - in_pos >= 2) {
+		auto* p = reinterpret_cast<const uint8_t*>(in_buf.data() + in_pos);
+		size_t avail = in_buf.size() - in_pos;
+
+		bool fin = (p[0] & 0x80) != 0;
+		uint8_t opcode = p[0] & 0x0F;
+		bool masked = (p[1] & 0x80) != 0;
+		uint64_t len = p[1] & 0x7F;
+		size_t header_size = 2;
+
+		if (len == 126) {
+			if (avail < 4) break;
+			len = (p[2] << 8) | p[3];
+			header_size = 4;
+		} else if (len == 127) {
+			if (avail < 10) break;
+			len = 0;
+			for (int i = 0; i < 8; ++i) {
+				len = (len << 8) | p[2 + i];
+			}
+			header_size = 10;
+		}
+
+		uint8_t key[4] = {};
+		if (masked) {
+			if (avail < header_size + 4) break;
+			std::memcpy(key, p + header_size, 4);
+			header_size += 4;
+		}
+
+		if (avail - header_size < len) {
+			break;
+		}
+
+		char* payload = in_buf.data() + in_pos + header_size;
+		size_t size = static_cast<size_t>(len);
+		if (masked) {
+			for (size_t i = 0; i < size; ++i) {
+				payload[i] ^= key[i & 3];
+			}
+		}
+		in_pos += header_size + size;
+
+		switch (opcode) {
+			case Opcode::text:
+			case Opcode::binary:
+				if (fin && opcode == Opcode::text) {
+					NotifyTextInPlace(payload - in_buf.data(), size);
+				} else if (fin) {
+					NotifyMessage(payload, size, false);
+				} else {
+					fragment_buf.assign(payload, payload + size);
+					fragment_is_text = opcode == Opcode::text;
+				}
+				break;
+			case Opcode::continuation:
+				fragment_buf.insert(fragment_buf.end(), payload, payload + size);
+				if (fin) {
+					size = fragment_buf.size();
+					fragment_buf.push_back('\0');
+					NotifyMessage(fragment_buf.data(), size, fragment_is_text);
+					fragment_buf.clear();
+				}
+				break;
+			case Opcode::ping:
+				QueueFrame(Opcode::pong, payload, size);
+				break;
+			case Opcode::pong:
+				break;
+			case Opcode::close:
+				Fail(nullptr);
+				return false;
+			default:
+				errno = EPROTO;
+				return false;
+		}
+
+		if (gen != generation) {
+			// A handler closed or reopened the connection
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void NativeTransport::Poll() {
+	if (fd < 0) {
+		return;
+	}
+
+	pollfd pfd = {};
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	if (phase == Phase::TcpConnect || out_pos < out_buf.size()) {
+		pfd.events |= POLLOUT;
+	}
+
+	int ret = poll(&pfd, 1, 0);
+	if (ret <= 0) {
+		return;
+	}
+
+	if (phase == Phase::TcpConnect) {
+		if ((pfd.revents & (POLLOUT | POLLERR | POLLHUP)) == 0) {
+			return;
+		}
+
+		int err = 0;
+		socklen_t err_len = sizeof(err);
+		getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len);
+		if (err != 0) {
+			Fail(strerror(err));
+			return;
+		}
+
+		uint8_t nonce[16];
+		for (auto& b : nonce) {
+			b = static_cast<uint8_t>(mask_rng());
+		}
+
+		// The accept key is not verified, the server is trusted
+		std::string request =
+			"GET " + path + " HTTP/1.1\r\n"
+			"Host: " + host + "\r\n"
+			"Upgrade: websocket\r\n"
+			"Connection: Upgrade\r\n"
+			"Sec-WebSocket-Key: " + Base64Encode(nonce, sizeof(nonce)) + "\r\n"
+			"Sec-WebSocket-Protocol: binary\r\n"
+			"Sec-WebSocket-Version: 13\r\n\r\n";
+		out_buf.insert(out_buf.end(), request.begin(), request.end());
+		phase = Phase::Handshake;
+	}
+
+	if (!Flush()) {
+		Fail(strerror(errno));
+		return;
+	}
+
+	if (pfd.revents & (POLLIN | POLLERR | POLLHUP)) {
+		bool alive = ReadAvailable();
+
+		// Process buffered data even when the peer closed after sending it
+		unsigned gen = generation;
+		bool ok = true;
+		if (phase == Phase::Handshake) {
+			ok = ProcessHandshake();
+		}
+		if (ok && phase == Phase::Established) {
+			ok = ProcessFrames();
+		}
+		if (gen != generation) {
+			return;
+		}
+
+		if (!ok || !alive) {
+			Fail(strerror(errno));
+			return;
+		}
+
+		in_buf.erase(in_buf.begin(), in_buf.begin() + in_pos);
+		in_pos = 0;
+
+		// Answer pings queued while processing
+		if (!Flush()) {
+			Fail(strerror(errno));
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,83 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_MULTIPLAYER_TRANSPORT_NATIVE_H
+#define EP_MULTIPLAYER_TRANSPORT_NATIVE_H
+
+#if !defined(EMSCRIPTEN) && (defined(__unix__) || defined(__APPLE__))
+
+// Headers
+#include <cstdint>
+#include <random>
+#include <vector>
+#include "multiplayer_transport.h"
+
+/**
+ * Minimal WebSocket client (RFC 6455) on top of a non-blocking POSIX TCP socket.
+ *
+ * Only plain ws:// urls are supported. The socket is serviced by Poll,
+ * which never blocks and must be called once per frame from the main loop.
+ */
+class NativeTransport : public MultiplayerTransport {
+public:
+	NativeTransport();
+	~NativeTransport() override;
+
+	void Open(const std::string& url) override;
+	void Close() override;
+	bool Send(const void* data, size_t size) override;
+	void Poll() override;
+
+private:
+	enum class Phase {
+		None,
+		TcpConnect,
+		Handshake,
+		Established
+	};
+
+	void Fail(const char* what);
+	bool Flush();
+	bool ReadAvailable();
+	bool ProcessHandshake();
+	bool ProcessFrames();
+	void NotifyTextInPlace(size_t offset, size_t size);
+	void QueueFrame(uint8_t opcode, const void* data, size_t size);
+
+	int fd = -1;
+	Phase phase = Phase::None;
+	/** Incremented on Open/Close, used to detect reentrant calls from handlers */
+	unsigned generation = 0;
+
+	std::string host;
+	std::string path;
+
+	std::vector<char> in_buf;
+	size_t in_pos = 0;
+	std::vector<char> out_buf;
+	size_t out_pos = 0;
+
+	/** Payload of a fragmented message */
+	std::vector<char> fragment_buf;
+	bool fragment_is_text = false;
+
+	std::mt19937 mask_rng;
+};
+
+#endif
+
+#endif
@@ -92,6 +92,7 @@ namespace {
 	bool ignore_pause = false;
 
 	std::vector<std::string> log_buffer;
+	thread_local std::vector<Output::LogMessage>* thread_capture = nullptr;
 	// pair of repeat count + message
 	struct {
 		int repeat = 0;
@@ -351,6 +352,10 @@ void Output::WarningStr(std::string const& warn) {
 	if (log_level < LogLevel::Warning) {
 		return;
 	}
+	if (thread_capture) {
+		thread_capture->push_back({ LogLevel::Warning, warn });
+		return;
+	}
 	WriteLog(LogLevel::Warning, warn, Color(255, 255, 0, 255));
 }
 
@@ -358,6 +363,10 @@ void Output::InfoStr(std::string const& msg) {
 	if (log_level < LogLevel::Info) {
 		return;
 	}
+	if (thread_capture) {
+		thread_capture->push_back({ LogLevel::Info, msg });
+		return;
+	}
 	WriteLog(LogLevel::Info, msg, Color(255, 255, 255, 255));
 }
 
@@ -365,9 +374,35 @@ void Output::DebugStr(std::string const& msg) {
 	if (log_level < LogLevel::Debug) {
 		return;
 	}
+	if (thread_capture) {
+		thread_capture->push_back({ LogLevel::Debug, msg });
+		return;
+	}
 	WriteLog(LogLevel::Debug, msg, Color(128, 128, 128, 255));
 }
 
+void Output::SetThreadCapture(std::vector<LogMessage>* messages) {
+	thread_capture = messages;
+}
+
+void Output::WriteMessages(const std::vector<LogMessage>& messages) {
+	for (const auto& message : messages) {
+		switch (message.level) {
+			case LogLevel::Warning:
+				WarningStr(message.msg);
+				break;
+			case LogLevel::Info:
+				InfoStr(message.msg);
+				break;
+			case LogLevel::Debug:
+				DebugStr(message.msg);
+				break;
+			case LogLevel::Error:
+				break;
+		}
+	}
+}
+
 #ifdef GEKKO
 extern const devoptab_t dotab_stdnull;
 
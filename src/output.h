@@ -20,6 +20,7 @@
 
 // Headers
 #include <string>
+#include <vector>
 #include <iosfwd>
 #include <fmt/core.h>
 #include <lcf/dbstring.h>
@@ -167,6 +168,29 @@ namespace Output {
 	 */
 	void DebugStr(std::string const& msg);
 
+	/** A log message collected with SetThreadCapture */
+	struct LogMessage {
+		LogLevel level;
+		std::string msg;
+	};
+
+	/**
+	 * Collects the Warning, Info and Debug messages of the calling thread
+	 * instead of writing them. The log is not thread safe: worker threads
+	 * collect their messages and the main thread writes them with
+	 * WriteMessages.
+	 *
+	 * @param messages receives the messages, nullptr to write them again
+	 */
+	void SetThreadCapture(std::vector<LogMessage>* messages);
+
+	/**
+	 * Writes messages collected with SetThreadCapture.
+	 *
+	 * @param messages messages to write
+	 */
+	void WriteMessages(const std::vector<LogMessage>& messages);
+
 #ifdef GEKKO
 	/**
 	 * Helper function to disable the console on Wii
@@ -0,0 +1,291 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include <initializer_list>
+#include "pixel_kernels.h"
+
+#if defined(EP_PIXEL_KERNELS_X86) && defined(_MSC_VER)
+#  include <intrin.h>
+#  include <immintrin.h>
+#endif
+
+namespace {
+	// Hard light lookup table mapping source color to destination color
+	// FIXME: Replace this with std::array<std::array<uint8_t,256>,256> when we have C++17
+	struct HardLightTable {
+		uint8_t table[256][256] = {};
+	};
+
+	constexpr HardLightTable make_hard_light_lookup() {
+		HardLightTable hl;
+		for (int i = 0; i < 256; ++i) {
+			for (int j = 0; j < 256; ++j) {
+				int res = 0;
+				if (i <= 128)
+					res = (2 * i * j) / 255;
+				else
+					res = 255 - 2 * (255 - i) * (255 - j) / 255;
+				hl.table[i][j] = res > 255 ? 255 : res < 0 ? 0 : res;
+			}
+		}
+		return hl;
+	}
+
+	constexpr auto hard_light = make_hard_light_lookup();
+
+	// Saturation Tone Inline: Changes a pixel saturation
+	inline void saturation_tone(uint32_t &src_pixel, int saturation, int rs, int gs, int bs, int as) {
+		// Algorithm from OpenPDN (MIT license)
+		// Transformation in Y'CbCr color space
+		uint8_t r = (src_pixel >> rs) & 0xFF;
+		uint8_t g = (src_pixel >> gs) & 0xFF;
+		uint8_t b = (src_pixel >> bs) & 0xFF;
+		uint8_t a = (src_pixel >> as) & 0xFF;
+
+		// Y' = 0.299 R' + 0.587 G' + 0.114 B'
+		uint8_t lum = (7471 * b + 38470 * g + 19595 * r) >> 16;
+
+		// Scale Cb/Cr by scale factor "sat"
+		int red = ((lum * 1024 + (r - lum) * saturation) >> 10);
+		red = red > 255 ? 255 : red < 0 ? 0 : red;
+		int green = ((lum * 1024 + (g - lum) * saturation) >> 10);
+		green = green > 255 ? 255 : green < 0 ? 0 : green;
+		int blue = ((lum * 1024 + (b - lum) * saturation) >> 10);
+		blue = blue > 255 ? 255 : blue < 0 ? 0 : blue;
+
+		src_pixel = ((uint32_t)red << rs) | ((uint32_t)green << gs) | ((uint32_t)blue << bs) | ((uint32_t)a << as);
+	}
+
+	// Color Tone Inline: Changes color of a pixel by hard light table
+	inline void color_tone(uint32_t &src_pixel, const PixelKernels::ToneParams& p) {
+		src_pixel = ((uint32_t)hard_light.table[p.red][(src_pixel >> p.rs) & 0xFF] << p.rs)
+			| ((uint32_t)hard_light.table[p.green][(src_pixel >> p.gs) & 0xFF] << p.gs)
+			| ((uint32_t)hard_light.table[p.blue][(src_pixel >> p.bs) & 0xFF] << p.bs)
+			| ((uint32_t)((src_pixel >> p.as) & 0xFF) << p.as);
+	}
+
+	using ToneRowFn = void(*)(uint32_t*, int, const PixelKernels::ToneParams&);
+	using ScaleRowFn = void(*)(const uint32_t*, uint32_t*, int, int);
+	using Scale2xRowFn = void(*)(const uint32_t*, const uint32_t*, const uint32_t*, uint32_t*, uint32_t*, int);
+
+#ifdef EP_PIXEL_KERNELS_X86
+	bool CpuHasSSE2() {
+#if defined(__x86_64__) || defined(_M_X64)
+		return true;
+#elif defined(__GNUC__)
+		return __builtin_cpu_supports("sse2");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		return (info[3] & (1 << 26)) != 0;
+#endif
+	}
+
+	bool CpuHasAVX2() {
+#if defined(__GNUC__)
+		return __builtin_cpu_supports("avx2");
+#else
+		int info[4];
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+			return false;
+		}
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#endif
+	}
+#endif
+
+	ToneRowFn GetToneRow(PixelKernels::Isa isa) {
+		using PixelKernels::Isa;
+		switch (isa) {
+#ifdef EP_PIXEL_KERNELS_X86
+			case Isa::SSE2:
+				return PixelKernels::detail::ToneRowSSE2;
+			case Isa::AVX2:
+				return PixelKernels::detail::ToneRowAVX2;
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+			case Isa::NEON:
+				return PixelKernels::detail::ToneRowNEON;
+#endif
+			default:
+				return PixelKernels::detail::ToneRowScalar;
+		}
+	}
+
+	ScaleRowFn GetScaleRow(PixelKernels::Isa isa) {
+		using PixelKernels::Isa;
+		switch (isa) {
+#ifdef EP_PIXEL_KERNELS_X86
+			case Isa::SSE2:
+				return PixelKernels::detail::ScaleRowSSE2;
+			case Isa::AVX2:
+				return PixelKernels::detail::ScaleRowAVX2;
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+			case Isa::NEON:
+				return PixelKernels::detail::ScaleRowNEON;
+#endif
+			default:
+				return PixelKernels::detail::ScaleRowScalar;
+		}
+	}
+
+	Scale2xRowFn GetScale2xRow(PixelKernels::Isa isa) {
+		using PixelKernels::Isa;
+		switch (isa) {
+#ifdef EP_PIXEL_KERNELS_X86
+			case Isa::SSE2:
+				return PixelKernels::detail::Scale2xRowSSE2;
+			case Isa::AVX2:
+				return PixelKernels::detail::Scale2xRowAVX2;
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+			case Isa::NEON:
+				return PixelKernels::detail::Scale2xRowNEON;
+#endif
+			default:
+				return PixelKernels::detail::Scale2xRowScalar;
+		}
+	}
+
+	PixelKernels::Isa DetectIsa() {
+		using PixelKernels::Isa;
+		for (auto isa: { Isa::AVX2, Isa::SSE2, Isa::NEON }) {
+			if (PixelKernels::IsSupported(isa)) {
+				return isa;
+			}
+		}
+		return Isa::Scalar;
+	}
+
+	PixelKernels::Isa active_isa = DetectIsa();
+	ToneRowFn tone_row = GetToneRow(active_isa);
+	ScaleRowFn scale_row = GetScaleRow(active_isa);
+	Scale2xRowFn scale2x_row = GetScale2xRow(active_isa);
+}
+
+void PixelKernels::detail::ToneRowScalar(uint32_t* pixels, int count, const ToneParams& p) {
+	for (int i = 0; i < count; ++i) {
+		if (p.skip_transparent && ((pixels[i] >> p.as) & 0xFF) == 0) {
+			continue;
+		}
+		if (p.saturate) {
+			saturation_tone(pixels[i], p.saturation, p.rs, p.gs, p.bs, p.as);
+		}
+		if (p.color) {
+			color_tone(pixels[i], p);
+		}
+	}
+}
+
+void PixelKernels::detail::ScaleRowScalar(const uint32_t* src, uint32_t* dst, int count, int factor) {
+	for (int i = 0; i < count; ++i) {
+		const auto px = src[i];
+		for (int j = 0; j < factor; ++j) {
+			*dst++ = px;
+		}
+	}
+}
+
+void PixelKernels::detail::Scale2xSpanScalar(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count, int first, int last) {
+	for (int i = first; i < last; ++i) {
+		const auto b = above[i];
+		const auto d = src[i > 0 ? i - 1 : i];
+		const auto e = src[i];
+		const auto f = src[i + 1 < count ? i + 1 : i];
+		const auto h = below[i];
+
+		if (b != h && d != f) {
+			dst0[2 * i] = d == b ? d : e;
+			dst0[2 * i + 1] = b == f ? f : e;
+			dst1[2 * i] = d == h ? d : e;
+			dst1[2 * i + 1] = h == f ? f : e;
+		} else {
+			dst0[2 * i] = dst0[2 * i + 1] = e;
+			dst1[2 * i] = dst1[2 * i + 1] = e;
+		}
+	}
+}
+
+void PixelKernels::detail::Scale2xRowScalar(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count) {
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, 0, count);
+}
+
+void PixelKernels::ToneRow(uint32_t* pixels, int count, const ToneParams& params) {
+	tone_row(pixels, count, params);
+}
+
+void PixelKernels::ScaleRow(const uint32_t* src, uint32_t* dst, int count, int factor) {
+	scale_row(src, dst, count, factor);
+}
+
+void PixelKernels::Scale2xRow(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count) {
+	scale2x_row(above, src, below, dst0, dst1, count);
+}
+
+PixelKernels::Isa PixelKernels::GetIsa() {
+	return active_isa;
+}
+
+bool PixelKernels::SetIsa(Isa isa) {
+	if (!IsSupported(isa)) {
+		return false;
+	}
+	active_isa = isa;
+	tone_row = GetToneRow(isa);
+	scale_row = GetScaleRow(isa);
+	scale2x_row = GetScale2xRow(isa);
+	return true;
+}
+
+bool PixelKernels::IsSupported(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			return true;
+#ifdef EP_PIXEL_KERNELS_X86
+		case Isa::SSE2:
+			return CpuHasSSE2();
+		case Isa::AVX2:
+			return CpuHasAVX2();
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+		case Isa::NEON:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+const char* PixelKernels::GetIsaName(Isa isa) {
+	switch (isa) {
+		case Isa::Scalar:
+			return "Scalar";
+		case Isa::SSE2:
+			return "SSE2";
+		case Isa::AVX2:
+			return "AVX2";
+		case Isa::NEON:
+			return "NEON";
+	}
+	return "";
+}
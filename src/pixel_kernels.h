@@ -0,0 +1,147 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PIXEL_KERNELS_H
+#define EP_PIXEL_KERNELS_H
+
+// Headers
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  define EP_PIXEL_KERNELS_X86
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define EP_PIXEL_KERNELS_NEON
+#endif
+
+/**
+ * Per pixel loops of the Bitmap effects and of the display scaling.
+ *
+ * Every kernel has a scalar implementation and, depending on the CPU,
+ * SSE2, AVX2 or NEON implementations which give exactly the same results.
+ * The fastest implementation supported by the CPU is selected at startup.
+ */
+namespace PixelKernels {
+	/** Instruction set used by the kernels */
+	enum class Isa {
+		Scalar,
+		SSE2,
+		AVX2,
+		NEON
+	};
+
+	/** Arguments of ToneRow */
+	struct ToneParams {
+		/** Bit position of the color channels in a pixel */
+		int rs = 0;
+		int gs = 0;
+		int bs = 0;
+		int as = 0;
+		/** Change the saturation */
+		bool saturate = false;
+		/** Saturation factor, 1024 keeps the saturation */
+		int saturation = 1024;
+		/** Hard light the color channels */
+		bool color = false;
+		/** Hard light strength per channel, 128 keeps the channel */
+		uint8_t red = 128;
+		uint8_t green = 128;
+		uint8_t blue = 128;
+		/** Leave pixels with an alpha of 0 unchanged */
+		bool skip_transparent = false;
+	};
+
+	/**
+	 * Applies a tone to a row of 32 bit pixels in place:
+	 * first the saturation change, then the hard light color change.
+	 *
+	 * @param pixels row to change
+	 * @param count number of pixels
+	 * @param params tone to apply
+	 */
+	void ToneRow(uint32_t* pixels, int count, const ToneParams& params);
+
+	/**
+	 * Repeats every pixel of a row factor times.
+	 *
+	 * @param src source row
+	 * @param dst destination row of count * factor pixels
+	 * @param count number of source pixels
+	 * @param factor scale factor, at least 1
+	 */
+	void ScaleRow(const uint32_t* src, uint32_t* dst, int count, int factor);
+
+	/**
+	 * Scales a row to two rows of twice the width with the Scale2x
+	 * (AdvMAME2x) pixel art filter. Pixels outside of the image are
+	 * replaced by the nearest pixel in the image.
+	 *
+	 * @param above row above src, src itself for the first row
+	 * @param src source row
+	 * @param below row below src, src itself for the last row
+	 * @param dst0 first destination row of 2 * count pixels
+	 * @param dst1 second destination row of 2 * count pixels
+	 * @param count number of source pixels
+	 */
+	void Scale2xRow(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count);
+
+	/** @return instruction set currently used */
+	Isa GetIsa();
+
+	/**
+	 * Changes the instruction set used. For benchmarks and tests.
+	 *
+	 * @param isa instruction set
+	 * @return false when the CPU does not support isa, the setting is not changed then
+	 */
+	bool SetIsa(Isa isa);
+
+	/**
+	 * @param isa instruction set
+	 * @return whether the CPU and the build support isa
+	 */
+	bool IsSupported(Isa isa);
+
+	/**
+	 * @param isa instruction set
+	 * @return name of the instruction set
+	 */
+	const char* GetIsaName(Isa isa);
+
+	namespace detail {
+		void ToneRowScalar(uint32_t* pixels, int count, const ToneParams& params);
+		void ScaleRowScalar(const uint32_t* src, uint32_t* dst, int count, int factor);
+		void Scale2xRowScalar(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count);
+
+		/** Scale2xRow of the pixels first to last - 1 of a row with count pixels, used for the edges of the SIMD versions */
+		void Scale2xSpanScalar(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count, int first, int last);
+#ifdef EP_PIXEL_KERNELS_X86
+		void ToneRowSSE2(uint32_t* pixels, int count, const ToneParams& params);
+		void ToneRowAVX2(uint32_t* pixels, int count, const ToneParams& params);
+		void ScaleRowSSE2(const uint32_t* src, uint32_t* dst, int count, int factor);
+		void ScaleRowAVX2(const uint32_t* src, uint32_t* dst, int count, int factor);
+		void Scale2xRowSSE2(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count);
+		void Scale2xRowAVX2(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count);
+#endif
+#ifdef EP_PIXEL_KERNELS_NEON
+		void ToneRowNEON(uint32_t* pixels, int count, const ToneParams& params);
+		void ScaleRowNEON(const uint32_t* src, uint32_t* dst, int count, int factor);
+		void Scale2xRowNEON(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count);
+#endif
+	}
+}
+
+#endif
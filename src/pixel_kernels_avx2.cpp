@@ -0,0 +1,193 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "pixel_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_X86
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#  pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#  pragma GCC push_options
+#  pragma GCC target("avx2")
+#endif
+
+// Same algorithm as pixel_kernels_sse2.cpp with 8 pixels per step.
+namespace {
+	inline __m256i Channel(__m256i px, __m128i shift) {
+		return _mm256_and_si256(_mm256_srl_epi32(px, shift), _mm256_set1_epi32(0xFF));
+	}
+
+	inline __m256i Clamp255(__m256i v) {
+		v = _mm256_andnot_si256(_mm256_srai_epi32(v, 31), v);
+		v = _mm256_or_si256(v, _mm256_cmpgt_epi32(v, _mm256_set1_epi32(255)));
+		return _mm256_and_si256(v, _mm256_set1_epi32(0xFF));
+	}
+
+	inline __m256i Saturate(__m256i c, __m256i lum10, __m256i lum, __m256i sat) {
+		// (lum * 1024 + (c - lum) * sat) >> 10, c - lum fits into 16 bit
+		auto v = _mm256_add_epi32(lum10, _mm256_madd_epi16(_mm256_sub_epi32(c, lum), sat));
+		return Clamp255(_mm256_srai_epi32(v, 10));
+	}
+
+	struct HardLight {
+		__m256i factor;
+		__m256i invert;
+
+		explicit HardLight(int tone) {
+			// tone <= 128: 2 * tone * c / 255
+			// tone > 128: 255 - 2 * (255 - tone) * (255 - c) / 255
+			factor = _mm256_set1_epi32(tone <= 128 ? 2 * tone : 2 * (255 - tone));
+			invert = _mm256_set1_epi32(tone <= 128 ? 0 : 0xFF);
+		}
+
+		__m256i Apply(__m256i c) const {
+			auto t = _mm256_mullo_epi16(_mm256_xor_si256(c, invert), factor);
+			// t / 255 for t < 65536, a tone of 128 can give 256
+			auto q = _mm256_srli_epi16(_mm256_mulhi_epu16(t, _mm256_set1_epi32(0x8081)), 7);
+			q = _mm256_min_epi16(q, _mm256_set1_epi32(0xFF));
+			return _mm256_xor_si256(q, invert);
+		}
+	};
+}
+
+void PixelKernels::detail::ToneRowAVX2(uint32_t* pixels, int count, const ToneParams& p) {
+	const auto rs = _mm_cvtsi32_si128(p.rs);
+	const auto gs = _mm_cvtsi32_si128(p.gs);
+	const auto bs = _mm_cvtsi32_si128(p.bs);
+	const auto as = _mm_cvtsi32_si128(p.as);
+
+	// Y' = (7471 B' + 38470 G' + 19595 R') >> 16, the G' factor is split to fit into 16 bit
+	const auto lum_bg = _mm256_set1_epi32(7471 | (19235 << 16));
+	const auto lum_rg = _mm256_set1_epi32(19595 | (19235 << 16));
+	const auto sat = _mm256_set1_epi32(p.saturation);
+
+	const HardLight red(p.red);
+	const HardLight green(p.green);
+	const HardLight blue(p.blue);
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		auto* ptr = reinterpret_cast<__m256i*>(pixels + i);
+		const auto px = _mm256_loadu_si256(ptr);
+
+		auto r = Channel(px, rs);
+		auto g = Channel(px, gs);
+		auto b = Channel(px, bs);
+		auto a = Channel(px, as);
+
+		if (p.saturate) {
+			auto g16 = _mm256_slli_epi32(g, 16);
+			auto lum = _mm256_add_epi32(
+					_mm256_madd_epi16(_mm256_or_si256(b, g16), lum_bg),
+					_mm256_madd_epi16(_mm256_or_si256(r, g16), lum_rg));
+			lum = _mm256_srli_epi32(lum, 16);
+			auto lum10 = _mm256_slli_epi32(lum, 10);
+
+			r = Saturate(r, lum10, lum, sat);
+			g = Saturate(g, lum10, lum, sat);
+			b = Saturate(b, lum10, lum, sat);
+		}
+
+		if (p.color) {
+			r = red.Apply(r);
+			g = green.Apply(g);
+			b = blue.Apply(b);
+		}
+
+		auto out = _mm256_or_si256(
+				_mm256_or_si256(_mm256_sll_epi32(r, rs), _mm256_sll_epi32(g, gs)),
+				_mm256_or_si256(_mm256_sll_epi32(b, bs), _mm256_sll_epi32(a, as)));
+
+		if (p.skip_transparent) {
+			auto keep = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+			out = _mm256_or_si256(_mm256_and_si256(keep, px), _mm256_andnot_si256(keep, out));
+		}
+
+		_mm256_storeu_si256(ptr, out);
+	}
+
+	ToneRowScalar(pixels + i, count - i, p);
+}
+
+void PixelKernels::detail::ScaleRowAVX2(const uint32_t* src, uint32_t* dst, int count, int factor) {
+	if (factor != 2) {
+		ScaleRowSSE2(src, dst, count, factor);
+		return;
+	}
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8) {
+		const auto px = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		// unpack works on the 128 bit halves, permute restores the pixel order
+		const auto lo = _mm256_unpacklo_epi32(px, px);
+		const auto hi = _mm256_unpackhi_epi32(px, px);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+		dst += 16;
+	}
+
+	ScaleRowScalar(src + i, dst, count - i, factor);
+}
+
+namespace {
+	inline __m256i Select(__m256i mask, __m256i a, __m256i b) {
+		return _mm256_blendv_epi8(b, a, mask);
+	}
+
+	inline void StoreInterleaved(uint32_t* dst, __m256i a, __m256i b) {
+		const auto lo = _mm256_unpacklo_epi32(a, b);
+		const auto hi = _mm256_unpackhi_epi32(a, b);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), _mm256_permute2x128_si256(lo, hi, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+	}
+}
+
+void PixelKernels::detail::Scale2xRowAVX2(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count) {
+	int i = 1;
+	for (; i + 9 <= count; i += 8) {
+		const auto b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + i));
+		const auto d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i - 1));
+		const auto e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		const auto f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 1));
+		const auto h = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(below + i));
+
+		const auto edge = _mm256_or_si256(_mm256_cmpeq_epi32(b, h), _mm256_cmpeq_epi32(d, f));
+
+		const auto e0 = Select(_mm256_andnot_si256(edge, _mm256_cmpeq_epi32(d, b)), d, e);
+		const auto e1 = Select(_mm256_andnot_si256(edge, _mm256_cmpeq_epi32(b, f)), f, e);
+		const auto e2 = Select(_mm256_andnot_si256(edge, _mm256_cmpeq_epi32(d, h)), d, e);
+		const auto e3 = Select(_mm256_andnot_si256(edge, _mm256_cmpeq_epi32(h, f)), f, e);
+
+		StoreInterleaved(dst0 + 2 * i, e0, e1);
+		StoreInterleaved(dst1 + 2 * i, e2, e3);
+	}
+
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, 0, count < 1 ? count : 1);
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, i, count);
+}
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(__GNUC__)
+#  pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,170 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "pixel_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_NEON
+
+#include <arm_neon.h>
+
+// Same algorithm as pixel_kernels_sse2.cpp, NEON has 32 bit multiplications.
+namespace {
+	inline uint32x4_t Channel(uint32x4_t px, int32x4_t shift_right) {
+		return vandq_u32(vshlq_u32(px, shift_right), vdupq_n_u32(0xFF));
+	}
+
+	inline uint32x4_t Saturate(uint32x4_t c, int32x4_t lum, int32_t sat) {
+		// (lum * 1024 + (c - lum) * sat) >> 10
+		auto v = vaddq_s32(vshlq_n_s32(lum, 10), vmulq_n_s32(vsubq_s32(vreinterpretq_s32_u32(c), lum), sat));
+		v = vshrq_n_s32(v, 10);
+		v = vminq_s32(vmaxq_s32(v, vdupq_n_s32(0)), vdupq_n_s32(255));
+		return vreinterpretq_u32_s32(v);
+	}
+
+	struct HardLight {
+		uint32x4_t factor;
+		uint32x4_t invert;
+
+		explicit HardLight(int tone) {
+			// tone <= 128: 2 * tone * c / 255
+			// tone > 128: 255 - 2 * (255 - tone) * (255 - c) / 255
+			factor = vdupq_n_u32(tone <= 128 ? 2 * tone : 2 * (255 - tone));
+			invert = vdupq_n_u32(tone <= 128 ? 0 : 0xFF);
+		}
+
+		uint32x4_t Apply(uint32x4_t c) const {
+			auto t = vmulq_u32(veorq_u32(c, invert), factor);
+			// t / 255 for t < 65536, a tone of 128 can give 256
+			auto q = vshrq_n_u32(vmulq_n_u32(t, 0x8081), 23);
+			q = vminq_u32(q, vdupq_n_u32(0xFF));
+			return veorq_u32(q, invert);
+		}
+	};
+}
+
+void PixelKernels::detail::ToneRowNEON(uint32_t* pixels, int count, const ToneParams& p) {
+	const auto rs = vdupq_n_s32(p.rs);
+	const auto gs = vdupq_n_s32(p.gs);
+	const auto bs = vdupq_n_s32(p.bs);
+	const auto as = vdupq_n_s32(p.as);
+	const auto rs_right = vnegq_s32(rs);
+	const auto gs_right = vnegq_s32(gs);
+	const auto bs_right = vnegq_s32(bs);
+	const auto as_right = vnegq_s32(as);
+
+	const HardLight red(p.red);
+	const HardLight green(p.green);
+	const HardLight blue(p.blue);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const auto px = vld1q_u32(pixels + i);
+
+		auto r = Channel(px, rs_right);
+		auto g = Channel(px, gs_right);
+		auto b = Channel(px, bs_right);
+		auto a = Channel(px, as_right);
+
+		if (p.saturate) {
+			// Y' = (7471 B' + 38470 G' + 19595 R') >> 16
+			auto lum = vmulq_n_u32(b, 7471);
+			lum = vmlaq_n_u32(lum, g, 38470);
+			lum = vmlaq_n_u32(lum, r, 19595);
+			auto lum_s = vreinterpretq_s32_u32(vshrq_n_u32(lum, 16));
+
+			r = Saturate(r, lum_s, p.saturation);
+			g = Saturate(g, lum_s, p.saturation);
+			b = Saturate(b, lum_s, p.saturation);
+		}
+
+		if (p.color) {
+			r = red.Apply(r);
+			g = green.Apply(g);
+			b = blue.Apply(b);
+		}
+
+		auto out = vorrq_u32(
+				vorrq_u32(vshlq_u32(r, rs), vshlq_u32(g, gs)),
+				vorrq_u32(vshlq_u32(b, bs), vshlq_u32(a, as)));
+
+		if (p.skip_transparent) {
+			auto keep = vceqq_u32(a, vdupq_n_u32(0));
+			out = vbslq_u32(keep, px, out);
+		}
+
+		vst1q_u32(pixels + i, out);
+	}
+
+	ToneRowScalar(pixels + i, count - i, p);
+}
+
+void PixelKernels::detail::ScaleRowNEON(const uint32_t* src, uint32_t* dst, int count, int factor) {
+	int i = 0;
+	if (factor == 2) {
+		for (; i + 4 <= count; i += 4) {
+			const auto px = vld1q_u32(src + i);
+			uint32x4x2_t out = {{ px, px }};
+			vst2q_u32(dst, out);
+			dst += 8;
+		}
+	} else if (factor >= 4) {
+		for (; i < count; ++i) {
+			const auto px = vdupq_n_u32(src[i]);
+			int j = 0;
+			for (; j + 4 <= factor; j += 4) {
+				vst1q_u32(dst + j, px);
+			}
+			for (; j < factor; ++j) {
+				dst[j] = src[i];
+			}
+			dst += factor;
+		}
+	}
+
+	ScaleRowScalar(src + i, dst, count - i, factor);
+}
+
+void PixelKernels::detail::Scale2xRowNEON(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count) {
+	int i = 1;
+	for (; i + 5 <= count; i += 4) {
+		const auto b = vld1q_u32(above + i);
+		const auto d = vld1q_u32(src + i - 1);
+		const auto e = vld1q_u32(src + i);
+		const auto f = vld1q_u32(src + i + 1);
+		const auto h = vld1q_u32(below + i);
+
+		const auto edge = vorrq_u32(vceqq_u32(b, h), vceqq_u32(d, f));
+
+		uint32x4x2_t out0 = {{
+			vbslq_u32(vbicq_u32(vceqq_u32(d, b), edge), d, e),
+			vbslq_u32(vbicq_u32(vceqq_u32(b, f), edge), f, e)
+		}};
+		uint32x4x2_t out1 = {{
+			vbslq_u32(vbicq_u32(vceqq_u32(d, h), edge), d, e),
+			vbslq_u32(vbicq_u32(vceqq_u32(h, f), edge), f, e)
+		}};
+
+		vst2q_u32(dst0 + 2 * i, out0);
+		vst2q_u32(dst1 + 2 * i, out1);
+	}
+
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, 0, count < 1 ? count : 1);
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, i, count);
+}
+
+#endif
@@ -0,0 +1,196 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Headers
+#include "pixel_kernels.h"
+
+#ifdef EP_PIXEL_KERNELS_X86
+
+#include <emmintrin.h>
+
+#if defined(__clang__)
+#  pragma clang attribute push(__attribute__((target("sse2"))), apply_to = function)
+#elif defined(__GNUC__)
+#  pragma GCC push_options
+#  pragma GCC target("sse2")
+#endif
+
+// All values are kept in 32 bit lanes below 65536, which allows using the
+// 16 bit multiplications of SSE2. See pixel_kernels_avx2.cpp for the same code with 8 lanes.
+namespace {
+	inline __m128i Channel(__m128i px, __m128i shift) {
+		return _mm_and_si128(_mm_srl_epi32(px, shift), _mm_set1_epi32(0xFF));
+	}
+
+	inline __m128i Clamp255(__m128i v) {
+		v = _mm_andnot_si128(_mm_srai_epi32(v, 31), v);
+		v = _mm_or_si128(v, _mm_cmpgt_epi32(v, _mm_set1_epi32(255)));
+		return _mm_and_si128(v, _mm_set1_epi32(0xFF));
+	}
+
+	inline __m128i Saturate(__m128i c, __m128i lum10, __m128i lum, __m128i sat) {
+		// (lum * 1024 + (c - lum) * sat) >> 10, c - lum fits into 16 bit
+		auto v = _mm_add_epi32(lum10, _mm_madd_epi16(_mm_sub_epi32(c, lum), sat));
+		return Clamp255(_mm_srai_epi32(v, 10));
+	}
+
+	struct HardLight {
+		__m128i factor;
+		__m128i invert;
+
+		explicit HardLight(int tone) {
+			// tone <= 128: 2 * tone * c / 255
+			// tone > 128: 255 - 2 * (255 - tone) * (255 - c) / 255
+			factor = _mm_set1_epi32(tone <= 128 ? 2 * tone : 2 * (255 - tone));
+			invert = _mm_set1_epi32(tone <= 128 ? 0 : 0xFF);
+		}
+
+		__m128i Apply(__m128i c) const {
+			auto t = _mm_mullo_epi16(_mm_xor_si128(c, invert), factor);
+			// t / 255 for t < 65536, a tone of 128 can give 256
+			auto q = _mm_srli_epi16(_mm_mulhi_epu16(t, _mm_set1_epi32(0x8081)), 7);
+			q = _mm_min_epi16(q, _mm_set1_epi32(0xFF));
+			return _mm_xor_si128(q, invert);
+		}
+	};
+}
+
+void PixelKernels::detail::ToneRowSSE2(uint32_t* pixels, int count, const ToneParams& p) {
+	const auto rs = _mm_cvtsi32_si128(p.rs);
+	const auto gs = _mm_cvtsi32_si128(p.gs);
+	const auto bs = _mm_cvtsi32_si128(p.bs);
+	const auto as = _mm_cvtsi32_si128(p.as);
+
+	// Y' = (7471 B' + 38470 G' + 19595 R') >> 16, the G' factor is split to fit into 16 bit
+	const auto lum_bg = _mm_set1_epi32(7471 | (19235 << 16));
+	const auto lum_rg = _mm_set1_epi32(19595 | (19235 << 16));
+	const auto sat = _mm_set1_epi32(p.saturation);
+
+	const HardLight red(p.red);
+	const HardLight green(p.green);
+	const HardLight blue(p.blue);
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4) {
+		auto* ptr = reinterpret_cast<__m128i*>(pixels + i);
+		const auto px = _mm_loadu_si128(ptr);
+
+		auto r = Channel(px, rs);
+		auto g = Channel(px, gs);
+		auto b = Channel(px, bs);
+		auto a = Channel(px, as);
+
+		if (p.saturate) {
+			auto g16 = _mm_slli_epi32(g, 16);
+			auto lum = _mm_add_epi32(
+					_mm_madd_epi16(_mm_or_si128(b, g16), lum_bg),
+					_mm_madd_epi16(_mm_or_si128(r, g16), lum_rg));
+			lum = _mm_srli_epi32(lum, 16);
+			auto lum10 = _mm_slli_epi32(lum, 10);
+
+			r = Saturate(r, lum10, lum, sat);
+			g = Saturate(g, lum10, lum, sat);
+			b = Saturate(b, lum10, lum, sat);
+		}
+
+		if (p.color) {
+			r = red.Apply(r);
+			g = green.Apply(g);
+			b = blue.Apply(b);
+		}
+
+		auto out = _mm_or_si128(
+				_mm_or_si128(_mm_sll_epi32(r, rs), _mm_sll_epi32(g, gs)),
+				_mm_or_si128(_mm_sll_epi32(b, bs), _mm_sll_epi32(a, as)));
+
+		if (p.skip_transparent) {
+			auto keep = _mm_cmpeq_epi32(a, _mm_setzero_si128());
+			out = _mm_or_si128(_mm_and_si128(keep, px), _mm_andnot_si128(keep, out));
+		}
+
+		_mm_storeu_si128(ptr, out);
+	}
+
+	ToneRowScalar(pixels + i, count - i, p);
+}
+
+void PixelKernels::detail::ScaleRowSSE2(const uint32_t* src, uint32_t* dst, int count, int factor) {
+	int i = 0;
+	if (factor == 2) {
+		for (; i + 4 <= count; i += 4) {
+			const auto px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_unpacklo_epi32(px, px));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 4), _mm_unpackhi_epi32(px, px));
+			dst += 8;
+		}
+	} else if (factor >= 4) {
+		for (; i < count; ++i) {
+			const auto px = _mm_set1_epi32(static_cast<int>(src[i]));
+			int j = 0;
+			for (; j + 4 <= factor; j += 4) {
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + j), px);
+			}
+			for (; j < factor; ++j) {
+				dst[j] = src[i];
+			}
+			dst += factor;
+		}
+	}
+
+	ScaleRowScalar(src + i, dst, count - i, factor);
+}
+
+namespace {
+	inline __m128i Select(__m128i mask, __m128i a, __m128i b) {
+		return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+	}
+}
+
+void PixelKernels::detail::Scale2xRowSSE2(const uint32_t* above, const uint32_t* src, const uint32_t* below, uint32_t* dst0, uint32_t* dst1, int count) {
+	// The first and the last pixel miss a neighbour and are done by the scalar code
+	int i = 1;
+	for (; i + 5 <= count; i += 4) {
+		const auto b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(above + i));
+		const auto d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i - 1));
+		const auto e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		const auto f = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 1));
+		const auto h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(below + i));
+
+		const auto edge = _mm_or_si128(_mm_cmpeq_epi32(b, h), _mm_cmpeq_epi32(d, f));
+
+		const auto e0 = Select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(d, b)), d, e);
+		const auto e1 = Select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(b, f)), f, e);
+		const auto e2 = Select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(d, h)), d, e);
+		const auto e3 = Select(_mm_andnot_si128(edge, _mm_cmpeq_epi32(h, f)), f, e);
+
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst0 + 2 * i), _mm_unpacklo_epi32(e0, e1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst0 + 2 * i + 4), _mm_unpackhi_epi32(e0, e1));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst1 + 2 * i), _mm_unpacklo_epi32(e2, e3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst1 + 2 * i + 4), _mm_unpackhi_epi32(e2, e3));
+	}
+
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, 0, count < 1 ? count : 1);
+	Scale2xSpanScalar(above, src, below, dst0, dst1, count, i, count);
+}
+
+#if defined(__clang__)
+#  pragma clang attribute pop
+#elif defined(__GNUC__)
+#  pragma GCC pop_options
+#endif
+
+#endif
@@ -29,8 +29,22 @@ Plane::Plane() : Drawable(0)
 	DrawableMgr::Register(this);
 }
 
+bool Plane::UpdateDamage(const Bitmap& /* dst */, Rect& /* rect */) {
+	return !bitmap;
+}
+
 void Plane::Draw(Bitmap& dst) {
-	if (!bitmap) return;
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
+}
+
+Drawable::BandDraw Plane::PrepareBandDraw(Bitmap& dst) {
+	prepared_source.reset();
+
+	if (!bitmap) {
+		return BandDraw::Skip;
+	}
 
 	if (needs_refresh) {
 		needs_refresh = false;
@@ -76,7 +90,7 @@ void Plane::Draw(Bitmap& dst) {
 			bg_x + bg_width <= 0;
 		if (off_screen) {
 			// This probably won't happen...
-			return;
+			return BandDraw::Skip;
 		}
 
 		dst_rect.x = bg_x;
@@ -87,6 +101,14 @@ void Plane::Draw(Bitmap& dst) {
 	}
 	src_y += shake_y;
 
-	dst.TiledBlit(src_x, src_y, source->GetRect(), *source, dst_rect, 255);
+	prepared_source = std::move(source);
+	prepared_dst_rect = dst_rect;
+	prepared_src_x = src_x;
+	prepared_src_y = src_y;
+	return BandDraw::Ready;
+}
+
+void Plane::DrawBand(Bitmap& dst) const {
+	dst.TiledBlit(prepared_src_x, prepared_src_y, prepared_source->GetRect(), *prepared_source, prepared_dst_rect, 255);
 }
 
@@ -33,6 +33,13 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	/** The panorama follows the map scrolling, so it only reports when nothing is drawn */
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	BitmapRef const& GetBitmap() const;
 	void SetBitmap(BitmapRef const& bitmap);
 	int GetOx() const;
@@ -51,6 +58,12 @@ private:
 	int ox = 0;
 	int oy = 0;
 	bool needs_refresh = false;
+
+	/** Tiled blit done by DrawBand */
+	BitmapRef prepared_source;
+	Rect prepared_dst_rect;
+	int prepared_src_x = 0;
+	int prepared_src_y = 0;
 };
 
 inline BitmapRef const& Plane::GetBitmap() const {
@@ -42,14 +42,17 @@
 #  include <switch.h>
 #endif
 
+#include "async_decoder.h"
 #include "async_handler.h"
 #include "audio.h"
+#include "audio_secache.h"
 #include "cache.h"
 #include "rand.h"
 #include "cmdline_parser.h"
 #include "dynrpg.h"
 #include "filefinder.h"
 #include "filefinder_rtp.h"
+#include "frame_stats.h"
 #include "fileext_guesser.h"
 #include "game_actors.h"
 #include "game_battle.h"
@@ -66,6 +69,7 @@
 #include "game_variables.h"
 #include "game_targets.h"
 #include "graphics.h"
+#include "headless_ui.h"
 #include <lcf/inireader.h>
 #include "input.h"
 #include <lcf/ldb/reader.h>
@@ -85,10 +89,13 @@
 #include "scene_title.h"
 #include "instrumentation.h"
 #include "transition.h"
+#include "tilemap_layer.h"
+#include "draw_workers.h"
 #include <lcf/scope_guard.h>
 #include "baseui.h"
 #include "game_clock.h"
 #include "chat_multiplayer.h"
+#include "game_multiplayer.h"
 
 #ifndef EMSCRIPTEN
 // This is not used on Emscripten.
@@ -124,6 +131,11 @@ namespace Player {
 	int frames;
 	std::string replay_input_path;
 	std::string record_input_path;
+	bool headless_flag;
+	std::string frame_timing_path;
+	std::string profile_path;
+	bool show_profiler_flag;
+	int bench_frames;
 	std::string command_line;
 	int speed_modifier = 3;
 	int speed_modifier_plus = 10;
@@ -143,6 +155,10 @@ namespace {
 	FileRequestBinding system_request_id;
 	FileRequestBinding save_request_id;
 	FileRequestBinding map_request_id;
+
+	// Update and draw times of --bench-frames
+	std::unique_ptr<FrameStats> frame_stats;
+	int bench_frame_count = 0;
 }
 
 void Player::Init(int argc, char *argv[]) {
@@ -204,10 +220,36 @@ void Player::Init(int argc, char *argv[]) {
 
 	auto cfg = ParseCommandLine(argc, argv);
 
+	if (bench_frames > 0) {
+		frame_stats = std::make_unique<FrameStats>();
+		bench_frame_count = 0;
+	}
+
+	if (show_profiler_flag || !profile_path.empty()) {
+		// Before any other thread is started
+		Instrumentation::EnableProfiler(!profile_path.empty());
+		Instrumentation::SetThreadName("Main");
+	}
+
+	Cache::SetBitmapLimit(static_cast<size_t>(cfg.video.cache_size.Get()) * 1024 * 1024);
+	TilemapLayer::SetToneCacheLimit(static_cast<size_t>(cfg.video.tone_cache_size.Get()) * 1024 * 1024);
+	AudioSeCache::SetLimit(static_cast<size_t>(cfg.audio.se_cache_size.Get()) * 1024 * 1024);
+	DrawWorkers::SetThreadCount(cfg.video.render_threads.Get());
+
 	Main_Data::Init();
 
 	DisplayUi.reset();
 
+	if (headless_flag) {
+		// Nobody can press a key to dismiss error messages
+		Output::IgnorePause(true);
+		#if defined(INGAME_CHAT)
+			DisplayUi = std::make_shared<HeadlessUi>(TOTAL_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video, frame_timing_path);
+		#else
+			DisplayUi = std::make_shared<HeadlessUi>(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video, frame_timing_path);
+		#endif
+	}
+
 	if(! DisplayUi) {
 		#if defined(INGAME_CHAT)
 			DisplayUi = BaseUi::CreateUi(TOTAL_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, cfg.video);
@@ -253,10 +295,19 @@ void Player::Run() {
 void Player::MainLoop() {
 	Instrumentation::FrameScope iframe;
 
-	const auto frame_time = Game_Clock::now();
+	auto frame_time = Game_Clock::now();
+	if (DisplayUi->IsTimeStepFixed()) {
+		// Advance the game by one time step, no matter how long the frame took
+		frame_time = Game_Clock::GetFrameTime() + Game_Clock::GetTargetGameTimeStep();
+	}
 	Game_Clock::OnNextFrame(frame_time);
 
+	const auto update_begin = Game_Clock::now();
+	const char* update_scene = Scene::scene_names[Scene::instance->type];
+
 	Player::UpdateInput();
+	Game_Multiplayer::Poll();
+	Cache::UpdateAsyncDecodes();
 
 	int num_updates = 0;
 	while (Game_Clock::NextGameTimeStep()) {
@@ -269,12 +320,23 @@ void Player::MainLoop() {
 
 		++num_updates;
 	}
+	Game_Multiplayer::Flush();
 	if (num_updates == 0) {
 		// If no logical frames ran, we need to update the system keys only.
 		Input::UpdateSystem();
 	}
 
-	Player::Draw();
+	const auto draw_begin = Game_Clock::now();
+	bool presented = Player::Draw();
+
+	if (frame_stats && bench_frame_count < bench_frames) {
+		frame_stats->AddUpdate(update_scene, draw_begin - update_begin);
+		frame_stats->AddDraw(Scene::scene_names[Scene::instance->type], Game_Clock::now() - draw_begin);
+
+		if (++bench_frame_count == bench_frames) {
+			exit_flag = true;
+		}
+	}
 
 	Scene::old_instances.clear();
 
@@ -284,6 +346,10 @@ void Player::MainLoop() {
 	}
 
 	auto frame_limit = DisplayUi->GetFrameLimit();
+	if (!presented && DisplayUi->IsFrameRateSynchronized()) {
+		// No vsync wait happened, so limit the frame rate ourselves
+		frame_limit = Game_Clock::GetTargetGameTimeStep();
+	}
 	if (frame_limit == Game_Clock::duration()) {
 #ifdef EMSCRIPTEN
 		emscripten_sleep(0);
@@ -347,6 +413,9 @@ void Player::UpdateInput() {
 }
 
 void Player::Update(bool update_scene) {
+	static Instrumentation::Zone zone("Player::Update");
+	Instrumentation::Scope scope(zone);
+
 	std::shared_ptr<Scene> old_instance = Scene::instance;
 
 	if (exit_flag) {
@@ -405,10 +474,16 @@ void Player::Update(bool update_scene) {
 	}
 }
 
-void Player::Draw() {
+bool Player::Draw() {
+	static Instrumentation::Zone zone("Player::Draw");
+	Instrumentation::Scope scope(zone);
+
 	Graphics::Update();
-	Graphics::Draw(*DisplayUi->GetDisplaySurface());
-	DisplayUi->UpdateDisplay();
+	if (!Graphics::Draw(*DisplayUi->GetDisplaySurface())) {
+		// A frame which is still post-processed is shown now
+		return DisplayUi->FlushDisplay();
+	}
+	return DisplayUi->QueueDisplay();
 }
 
 void Player::IncFrame() {
@@ -432,6 +507,27 @@ void Player::Exit() {
 	DisplayUi->UpdateDisplay();
 #endif
 
+	if (frame_stats) {
+		if (bench_frame_count < bench_frames) {
+			Output::Warning("Benchmark ended after {} of {} frames", bench_frame_count, bench_frames);
+		}
+		Output::Info("Benchmark of {} frames:", bench_frame_count);
+		for (auto& line : frame_stats->GetReport()) {
+			Output::Info("{}", line);
+		}
+		frame_stats.reset();
+	}
+
+	if (!profile_path.empty()) {
+		auto os = FileFinder::Root().OpenOutputStream(profile_path, std::ios::out | std::ios::trunc);
+		if (os) {
+			Instrumentation::WriteTrace(os);
+		} else {
+			Output::Warning("Failed to open file for the profiler trace: {}", profile_path);
+		}
+	}
+
+	AsyncDecoder::Quit();
 	Player::ResetGameObjects();
 	Font::Dispose();
 	DynRpg::Reset();
@@ -470,6 +566,9 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 	start_map_id = -1;
 	no_rtp_flag = false;
 	no_audio_flag = false;
+	headless_flag = false;
+	show_profiler_flag = false;
+	bench_frames = 0;
 	is_easyrpg_project = false;
 	mouse_flag = false;
 	touch_flag = false;
@@ -649,6 +748,33 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 			}
 			continue;
 		}
+		if (cp.ParseNext(arg, 0, "--headless")) {
+			headless_flag = true;
+			no_audio_flag = true;
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--frame-timing")) {
+			if (arg.NumValues() > 0) {
+				frame_timing_path = arg.Value(0);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--profile")) {
+			if (arg.NumValues() > 0) {
+				profile_path = arg.Value(0);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 1, "--bench-frames")) {
+			if (arg.ParseValue(0, li_value)) {
+				bench_frames = std::max(0L, li_value);
+			}
+			continue;
+		}
+		if (cp.ParseNext(arg, 0, "--show-profiler")) {
+			show_profiler_flag = true;
+			continue;
+		}
 		if (cp.ParseNext(arg, 1, "--encoding")) {
 			if (arg.NumValues() > 0) {
 				forced_encoding = arg.Value(0);
@@ -702,6 +828,13 @@ Game_Config Player::ParseCommandLine(int argc, char *argv[]) {
 			}
 			continue;
 		}
+#else
+		if (cp.ParseNext(arg, 2, "--multiplayer-server")) {
+			if (arg.NumValues() > 1) {
+				Game_Multiplayer::SetServer(arg.Value(0), arg.Value(1));
+			}
+			continue;
+		}
 #endif
 		cp.SkipNext();
 	}
@@ -1325,6 +1458,11 @@ void Player::PrintUsage() {
 R"(EasyRPG Player - An open source interpreter for RPG Maker 2000/2003 games.
 Options:
       --battle-test N      Start a battle test with monster party N.
+      --bench-frames N     Exit after N frames and print the mean, median and
+                           99th percentile of the update and draw time of every
+                           scene. Use together with --headless and --replay-input.
+      --cache-size N       Memory limit of the image cache in MiB. Unused images
+                           are freed earlier when it is exceeded. The default is 10.
       --disable-audio      Disable audio (in case you prefer your own music).
       --disable-rtp        Disable support for the Runtime Package (RTP).
       --encoding N         Instead of auto detecting the encoding or using
@@ -1338,8 +1476,11 @@ Options:
                             rpg2k3     - RPG Maker 2003 engine (v1.00 - v1.04)
                             rpg2k3v105 - RPG Maker 2003 engine (v1.05 - v1.09a)
                             rpg2k3e    - RPG Maker 2003 (English release) engine
+      --frame-timing PATH  Write the duration of every frame to PATH.
+                           Only used together with --headless.
       --fullscreen         Start in fullscreen mode.
       --show-fps           Enable frames per second counter.
+      --show-profiler      Show the time spent per frame in the subsystems.
       --fps-render-window  Render the frames per second counter in windowed mode.
       --fps-limit          Set a custom frames per second limit. The default is 60 FPS.
                            Set to 0 to run with unlimited frames per second.
@@ -1348,20 +1489,39 @@ Options:
                            this option, vsync may not be supported on all platforms.
       --enable-mouse       Use mouse click for decision and scroll wheel for lists
       --enable-touch       Use one/two finger tap for decision/cancel
+      --headless           Run without window and audio as fast as possible.
+                           Every frame simulates one game step. Use together
+                           with --replay-input for repeatable runs.
       --hide-title         Hide the title background image and center the
                            command menu.
       --load-game-id N     Skip the title scene and load SaveN.lsd
                            (N is padded to two digits).
+      --multiplayer-server URL GAME
+                           Connect to the multiplayer server at URL (ws://)
+                           as game GAME. Not available in the web player.
       --new-game           Skip the title scene and start a new game directly.
+      --profile PATH       Profile the time spent in the subsystems and write
+                           a Chrome trace (chrome://tracing) to PATH on exit.
       --project-path PATH  Instead of using the working directory the game in
                            PATH is used.
       --record-input PATH  Record all button input to a log file at PATH.
+      --render-threads N   Number of threads drawing the frame. The default is 1,
+                           which draws everything on the main thread.
       --replay-input PATH  Replays button presses from an input log generated by
                            --record-input.
       --save-path PATH     Instead of storing save files in the game directory
                            they are stored in PATH. The directory must exist.
                            When using the game browser all games will share
                            the same save directory!
+      --scaling-filter F   Scale the screen in software before presenting it.
+                           Possible options:
+                            none    - Leave the scaling to the renderer (default)
+                            nearest - Nearest neighbour, keeps the aspect ratio
+                            integer - Largest integer factor that fits the window
+                            scale2x - Edge preserving 2x filter
+      --se-cache-size N    Memory limit of the decoded sound effects in MiB. Sound
+                           effects used by the events of a map are decoded when
+                           the map is loaded. The default is 8.
       --seed N             Seeds the random number generator with N.
       --start-map-id N     Overwrite the map used for new games and use.
                            MapN.lmu instead (N is padded to four digits).
@@ -1387,6 +1547,8 @@ Options:
                            with IDs A, B, C...
                            Incompatible with --load-game-id.
       --test-play          Enable TestPlay mode.
+      --tone-cache-size N  Memory limit of the toned map chipsets in MiB. They are
+                           kept to speed up repeated screen tints. The default is 8.
       --window             Start in window mode.
   -v, --version            Display program version and exit.
   -h, --help               Display this help and exit.
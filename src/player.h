@@ -95,8 +95,10 @@ namespace Player {
 
 	/**
 	 * Renders EasyRPG Player state to the screen
+	 *
+	 * @return false when no frame was presented
 	 */
-	void Draw();
+	bool Draw();
 
 	/**
 	 * Returns executed game frames since player start.
@@ -336,6 +338,21 @@ namespace Player {
 	/** Path to record input log to */
 	extern std::string record_input_path;
 
+	/** Runs without window and audio, see HeadlessUi */
+	extern bool headless_flag;
+
+	/** Path to write the frame times of a headless run to */
+	extern std::string frame_timing_path;
+
+	/** Path to write the profiler trace to on exit */
+	extern std::string profile_path;
+
+	/** Shows the profiler statistics on screen */
+	extern bool show_profiler_flag;
+
+	/** Number of frames to benchmark before exiting, 0 to run normally */
+	extern int bench_frames;
+
 	/** The concatenated command line */
 	extern std::string command_line;
 
@@ -0,0 +1,114 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "profiler_overlay.h"
+#include "instrumentation.h"
+#include "bitmap.h"
+#include "font.h"
+#include "drawable_mgr.h"
+
+using namespace std::chrono_literals;
+
+static constexpr auto refresh_frequency = 1s;
+
+/** More zones do not fit on the screen */
+static constexpr size_t max_lines = 12;
+
+ProfilerOverlay::ProfilerOverlay() :
+	Drawable(Priority_Overlay + 80, Drawable::Flags::Global)
+{
+	DrawableMgr::Register(this);
+}
+
+void ProfilerOverlay::Update() {
+	auto now = Game_Clock::GetFrameTime();
+	if (now - last_refresh_time < refresh_frequency) {
+		return;
+	}
+	last_refresh_time = now;
+
+	auto stats = Instrumentation::TakeZoneStats();
+
+	std::vector<std::string> lines;
+	for (auto& zone : stats) {
+		if (lines.size() == max_lines) {
+			break;
+		}
+		char buf[128];
+		snprintf(buf, sizeof(buf), "%6.2f ms %5.1fx %s", zone.ms_per_frame, zone.calls_per_frame, zone.name);
+		lines.emplace_back(buf);
+	}
+
+	if (lines != text) {
+		text = std::move(lines);
+		dirty = true;
+	}
+}
+
+void ProfilerOverlay::Refresh() {
+	int width = 0;
+	int line_height = 0;
+	for (auto& line : text) {
+		Rect line_rect = Font::Default()->GetSize(line);
+		width = std::max(width, line_rect.width + 1);
+		line_height = std::max(line_height, line_rect.height - 1);
+	}
+	int height = line_height * static_cast<int>(text.size());
+
+	if (!bitmap || bitmap->GetWidth() < width || bitmap->GetHeight() < height) {
+		bitmap = Bitmap::Create(std::max(width, bitmap ? bitmap->GetWidth() : 0), std::max(height, bitmap ? bitmap->GetHeight() : 0), true);
+	}
+	bitmap->Clear();
+	bitmap->FillRect(Rect(0, 0, width, height), Color(0, 0, 0, 128));
+	for (size_t i = 0; i < text.size(); ++i) {
+		bitmap->TextDraw(1, static_cast<int>(i) * line_height, Color(255, 255, 255, 255), text[i]);
+	}
+
+	rect = Rect(0, 0, width, height);
+
+	dirty = false;
+}
+
+bool ProfilerOverlay::UpdateDamage(const Bitmap& dst, Rect& damage_rect) {
+	if (text.empty()) {
+		return true;
+	}
+
+	if (dirty) {
+		Refresh();
+		SetDamaged();
+	}
+
+	// Bottom left corner, away from the FPS display
+	damage_rect = Rect(1, dst.GetHeight() - rect.height - 1, rect.width, rect.height);
+	return true;
+}
+
+void ProfilerOverlay::Draw(Bitmap& dst) {
+	if (text.empty()) {
+		return;
+	}
+
+	if (dirty) {
+		Refresh();
+	}
+
+	dst.Blit(1, dst.GetHeight() - rect.height - 1, *bitmap, rect, 255);
+}
@@ -0,0 +1,57 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_PROFILER_OVERLAY_H
+#define EP_PROFILER_OVERLAY_H
+
+#include <string>
+#include <vector>
+#include "drawable.h"
+#include "memory_management.h"
+#include "rect.h"
+#include "game_clock.h"
+
+/**
+ * ProfilerOverlay class.
+ * Shows the time per frame spent in the zones of the frame profiler.
+ */
+class ProfilerOverlay : public Drawable {
+public:
+	ProfilerOverlay();
+
+	void Draw(Bitmap& dst) override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
+	/**
+	 * Fetches new zone statistics once per second.
+	 */
+	void Update();
+
+private:
+	void Refresh();
+
+	BitmapRef bitmap;
+	Rect rect;
+	Game_Clock::time_point last_refresh_time;
+
+	std::vector<std::string> text;
+
+	bool dirty = true;
+};
+
+#endif
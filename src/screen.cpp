@@ -29,14 +29,39 @@ Screen::Screen() : Drawable(Priority_Screen)
 	DrawableMgr::Register(this);
 }
 
-void Screen::Draw(Bitmap& dst) {
+bool Screen::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
 	auto flash_color = Main_Data::game_screen->GetFlashColor();
+	if (flash_color != last_flash_color) {
+		last_flash_color = flash_color;
+		SetDamaged();
+	}
+
 	if (flash_color.alpha > 0) {
-		if (!flash) {
-			flash = Bitmap::Create(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, flash_color);
-		} else {
-			flash->Fill(flash_color);
-		}
-		dst.Blit(0, 0, *flash, flash->GetRect(), 255);
+		rect = Rect(0, 0, SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT);
+	}
+	return true;
+}
+
+void Screen::Draw(Bitmap& dst) {
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
 	}
 }
+
+Drawable::BandDraw Screen::PrepareBandDraw(Bitmap& /* dst */) {
+	auto flash_color = Main_Data::game_screen->GetFlashColor();
+	if (flash_color.alpha <= 0) {
+		return BandDraw::Skip;
+	}
+
+	if (!flash) {
+		flash = Bitmap::Create(SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT, flash_color);
+	} else {
+		flash->Fill(flash_color);
+	}
+	return BandDraw::Ready;
+}
+
+void Screen::DrawBand(Bitmap& dst) const {
+	dst.Blit(0, 0, *flash, flash->GetRect(), 255);
+}
@@ -38,8 +38,15 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 private:
 	BitmapRef flash;
+	Color last_flash_color;
 };
 
 #endif
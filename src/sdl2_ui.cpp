@@ -180,6 +180,9 @@ Sdl2Ui::Sdl2Ui(long width, long height, const Game_ConfigVideo& cfg) : BaseUi(cf
 }
 
 Sdl2Ui::~Sdl2Ui() {
+	if (sdl_scaled_texture) {
+		SDL_DestroyTexture(sdl_scaled_texture);
+	}
 	if (sdl_texture) {
 		SDL_DestroyTexture(sdl_texture);
 	}
@@ -344,6 +347,12 @@ bool Sdl2Ui::RefreshDisplayMode() {
 		SDL_RenderPresent(sdl_renderer);
 
 		SDL_RenderSetLogicalSize(sdl_renderer, current_display_mode.width, current_display_mode.height);
+#if SDL_VERSION_ATLEAST(2, 0, 5)
+		// The image is already scaled by a whole number, SDL must show it unscaled
+		if (display_scaler.GetFilter() == DisplayScaler::Filter::Integer) {
+			SDL_RenderSetIntegerScale(sdl_renderer, SDL_TRUE);
+		}
+#endif
 
 
 		sdl_texture = SDL_CreateTexture(sdl_renderer,
@@ -461,6 +470,12 @@ void Sdl2Ui::ProcessEvents() {
 }
 
 void Sdl2Ui::UpdateDisplay() {
+	if (UseDisplayScaler()) {
+		SubmitScaled();
+		PresentScaled(*display_scaler.Finish());
+		return;
+	}
+
 	// SDL_UpdateTexture was found to be faster than SDL_LockTexture / SDL_UnlockTexture.
 	SDL_UpdateTexture(sdl_texture, NULL, main_surface->pixels(), main_surface->pitch());
 	SDL_RenderClear(sdl_renderer);
@@ -468,6 +483,79 @@ void Sdl2Ui::UpdateDisplay() {
 	SDL_RenderPresent(sdl_renderer);
 }
 
+bool Sdl2Ui::QueueDisplay() {
+	if (!UseDisplayScaler() || !DisplayScaler::IsThreaded()) {
+		UpdateDisplay();
+		return true;
+	}
+
+	// The previous frame is shown while this one is scaled
+	SubmitScaled();
+	auto* frame = display_scaler.TakeReady();
+	if (!frame) {
+		return false;
+	}
+	PresentScaled(*frame);
+	return true;
+}
+
+bool Sdl2Ui::FlushDisplay() {
+	if (!UseDisplayScaler()) {
+		return false;
+	}
+
+	auto* frame = display_scaler.Finish();
+	if (!frame) {
+		return false;
+	}
+	PresentScaled(*frame);
+	return true;
+}
+
+bool Sdl2Ui::UseDisplayScaler() const {
+	return display_scaler.GetFilter() != DisplayScaler::Filter::None && main_surface->bpp() == 4;
+}
+
+void Sdl2Ui::SubmitScaled() {
+	int width, height;
+	if (SDL_GetRendererOutputSize(sdl_renderer, &width, &height) != 0) {
+		width = main_surface->width();
+		height = main_surface->height();
+	}
+	display_scaler.Submit(*main_surface, width, height);
+}
+
+void Sdl2Ui::PresentScaled(const Bitmap& frame) {
+	int w = 0, h = 0;
+	if (sdl_scaled_texture) {
+		SDL_QueryTexture(sdl_scaled_texture, nullptr, nullptr, &w, &h);
+	}
+
+	if (!sdl_scaled_texture || w != frame.width() || h != frame.height()) {
+		if (sdl_scaled_texture) {
+			SDL_DestroyTexture(sdl_scaled_texture);
+		}
+
+		uint32_t texture_format = GetDefaultFormat();
+		SDL_QueryTexture(sdl_texture, &texture_format, nullptr, nullptr, nullptr);
+		sdl_scaled_texture = SDL_CreateTexture(sdl_renderer,
+			texture_format,
+			SDL_TEXTUREACCESS_STREAMING,
+			frame.width(), frame.height());
+
+		if (!sdl_scaled_texture) {
+			Output::Warning("SDL_CreateTexture failed : {}. Disabling the scaling filter.", SDL_GetError());
+			display_scaler.SetFilter(DisplayScaler::Filter::None);
+			return;
+		}
+	}
+
+	SDL_UpdateTexture(sdl_scaled_texture, NULL, frame.pixels(), frame.pitch());
+	SDL_RenderClear(sdl_renderer);
+	SDL_RenderCopy(sdl_renderer, sdl_scaled_texture, NULL, NULL);
+	SDL_RenderPresent(sdl_renderer);
+}
+
 void Sdl2Ui::SetTitle(const std::string &title) {
 	SDL_SetWindowTitle(sdl_window, title.c_str());
 }
@@ -542,6 +630,10 @@ void Sdl2Ui::ProcessEvent(SDL_Event &evnt) {
 
 void Sdl2Ui::ProcessActiveEvent(SDL_Event &evnt) {
 	int state = evnt.window.event;
+	if (state == SDL_WINDOWEVENT_EXPOSED || state == SDL_WINDOWEVENT_SIZE_CHANGED) {
+		// Unchanged frames are not presented, make sure the window content is restored
+		Graphics::Invalidate();
+	}
 #if PAUSE_GAME_WHEN_FOCUS_LOST
 	if (state == SDL_WINDOWEVENT_FOCUS_LOST) {
 
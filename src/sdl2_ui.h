@@ -62,6 +62,8 @@ public:
 	void ToggleFullscreen() override;
 	void ToggleZoom() override;
 	void UpdateDisplay() override;
+	bool QueueDisplay() override;
+	bool FlushDisplay() override;
 	void SetTitle(const std::string &title) override;
 	bool ShowCursor(bool flag) override;
 	void ProcessEvents() override;
@@ -116,11 +118,26 @@ private:
 
 	void RequestVideoMode(int width, int height, int zoom, bool fullscreen, bool vsync);
 
+	/** @return whether main_surface is scaled by the display_scaler */
+	bool UseDisplayScaler() const;
+
+	/** Passes main_surface to the display_scaler */
+	void SubmitScaled();
+
+	/**
+	 * Shows an image scaled by the display_scaler.
+	 *
+	 * @param frame scaled image
+	 */
+	void PresentScaled(const Bitmap& frame);
+
 	/** Last display mode. */
 	DisplayMode last_display_mode;
 
 	/** Main SDL window. */
 	SDL_Texture* sdl_texture = nullptr;
+	/** Texture of the display_scaler images */
+	SDL_Texture* sdl_scaled_texture = nullptr;
 	SDL_Window* sdl_window = nullptr;
 	SDL_Renderer* sdl_renderer = nullptr;
 
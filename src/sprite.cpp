@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <cmath>
 #include <string>
 #include "sprite.h"
 #include "player.h"
@@ -32,18 +33,25 @@ Sprite::Sprite(Drawable::Flags flags) : Drawable(0, flags)
 
 // Draw
 void Sprite::Draw(Bitmap& dst) {
-	if (GetWidth() <= 0 || GetHeight() <= 0) return;
-
-	BlitScreen(dst);
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
 }
 
-void Sprite::BlitScreen(Bitmap& dst) {
-	if (!bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0))
-		return;
+Drawable::BandDraw Sprite::PrepareBandDraw(Bitmap& /* dst */) {
+	prepared_bitmap.reset();
+
+	if (GetWidth() <= 0 || GetHeight() <= 0) {
+		return BandDraw::Skip;
+	}
+
+	if (!bitmap || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0)) {
+		return BandDraw::Skip;
+	}
 
 	BitmapRef draw_bitmap = Refresh(src_rect_effect);
 	if (!draw_bitmap) {
-		return;
+		return BandDraw::Skip;
 	}
 
 	bitmap_changed = false;
@@ -56,7 +64,52 @@ void Sprite::BlitScreen(Bitmap& dst) {
 		rect.y %= bitmap_effects->GetHeight();
 	}
 
-	BlitScreenIntern(dst, *draw_bitmap, rect);
+	prepared_bitmap = std::move(draw_bitmap);
+	prepared_rect = rect;
+	return BandDraw::Ready;
+}
+
+void Sprite::DrawBand(Bitmap& dst) const {
+	BlitScreenIntern(dst, *prepared_bitmap, prepared_rect);
+}
+
+void Sprite::BlitScreen(Bitmap& dst) {
+	if (Sprite::PrepareBandDraw(dst) == BandDraw::Ready) {
+		Sprite::DrawBand(dst);
+	}
+}
+
+bool Sprite::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
+	if (!bitmap || GetWidth() <= 0 || GetHeight() <= 0 || (opacity_top_effect <= 0 && opacity_bottom_effect <= 0)) {
+		return true;
+	}
+
+	if (bitmap->GetRevision() != bitmap_revision) {
+		bitmap_revision = bitmap->GetRevision();
+		SetDamaged();
+	}
+
+	if (zoom_x_effect == 1.0 && zoom_y_effect == 1.0 && angle_effect == 0.0 && waver_effect_depth == 0) {
+		rect = Rect(x - ox, y - oy, GetWidth(), GetHeight());
+		return true;
+	}
+
+	// Conservative bounds covering every rotation around the origin
+	const double zoom_x = std::abs(zoom_x_effect);
+	const double zoom_y = std::abs(zoom_y_effect);
+	const double dx = std::max(ox, GetWidth() - ox) * zoom_x;
+	const double dy = std::max(oy, GetHeight() - oy) * zoom_y;
+	const int waver = static_cast<int>(std::ceil(2 * zoom_x * std::abs(waver_effect_depth)));
+
+	int rx, ry;
+	if (angle_effect == 0.0) {
+		rx = static_cast<int>(std::ceil(dx)) + 1;
+		ry = static_cast<int>(std::ceil(dy)) + 1;
+	} else {
+		rx = ry = static_cast<int>(std::ceil(std::hypot(dx, dy))) + 1;
+	}
+	rect = Rect(x - rx - waver, y - ry, 2 * (rx + waver), 2 * ry);
+	return true;
 }
 
 void Sprite::BlitScreenIntern(Bitmap& dst, Bitmap const& draw_bitmap, Rect const& src_rect) const
@@ -124,16 +177,19 @@ void Sprite::SetBitmap(BitmapRef const& nbitmap) {
 	src_rect_effect = src_rect;
 
 	bitmap_changed = true;
+	SetDamaged();
 }
 
 void Sprite::SetOpacity(int opacity_top, int opacity_bottom) {
 	if (opacity_top_effect != opacity_top) {
 		opacity_top_effect = opacity_top;
+		SetDamaged();
 	}
 	if (opacity_bottom == -1)
 		opacity_bottom = (opacity_top + 1) / 2;
 	if (opacity_bottom_effect != opacity_bottom) {
 		opacity_bottom_effect = opacity_bottom;
+		SetDamaged();
 	}
 }
 
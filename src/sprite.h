@@ -34,6 +34,12 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	virtual int GetWidth() const;
 	virtual int GetHeight() const;
 
@@ -102,6 +108,15 @@ public:
 	 */
 	void SetFlashEffect(const Color &color);
 
+protected:
+	/**
+	 * Draws the sprite with the current settings.
+	 * For subclasses which draw the sprite several times per frame.
+	 *
+	 * @param dst bitmap to draw onto
+	 */
+	void BlitScreen(Bitmap& dst);
+
 private:
 	BitmapRef bitmap;
 
@@ -136,8 +151,12 @@ private:
 	bool current_flip_x = false;
 	bool current_flip_y = false;
 	bool bitmap_changed = true;
+	uint32_t bitmap_revision = 0;
+
+	/** Bitmap and source rect drawn by DrawBand */
+	BitmapRef prepared_bitmap;
+	Rect prepared_rect;
 
-	void BlitScreen(Bitmap& dst);
 	void BlitScreenIntern(Bitmap& dst, Bitmap const& draw_bitmap,
 							Rect const& src_rect) const;
 	BitmapRef Refresh(Rect& rect);
@@ -160,7 +179,10 @@ inline Rect const& Sprite::GetSrcRect() const {
 }
 
 inline void Sprite::SetSrcRect(Rect const& nsrc_rect) {
-	src_rect = nsrc_rect;
+	if (src_rect != nsrc_rect) {
+		src_rect = nsrc_rect;
+		SetDamaged();
+	}
 }
 
 inline int Sprite::GetX() const {
@@ -168,7 +190,10 @@ inline int Sprite::GetX() const {
 }
 
 inline void Sprite::SetX(int nx) {
-	x = nx;
+	if (x != nx) {
+		x = nx;
+		SetDamaged();
+	}
 }
 
 inline int Sprite::GetY() const {
@@ -176,7 +201,10 @@ inline int Sprite::GetY() const {
 }
 
 inline void Sprite::SetY(int ny) {
-	y = ny;
+	if (y != ny) {
+		y = ny;
+		SetDamaged();
+	}
 }
 
 inline int Sprite::GetOx() const {
@@ -184,7 +212,10 @@ inline int Sprite::GetOx() const {
 }
 
 inline void Sprite::SetOx(int nox) {
-	ox = nox;
+	if (ox != nox) {
+		ox = nox;
+		SetDamaged();
+	}
 }
 
 inline int Sprite::GetOy() const {
@@ -192,7 +223,10 @@ inline int Sprite::GetOy() const {
 }
 
 inline void Sprite::SetOy(int noy) {
-	oy = noy;
+	if (oy != noy) {
+		oy = noy;
+		SetDamaged();
+	}
 }
 
 inline double Sprite::GetZoomX() const {
@@ -204,11 +238,17 @@ inline double Sprite::GetZoomY() const {
 }
 
 inline void Sprite::SetZoomX(double zoom_x) {
-	zoom_x_effect = zoom_x;
+	if (zoom_x_effect != zoom_x) {
+		zoom_x_effect = zoom_x;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetZoomY(double zoom_y) {
-	zoom_y_effect = zoom_y;
+	if (zoom_y_effect != zoom_y) {
+		zoom_y_effect = zoom_y;
+		SetDamaged();
+	}
 }
 
 inline double Sprite::GetAngle() const {
@@ -216,7 +256,10 @@ inline double Sprite::GetAngle() const {
 }
 
 inline void Sprite::SetAngle(double angle) {
-	angle_effect = angle;
+	if (angle_effect != angle) {
+		angle_effect = angle;
+		SetDamaged();
+	}
 }
 
 inline bool Sprite::GetFlipX() const {
@@ -240,7 +283,10 @@ inline int Sprite::GetBlendType() const {
 }
 
 inline void Sprite::SetBlendType(int blend_type) {
-	blend_type_effect = blend_type;
+	if (blend_type_effect != blend_type) {
+		blend_type_effect = blend_type;
+		SetDamaged();
+	}
 }
 
 inline Color Sprite::GetBlendColor() const {
@@ -248,7 +294,10 @@ inline Color Sprite::GetBlendColor() const {
 }
 
 inline void Sprite::SetBlendColor(Color blend_color) {
-	blend_color_effect = blend_color;
+	if (blend_color_effect != blend_color) {
+		blend_color_effect = blend_color;
+		SetDamaged();
+	}
 }
 
 inline Tone Sprite::GetTone() const {
@@ -256,7 +305,10 @@ inline Tone Sprite::GetTone() const {
 }
 
 inline void Sprite::SetTone(Tone tone) {
-	tone_effect = tone;
+	if (tone_effect != tone) {
+		tone_effect = tone;
+		SetDamaged();
+	}
 }
 
 inline int Sprite::GetWaverDepth() const {
@@ -268,31 +320,52 @@ inline double Sprite::GetWaverPhase() const {
 }
 
 inline void Sprite::SetWaverDepth(int depth) {
-	waver_effect_depth = depth;
+	if (waver_effect_depth != depth) {
+		waver_effect_depth = depth;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetWaverPhase(double phase) {
-	waver_effect_phase = phase;
+	if (waver_effect_phase != phase) {
+		waver_effect_phase = phase;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetSpriteRect(Rect const& nsprite_rect) {
-	src_rect_effect = nsprite_rect;
+	if (src_rect_effect != nsprite_rect) {
+		src_rect_effect = nsprite_rect;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetFlipX(bool flipx) {
-	flipx_effect = flipx;
+	if (flipx_effect != flipx) {
+		flipx_effect = flipx;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetFlipY(bool flipy) {
-	flipy_effect = flipy;
+	if (flipy_effect != flipy) {
+		flipy_effect = flipy;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetBushDepth(int bush_depth) {
-	bush_effect = bush_depth;
+	if (bush_effect != bush_depth) {
+		bush_effect = bush_depth;
+		SetDamaged();
+	}
 }
 
 inline void Sprite::SetFlashEffect(const Color &color) {
-	flash_effect = color;
+	if (flash_effect != color) {
+		flash_effect = color;
+		SetDamaged();
+	}
 }
 
 #endif
@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <algorithm>
 #include "battle_animation.h"
 #include "game_enemy.h"
 #include "sprite_actor.h"
@@ -288,11 +289,48 @@ void Sprite_Actor::Draw(Bitmap& dst) {
 		Sprite_Battler::SetX(it->x);
 		Sprite_Battler::SetY(it->y);
 		Sprite_Battler::SetOpacity(std::min(opacity, 255));
-		Sprite_Battler::Draw(dst);
+		BlitScreen(dst);
 		opacity += steps;
 	}
 }
 
+Drawable::BandDraw Sprite_Actor::PrepareBandDraw(Bitmap& /* dst */) {
+	return BandDraw::Unsupported;
+}
+
+bool Sprite_Actor::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	auto* battler = GetBattler();
+	if (battler->IsHidden() || do_not_draw) {
+		return true;
+	}
+
+	SetTone(Main_Data::game_screen->GetTone());
+	SetFlashEffect(battler->GetFlashColor());
+
+	// Same order as Draw, so the position stays the same when there are no afterimages
+	for (auto it = images.crbegin(); it != images.crend(); ++it) {
+		Sprite_Battler::SetX(it->x);
+		Sprite_Battler::SetY(it->y);
+
+		Rect image_rect;
+		Sprite_Battler::UpdateDamage(dst, image_rect);
+		if (image_rect.IsEmpty()) {
+			continue;
+		}
+		if (rect.IsEmpty()) {
+			rect = image_rect;
+			continue;
+		}
+		const int x1 = std::max(rect.x + rect.width, image_rect.x + image_rect.width);
+		const int y1 = std::max(rect.y + rect.height, image_rect.y + image_rect.height);
+		rect.x = std::min(rect.x, image_rect.x);
+		rect.y = std::min(rect.y, image_rect.y);
+		rect.width = x1 - rect.x;
+		rect.height = y1 - rect.y;
+	}
+	return true;
+}
+
 void Sprite_Actor::UpdatePosition() {
 	assert(!images.empty());
 	images.pop_back();
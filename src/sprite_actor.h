@@ -90,6 +90,12 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	/** The sprite is drawn several times per frame, which needs the serial path */
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	/** Reports the area of the actor and all afterimages */
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	Game_Actor* GetBattler() const;
 
 	void UpdatePosition();
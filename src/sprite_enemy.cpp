@@ -81,8 +81,21 @@ void Sprite_Enemy::OnMonsterSpriteReady(FileRequestResult* result) {
 	SetBitmap(graphic);
 }
 
-void Sprite_Enemy::Draw(Bitmap& dst) {
+bool Sprite_Enemy::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	if (!UpdateState()) {
+		return true;
+	}
+	return Sprite_Battler::UpdateDamage(dst, rect);
+}
+
+Drawable::BandDraw Sprite_Enemy::PrepareBandDraw(Bitmap& dst) {
+	if (!UpdateState()) {
+		return BandDraw::Skip;
+	}
+	return Sprite_Battler::PrepareBandDraw(dst);
+}
 
+bool Sprite_Enemy::UpdateState() {
 	auto alpha = 255;
 	auto zoom = 1.0;
 
@@ -93,11 +106,11 @@ void Sprite_Enemy::Draw(Bitmap& dst) {
 	const auto et = enemy->GetExplodeTimer();
 
 	if (!enemy->Exists() && dt == 0 && et == 0) {
-		return;
+		return false;
 	}
 
 	if (bt % 10 >= 5) {
-		return;
+		return false;
 	}
 
 	if (dt > 0) {
@@ -121,7 +134,7 @@ void Sprite_Enemy::Draw(Bitmap& dst) {
 	SetFlashEffect(enemy->GetFlashColor());
 	SetFlipX(enemy->IsDirectionFlipped());
 
-	Sprite_Battler::Draw(dst);
+	return true;
 }
 
 void Sprite_Enemy::Refresh() {
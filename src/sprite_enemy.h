@@ -40,7 +40,9 @@ public:
 
 	~Sprite_Enemy() override;
 
-	void Draw(Bitmap& dst) override;
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
 
 	Game_Enemy* GetBattler() const;
 
@@ -49,6 +51,14 @@ public:
 	void ResetZ() final;
 
 protected:
+	/**
+	 * Applies the blink, death and explode effects and the position of the
+	 * enemy to the sprite.
+	 *
+	 * @return false when the enemy is not shown this frame
+	 */
+	bool UpdateState();
+
 	void CreateSprite();
 	void OnMonsterSpriteReady(FileRequestResult* result);
 
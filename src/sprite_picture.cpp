@@ -63,20 +63,34 @@ void Sprite_Picture::OnPictureShow() {
 }
 
 
-void Sprite_Picture::Draw(Bitmap& dst) {
+bool Sprite_Picture::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	if (!UpdateState()) {
+		return true;
+	}
+	return Sprite::UpdateDamage(dst, rect);
+}
+
+Drawable::BandDraw Sprite_Picture::PrepareBandDraw(Bitmap& dst) {
+	if (!UpdateState()) {
+		return BandDraw::Skip;
+	}
+	return Sprite::PrepareBandDraw(dst);
+}
+
+bool Sprite_Picture::UpdateState() {
 	const auto& pic = Main_Data::game_pictures->GetPicture(pic_id);
 	const auto& data = pic.data;
 
 	auto& bitmap = GetBitmap();
 
 	if (!bitmap) {
-		return;
+		return false;
 	}
 
 	const bool is_battle = Game_Battle::IsBattleRunning();
 
 	if (is_battle ? !pic.IsOnBattle() : !pic.IsOnMap()) {
-		return;
+		return false;
 	}
 
 	// RPG Maker 2k3 1.12: Spritesheets
@@ -146,5 +160,5 @@ void Sprite_Picture::Draw(Bitmap& dst) {
 	SetFlipY((data.easyrpg_flip & lcf::rpg::SavePicture::EasyRpgFlip_y) == lcf::rpg::SavePicture::EasyRpgFlip_y);
 	SetBlendType(data.easyrpg_blend_mode);
 
-	Sprite::Draw(dst);
+	return true;
 }
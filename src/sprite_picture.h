@@ -34,11 +34,21 @@ public:
 	 */
 	Sprite_Picture(int pic_id, Drawable::Flags flags = Drawable::Flags::Default);
 
-	void Draw(Bitmap& dst) override;
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
 
 	void OnPictureShow();
 
 private:
+	/**
+	 * Applies the state of the picture (position, spritesheet frame, effects)
+	 * to the sprite.
+	 *
+	 * @return false when the picture is not shown
+	 */
+	bool UpdateState();
+
 	int last_spritesheet_frame = -1;
 	const int pic_id = 0;
 	const bool feature_spritesheet = false;
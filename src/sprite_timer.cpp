@@ -59,15 +59,29 @@ Sprite_Timer::Sprite_Timer(int which) :
 Sprite_Timer::~Sprite_Timer() {
 }
 
-void Sprite_Timer::Draw(Bitmap& dst) {
+bool Sprite_Timer::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	if (!UpdateState()) {
+		return true;
+	}
+	return Sprite::UpdateDamage(dst, rect);
+}
+
+Drawable::BandDraw Sprite_Timer::PrepareBandDraw(Bitmap& dst) {
+	if (!UpdateState()) {
+		return BandDraw::Skip;
+	}
+	return Sprite::PrepareBandDraw(dst);
+}
+
+bool Sprite_Timer::UpdateState() {
 	if (!Main_Data::game_party->GetTimerVisible(which, Game_Battle::IsBattleRunning())) {
-		return;
+		return false;
 	}
 
 	// RPG_RT never displays timers if there is no system graphic.
 	BitmapRef system = Cache::System();
 	if (!system) {
-		return;
+		return false;
 	}
 
 	const int all_secs = Main_Data::game_party->GetTimerSeconds(which);
@@ -96,17 +110,25 @@ void Sprite_Timer::Draw(Bitmap& dst) {
 		SetY(4);
 	}
 
+	const int frames = Main_Data::game_party->GetTimerFrames(which);
+	const bool colon = frames % DEFAULT_FPS >= DEFAULT_FPS / 2;
+
+	// Redrawing the bitmap damages the sprite, so only do it when the digits changed
+	const int time = all_secs * 2 + colon;
+	if (time == drawn_time && system == drawn_system) {
+		return true;
+	}
+	drawn_time = time;
+	drawn_system = system;
+
 	GetBitmap()->Clear();
 	for (int i = 0; i < 5; ++i) {
-		if (i == 2) { // :
-			int frames =  Main_Data::game_party->GetTimerFrames(which);
-			if (frames % DEFAULT_FPS < DEFAULT_FPS / 2) {
-				continue;
-			}
+		if (i == 2 && !colon) {
+			continue;
 		}
 		GetBitmap()->Blit(i * 8, 0, *system, digits[i], Opacity());
 	}
 
-	Sprite::Draw(dst);
+	return true;
 }
 
@@ -36,11 +36,24 @@ public:
 	~Sprite_Timer() override;
 
 protected:
-	void Draw(Bitmap& dst) override;
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
+	/**
+	 * Positions the timer and redraws the digits when the time changed.
+	 *
+	 * @return false when the timer is not shown
+	 */
+	bool UpdateState();
 
 	int which = 0;
 
 	Rect digits[5];
+
+	/** Seconds and colon state of the drawn digits, -1 when not drawn */
+	int drawn_time = -1;
+	BitmapRef drawn_system;
 };
 
 #endif
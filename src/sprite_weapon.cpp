@@ -130,9 +130,23 @@ void Sprite_Weapon::OnBattleWeaponReady(FileRequestResult* result, int32_t weapo
 	SetSrcRect(Rect((flip ? 128 : 0), weapon_index * 64, 64, 64));
 }
 
-void Sprite_Weapon::Draw(Bitmap& dst) {
+bool Sprite_Weapon::UpdateDamage(const Bitmap& dst, Rect& rect) {
+	if (!UpdateState()) {
+		return true;
+	}
+	return Sprite::UpdateDamage(dst, rect);
+}
+
+Drawable::BandDraw Sprite_Weapon::PrepareBandDraw(Bitmap& dst) {
+	if (!UpdateState()) {
+		return BandDraw::Skip;
+	}
+	return Sprite::PrepareBandDraw(dst);
+}
+
+bool Sprite_Weapon::UpdateState() {
 	if (!attacking) {
-		return;
+		return false;
 	}
 
 	SetTone(Main_Data::game_screen->GetTone());
@@ -142,5 +156,5 @@ void Sprite_Weapon::Draw(Bitmap& dst) {
 	}
 	SetFlashEffect(battler->GetFlashColor());
 
-	Sprite::Draw(dst);
+	return true;
 }
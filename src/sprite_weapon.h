@@ -51,9 +51,18 @@ public:
 
 	void StopAttack();
 
-	void Draw(Bitmap& dst) override;
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
 
 protected:
+	/**
+	 * Follows the battler and applies the screen tone and the flash.
+	 *
+	 * @return false when the weapon is not shown
+	 */
+	bool UpdateState();
+
 	void CreateSprite();
 	void OnBattleWeaponReady(FileRequestResult* result, int32_t weapon_index);
 
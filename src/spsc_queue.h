@@ -0,0 +1,100 @@
+/*
+ * This file is part of EasyRPG Player.
+ *
+ * EasyRPG Player is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * EasyRPG Player is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with EasyRPG Player. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EP_SPSC_QUEUE_H
+#define EP_SPSC_QUEUE_H
+
+// Headers
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * A bounded lock-free queue for exactly one producer thread and one
+ * consumer thread.
+ *
+ * Push and Pop never block and never allocate, which makes the queue safe
+ * to use from realtime threads such as an audio callback. Elements are
+ * moved in and out of preallocated slots.
+ *
+ * @tparam T element type, must be default constructible and move assignable
+ * @tparam N capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class SpscQueue {
+	static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+	/**
+	 * Appends an element. Must only be called from the producer thread.
+	 *
+	 * @param value element to move into the queue
+	 * @return false when the queue is full, value is not moved from then
+	 */
+	bool Push(T&& value);
+
+	/**
+	 * Removes the oldest element. Must only be called from the consumer thread.
+	 *
+	 * @param value receives the element
+	 * @return false when the queue is empty
+	 */
+	bool Pop(T& value);
+
+	/** @return whether the queue is empty, exact only on the consumer thread */
+	bool IsEmpty() const;
+
+	/** @return maximum number of elements */
+	static constexpr size_t Capacity() { return N; }
+
+private:
+	std::array<T, N> slots = {};
+	/** Next slot to write, only modified by the producer */
+	alignas(64) std::atomic<size_t> head = { 0 };
+	/** Next slot to read, only modified by the consumer */
+	alignas(64) std::atomic<size_t> tail = { 0 };
+};
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Push(T&& value) {
+	const size_t h = head.load(std::memory_order_relaxed);
+	if (h - tail.load(std::memory_order_acquire) == N) {
+		return false;
+	}
+	slots[h & (N - 1)] = std::move(value);
+	head.store(h + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::Pop(T& value) {
+	const size_t t = tail.load(std::memory_order_relaxed);
+	if (t == head.load(std::memory_order_acquire)) {
+		return false;
+	}
+	value = std::move(slots[t & (N - 1)]);
+	tail.store(t + 1, std::memory_order_release);
+	return true;
+}
+
+template <typename T, size_t N>
+inline bool SpscQueue<T, N>::IsEmpty() const {
+	return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+}
+
+#endif
@@ -16,6 +16,7 @@
  */
 
 // Headers
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 #include "tilemap_layer.h"
@@ -156,56 +157,300 @@ TilemapLayer::TilemapLayer(int ilayer) :
 // was created intentionally. Inlining the transparency check was measured and shown
 // to provide a performance improvement
 EP_ALWAYS_INLINE
-void TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit) {
+ImageOpacity TilemapLayer::DrawTile(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, bool allow_fast_blit) const {
+	// The tone does not change the alpha channel, so the opacity of the untoned tile is used
 	auto op = tileset.GetTileOpacity(col, row);
 	if (op != ImageOpacity::Transparent) {
-		DrawTileImpl(dst, tileset, tone_tileset, x, y, row, col, tone_hash, op, allow_fast_blit);
+		DrawTileImpl(dst, tone_tileset, x, y, row, col, op, allow_fast_blit);
 	}
+	return op;
 }
 
-void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tileset, Bitmap& tone_tileset, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit) {
-
+void TilemapLayer::DrawTileImpl(Bitmap& dst, Bitmap& tone_tileset, int x, int y, int row, int col, ImageOpacity op, bool allow_fast_blit) const {
 	auto rect = Rect{ col * TILE_SIZE, row * TILE_SIZE, TILE_SIZE, TILE_SIZE };
 
-	auto* src = &tileset;
+	bool use_fast_blit = fast_blit && allow_fast_blit;
+	if (op == ImageOpacity::Opaque || use_fast_blit) {
+		dst.BlitFast(x, y, tone_tileset, rect, 255);
+	} else {
+		dst.Blit(x, y, tone_tileset, rect, 255);
+	}
+}
+
+namespace {
+	/** Copy of a chipset or autotile bitmap with a tone applied */
+	struct ToneVariant {
+		std::weak_ptr<Bitmap> source;
+		const Bitmap* source_ptr = nullptr;
+		Tone tone;
+		BitmapRef bitmap;
+		uint32_t last_used = 0;
+	};
+
+	// Shared by all layers, the lower and upper layer use the same chipset
+	std::vector<ToneVariant> tone_variants;
+	size_t tone_variants_size = 0;
+	size_t tone_variants_limit = 8 * 1024 * 1024;
+	uint32_t tone_variants_counter = 0;
+
+	void PruneToneVariants() {
+		auto erase = [](std::vector<ToneVariant>::iterator it) {
+			tone_variants_size -= it->bitmap->GetSize();
+			return tone_variants.erase(it);
+		};
+
+		for (auto it = tone_variants.begin(); it != tone_variants.end();) {
+			it = it->source.expired() ? erase(it) : it + 1;
+		}
 
-	// Create tone changed tile
-	if (tone != Tone()) {
-		if (chipset_tone_tiles.insert(tone_hash).second) {
-			tone_tileset.ToneBlit(col * TILE_SIZE, row * TILE_SIZE, tileset, rect, tone, Opacity::Opaque());
+		while (tone_variants_size > tone_variants_limit) {
+			// Variants held by a layer, or just created for one, would only be duplicated on the next lookup
+			auto oldest = tone_variants.end();
+			for (auto it = tone_variants.begin(); it != tone_variants.end(); ++it) {
+				if (it->bitmap.use_count() == 1 && (oldest == tone_variants.end() || it->last_used < oldest->last_used)) {
+					oldest = it;
+				}
+			}
+			if (oldest == tone_variants.end()) {
+				break;
+			}
+			erase(oldest);
 		}
-		src = &tone_tileset;
 	}
 
-	bool use_fast_blit = fast_blit && allow_fast_blit;
-	if (op == ImageOpacity::Opaque || use_fast_blit) {
-		dst.BlitFast(x, y, *src, rect, 255);
+	BitmapRef GetToneVariant(const BitmapRef& source, const Tone& tone) {
+		if (!source || tone == Tone()) {
+			return source;
+		}
+
+		++tone_variants_counter;
+
+		for (auto& variant: tone_variants) {
+			if (variant.source_ptr == source.get() && variant.tone == tone && !variant.source.expired()) {
+				variant.last_used = tone_variants_counter;
+				return variant.bitmap;
+			}
+		}
+
+		ToneVariant variant;
+		variant.source = source;
+		variant.source_ptr = source.get();
+		variant.tone = tone;
+		variant.bitmap = Bitmap::Create(source->width(), source->height(), true);
+		variant.bitmap->ToneBlit(0, 0, *source, source->GetRect(), tone, Opacity::Opaque());
+		variant.last_used = tone_variants_counter;
+
+		// The reference held here keeps the new variant from being pruned
+		auto bitmap = variant.bitmap;
+		tone_variants_size += bitmap->GetSize();
+		tone_variants.push_back(std::move(variant));
+		PruneToneVariants();
+
+		return bitmap;
+	}
+
+	int QuantizeToneChannel(int value) {
+		constexpr int step = TilemapLayer::TONE_QUANTIZATION;
+		return std::min(255, (value + step / 2) / step * step);
+	}
+
+	Tone QuantizeTone(const Tone& tone) {
+		return Tone(QuantizeToneChannel(tone.red), QuantizeToneChannel(tone.green),
+				QuantizeToneChannel(tone.blue), QuantizeToneChannel(tone.gray));
+	}
+}
+
+void TilemapLayer::SetToneCacheLimit(size_t bytes) {
+	tone_variants_limit = bytes;
+	PruneToneVariants();
+}
+
+void TilemapLayer::UpdateToneVariants() {
+	chipset_toned = GetToneVariant(chipset, draw_tone);
+	autotiles_ab_screen_toned = GetToneVariant(autotiles_ab_screen, draw_tone);
+	autotiles_d_screen_toned = GetToneVariant(autotiles_d_screen, draw_tone);
+}
+
+int TilemapLayer::GetFrameCounter() const {
+	// FIXME: When Game_Map singleton is made an object we can remove this null check
+	return Main_Data::game_system ? Main_Data::game_system->GetFrameCounter() : 0;
+}
+
+void TilemapLayer::GetAnimationSteps(int& step_ab, int& step_c) const {
+	const auto frames = GetFrameCounter();
+	step_c = (frames / 6) % 4;
+	step_ab = frames / animation_speed;
+	if (animation_type) {
+		step_ab %= 3;
 	} else {
-		dst.Blit(x, y, *src, rect, 255);
+		step_ab %= 4;
+		if (step_ab == 3) {
+			step_ab = 1;
+		}
 	}
 }
 
-static uint32_t MakeFTileHash(int id) {
-	return static_cast<uint32_t>(id);
+uint64_t TilemapLayer::GetDrawState() const {
+	int step_ab, step_c;
+	GetAnimationSteps(step_ab, step_c);
+
+	uint64_t state = revision;
+	auto mix = [&state](uint64_t v) {
+		state = state * 1099511628211ull ^ v;
+	};
+	mix(static_cast<uint32_t>(ox));
+	mix(static_cast<uint32_t>(oy));
+	mix(static_cast<uint64_t>(step_ab) << 8 | static_cast<uint64_t>(step_c));
+	mix(reinterpret_cast<uintptr_t>(chipset.get()));
+	return state;
 }
 
-static uint32_t MakeETileHash(int id) {
-	return static_cast<uint32_t>(id | (1 << 24));
+namespace {
+	int DivRoundingDown(int n, int m) {
+		if (n >= 0) return n / m;
+		return (n - m + 1) / m;
+	}
+
+	int Mod(int n, int m) {
+		int rem = n % m;
+		return rem >= 0 ? rem : m + rem;
+	}
+
+	/** A run of screen tiles which maps to consecutive tiles of the same chunk */
+	struct TileSpan {
+		int screen;
+		int map;
+		int count;
+	};
+
+	/**
+	 * Splits the visible tiles of one axis into runs which do not cross
+	 * chunk borders, map borders or the loop seam.
+	 */
+	std::vector<TileSpan> GetTileSpans(int first_tile, int tiles, int map_size, bool loop, int chunk_tiles) {
+		std::vector<TileSpan> spans;
+		for (int i = 0; i < tiles;) {
+			int map = first_tile + i;
+			if (loop) {
+				map = Mod(map, map_size);
+			}
+			if (map < 0 || map >= map_size) {
+				++i;
+				continue;
+			}
+			int count = std::min({ tiles - i, chunk_tiles - map % chunk_tiles, map_size - map });
+			spans.push_back({ i, map, count });
+			i += count;
+		}
+		return spans;
+	}
 }
 
-static uint32_t MakeDTileHash(int id) {
-	return static_cast<uint32_t>(id | (2 << 24));
+void TilemapLayer::PrepareDraw(int z_order, TilemapDrawPlan& plan) {
+	GetAnimationSteps(plan.step_ab, plan.step_c);
+	plan.blits.clear();
+
+	// While the tone fades every frame looks different, rendering chunks would only add work
+	const int frames = GetFrameCounter();
+	plan.tiles = frames >= tone_frame && frames - tone_frame <= 1;
+	if (!plan.tiles) {
+		PrepareChunks(z_order, plan.step_ab, plan.step_c, plan.blits);
+	}
 }
 
-static uint32_t MakeCTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (3 << 24));
+void TilemapLayer::DrawPrepared(Bitmap& dst, int z_order, const TilemapDrawPlan& plan) const {
+	if (plan.tiles) {
+		DrawTiles(dst, z_order, plan.step_ab, plan.step_c);
+		return;
+	}
+
+	for (auto& blit: plan.blits) {
+		if (blit.fast) {
+			dst.BlitFast(blit.x, blit.y, *blit.bitmap, blit.rect, 255);
+		} else {
+			dst.Blit(blit.x, blit.y, *blit.bitmap, blit.rect, 255);
+		}
+	}
 }
 
-static uint32_t MakeAbTileHash(int id, int anim_step) {
-	return static_cast<uint32_t>((id + (anim_step << 12)) | (4 << 24));
+ImageOpacity TilemapLayer::DrawMapTile(Bitmap& dst, int map_draw_x, int map_draw_y, const TileData& tile, int animation_step_ab, int animation_step_c) const {
+	if (layer == 0) {
+		// If lower layer
+		bool allow_fast_blit = (tile.z == Priority_TilesetBelow);
+
+		if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
+			int id = substitutions[tile.ID - BLOCK_E];
+			// If Block E
+
+			int row, col;
+
+			// Get the tile coordinates from chipset
+			if (id < 96) {
+				// If from first column of the block
+				col = 12 + id % 6;
+				row = id / 6;
+			} else {
+				// If from second column of the block
+				col = 18 + (id - 96) % 6;
+				row = (id - 96) / 6;
+			}
+
+			return DrawTile(dst, *chipset, *chipset_toned, map_draw_x, map_draw_y, row, col, allow_fast_blit);
+		} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
+			// If Block C
+
+			// Get the tile coordinates from chipset
+			int col = 3 + (tile.ID - BLOCK_C) / 50;
+			int row = 4 + animation_step_c;
+
+			return DrawTile(dst, *chipset, *chipset_toned, map_draw_x, map_draw_y, row, col, allow_fast_blit);
+		} else if (tile.ID < BLOCK_C) {
+			// If Blocks A1, A2, B
+
+			// Draw the tile from autotile cache
+			TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
+
+			int col = pos.x;
+			int row = pos.y;
+
+			return DrawTile(dst, *autotiles_ab_screen, *autotiles_ab_screen_toned, map_draw_x, map_draw_y, row, col, allow_fast_blit);
+		} else {
+			// If blocks D1-D12
+
+			// Draw the tile from autotile cache
+			TileXY pos = GetCachedAutotileD(tile.ID);
+
+			int col = pos.x;
+			int row = pos.y;
+
+			return DrawTile(dst, *autotiles_d_screen, *autotiles_d_screen_toned, map_draw_x, map_draw_y, row, col, allow_fast_blit);
+		}
+	} else {
+		// If upper layer
+
+		// Check that block F is being drawn
+		if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
+			int id = substitutions[tile.ID - BLOCK_F];
+			int row, col;
+
+			// Get the tile coordinates from chipset
+			if (id < 48) {
+				// If from first column of the block
+				col = 18 + id % 6;
+				row = 8 + id / 6;
+			} else {
+				// If from second column of the block
+				col = 24 + (id - 48) % 6;
+				row = (id - 48) / 6;
+			}
+
+			return DrawTile(dst, *chipset, *chipset_toned, map_draw_x, map_draw_y, row, col);
+		}
+	}
+	return ImageOpacity::Transparent;
 }
 
-void TilemapLayer::Draw(Bitmap& dst, int z_order) {
+void TilemapLayer::DrawTiles(Bitmap& dst, int z_order, int animation_step_ab, int animation_step_c) const {
 	// Get the number of tiles that can be displayed on window
 	int tiles_x = (int)ceil(SCREEN_TARGET_WIDTH / (float)TILE_SIZE);
 	int tiles_y = (int)ceil(SCREEN_TARGET_HEIGHT / (float)TILE_SIZE);
@@ -222,33 +467,11 @@ void TilemapLayer::Draw(Bitmap& dst, int z_order) {
 	const bool loop_h = Game_Map::LoopHorizontal();
 	const bool loop_v = Game_Map::LoopVertical();
 
-	auto div_rounding_down = [](int n, int m) {
-		if (n >= 0) return n / m;
-		return (n - m + 1) / m;
-	};
-	auto mod = [](int n, int m) {
-		int rem = n % m;
-		return rem >= 0 ? rem : m + rem;
-	};
+	const int div_ox = DivRoundingDown(ox, TILE_SIZE);
+	const int div_oy = DivRoundingDown(oy, TILE_SIZE);
 
-	// FIXME: When Game_Map singleton is made an object we can remove this null check
-	const auto frames = Main_Data::game_system ? Main_Data::game_system->GetFrameCounter() : 0;
-	auto animation_step_c = (frames / 6) % 4;
-	auto animation_step_ab = frames / animation_speed;
-	if (animation_type) {
-		animation_step_ab %= 3;
-	} else {
-		animation_step_ab %= 4;
-		if (animation_step_ab == 3) {
-			animation_step_ab = 1;
-		}
-	}
-
-	const int div_ox = div_rounding_down(ox, TILE_SIZE);
-	const int div_oy = div_rounding_down(oy, TILE_SIZE);
-
-	const int mod_ox = mod(ox, TILE_SIZE);
-	const int mod_oy = mod(oy, TILE_SIZE);
+	const int mod_ox = Mod(ox, TILE_SIZE);
+	const int mod_oy = Mod(oy, TILE_SIZE);
 
 	for (int y = 0; y < tiles_y; y++) {
 		for (int x = 0; x < tiles_x; x++) {
@@ -256,8 +479,8 @@ void TilemapLayer::Draw(Bitmap& dst, int z_order) {
 			// Get the real maps tile coordinates
 			int map_x = div_ox + x;
 			int map_y = div_oy + y;
-			if (loop_h) map_x = mod(map_x, width);
-			if (loop_v) map_y = mod(map_y, height);
+			if (loop_h) map_x = Mod(map_x, width);
+			if (loop_v) map_y = Mod(map_y, height);
 
 			int map_draw_x = x * TILE_SIZE - mod_ox;
 			int map_draw_y = y * TILE_SIZE - mod_oy;
@@ -271,102 +494,171 @@ void TilemapLayer::Draw(Bitmap& dst, int z_order) {
 			}
 
 			// Get the tile data
-			TileData &tile = GetDataCache(map_x, map_y);
+			const TileData& tile = GetDataCache(map_x, map_y);
 
 			// Draw the sublayer if its z is being draw now
 			if (z_order == tile.z) {
-				if (layer == 0) {
-					// If lower layer
-					bool allow_fast_blit = (tile.z == Priority_TilesetBelow);
-
-					if (tile.ID >= BLOCK_E && tile.ID < BLOCK_E + BLOCK_E_TILES) {
-						int id = substitutions[tile.ID - BLOCK_E];
-						// If Block E
-
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 96) {
-							// If from first column of the block
-							col = 12 + id % 6;
-							row = id / 6;
-						} else {
-							// If from second column of the block
-							col = 18 + (id - 96) % 6;
-							row = (id - 96) / 6;
-						}
-
-						auto tone_hash = MakeETileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID >= BLOCK_C && tile.ID < BLOCK_D) {
-						// If Block C
-
-						// Get the tile coordinates from chipset
-						int col = 3 + (tile.ID - BLOCK_C) / 50;
-						int row = 4 + animation_step_c;
-
-						auto tone_hash = MakeCTileHash(tile.ID, animation_step_c);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else if (tile.ID < BLOCK_C) {
-						// If Blocks A1, A2, B
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileAB(tile.ID, animation_step_ab);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						// Create tone changed tile
-						auto tone_hash = MakeAbTileHash(tile.ID,  animation_step_ab);
-						DrawTile(dst, *autotiles_ab_screen, *autotiles_ab_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					} else {
-						// If blocks D1-D12
-
-						// Draw the tile from autotile cache
-						TileXY pos = GetCachedAutotileD(tile.ID);
-
-						int col = pos.x;
-						int row = pos.y;
-
-						auto tone_hash = MakeDTileHash(tile.ID);
-						DrawTile(dst, *autotiles_d_screen, *autotiles_d_screen_effect, map_draw_x, map_draw_y, row, col, tone_hash, allow_fast_blit);
-					}
-				} else {
-					// If upper layer
-
-					// Check that block F is being drawn
-					if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
-						int id = substitutions[tile.ID - BLOCK_F];
-						int row, col;
-
-						// Get the tile coordinates from chipset
-						if (id < 48) {
-							// If from first column of the block
-							col = 18 + id % 6;
-							row = 8 + id / 6;
-						} else {
-							// If from second column of the block
-							col = 24 + (id - 48) % 6;
-							row = (id - 48) / 6;
-						}
-
-						auto tone_hash = MakeFTileHash(id);
-						DrawTile(dst, *chipset, *chipset_effect, map_draw_x, map_draw_y, row, col, tone_hash);
-					}
-				}
+				DrawMapTile(dst, map_draw_x, map_draw_y, tile, animation_step_ab, animation_step_c);
+			}
+		}
+	}
+}
+
+void TilemapLayer::PrepareChunks(int z_order, int animation_step_ab, int animation_step_c, std::vector<TilemapDrawPlan::ChunkBlit>& blits) {
+	int tiles_x = (int)ceil(SCREEN_TARGET_WIDTH / (float)TILE_SIZE);
+	int tiles_y = (int)ceil(SCREEN_TARGET_HEIGHT / (float)TILE_SIZE);
+
+	if (ox % TILE_SIZE != 0) {
+		++tiles_x;
+	}
+	if (oy % TILE_SIZE != 0) {
+		++tiles_y;
+	}
+
+	const int mod_ox = Mod(ox, TILE_SIZE);
+	const int mod_oy = Mod(oy, TILE_SIZE);
+
+	const auto spans_x = GetTileSpans(DivRoundingDown(ox, TILE_SIZE), tiles_x, width, Game_Map::LoopHorizontal(), CHUNK_TILES);
+	const auto spans_y = GetTileSpans(DivRoundingDown(oy, TILE_SIZE), tiles_y, height, Game_Map::LoopVertical(), CHUNK_TILES);
+
+	++chunk_use_counter;
+
+	// Both sublayers, and the same again so chunks which scrolled out are kept for a while
+	chunk_bitmap_limit = std::max(chunk_bitmap_limit, spans_x.size() * spans_y.size() * 2 * 2);
+
+	// Only the lower tiles of the lower layer are drawn opaque when fast blit is on, see DrawMapTile
+	const bool allow_fast_blit = fast_blit && (layer != 0 || z_order == Priority_TilesetBelow);
+
+	for (auto& span_y: spans_y) {
+		for (auto& span_x: spans_x) {
+			const int chunk_x = span_x.map / CHUNK_TILES;
+			const int chunk_y = span_y.map / CHUNK_TILES;
+
+			auto& info = GetChunkInfo(chunk_x, chunk_y, z_order);
+			if (info.empty) {
+				continue;
+			}
+
+			auto& chunk = GetChunkBitmap(chunk_x, chunk_y, z_order,
+					info.uses_ab ? animation_step_ab : 0, info.uses_c ? animation_step_c : 0);
+
+			Rect rect(
+				(span_x.map % CHUNK_TILES) * TILE_SIZE, (span_y.map % CHUNK_TILES) * TILE_SIZE,
+				span_x.count * TILE_SIZE, span_y.count * TILE_SIZE);
+			int x = span_x.screen * TILE_SIZE - mod_ox;
+			int y = span_y.screen * TILE_SIZE - mod_oy;
+
+			// A chunk with a transparent tile must not be drawn opaque, it would erase what is below
+			const bool fast = chunk.opaque || (allow_fast_blit && chunk.covered);
+			blits.push_back({ chunk.bitmap, rect, x, y, fast });
+		}
+	}
+}
+
+TilemapLayer::ChunkInfo& TilemapLayer::GetChunkInfo(int chunk_x, int chunk_y, int z_order) {
+	const int chunks_x = (width + CHUNK_TILES - 1) / CHUNK_TILES;
+	const int chunks_y = (height + CHUNK_TILES - 1) / CHUNK_TILES;
+	const int sublayer = z_order >= Priority_TilesetAbove ? 1 : 0;
+
+	chunk_infos.resize(chunks_x * chunks_y * 2);
+	auto& info = chunk_infos[(chunk_x + chunk_y * chunks_x) * 2 + sublayer];
+	if (info.scanned) {
+		return info;
+	}
+
+	info.scanned = true;
+	const int max_x = std::min(width, (chunk_x + 1) * CHUNK_TILES);
+	const int max_y = std::min(height, (chunk_y + 1) * CHUNK_TILES);
+	for (int y = chunk_y * CHUNK_TILES; y < max_y; ++y) {
+		for (int x = chunk_x * CHUNK_TILES; x < max_x; ++x) {
+			auto& tile = GetDataCache(x, y);
+			if (tile.z != z_order) {
+				continue;
+			}
+			if (layer == 0) {
+				info.empty = false;
+				info.uses_ab |= tile.ID < BLOCK_C;
+				info.uses_c |= tile.ID >= BLOCK_C && tile.ID < BLOCK_D;
+			} else if (tile.ID >= BLOCK_F && tile.ID < BLOCK_F + BLOCK_F_TILES) {
+				info.empty = false;
 			}
 		}
 	}
+	return info;
 }
 
-TilemapLayer::TileXY TilemapLayer::GetCachedAutotileAB(short ID, short animID) {
+TilemapLayer::ChunkBitmap& TilemapLayer::GetChunkBitmap(int chunk_x, int chunk_y, int z_order, int step_ab, int step_c) {
+	const int sublayer = z_order >= Priority_TilesetAbove ? 1 : 0;
+	const uint64_t key =
+		static_cast<uint64_t>(static_cast<uint32_t>(chunk_x)) << 32 |
+		static_cast<uint64_t>(static_cast<uint16_t>(chunk_y)) << 16 |
+		static_cast<uint64_t>(sublayer);
+
+	auto it = chunk_bitmaps.find(key);
+	if (it == chunk_bitmaps.end()) {
+		if (chunk_bitmaps.size() >= chunk_bitmap_limit) {
+			// Drop the chunk that was not drawn for the longest time.
+			// Only happens when scrolling to new chunks and the cache is small.
+			auto oldest = std::min_element(chunk_bitmaps.begin(), chunk_bitmaps.end(), [](auto& l, auto& r) {
+				return l.second.last_used < r.second.last_used;
+			});
+			chunk_bitmaps.erase(oldest);
+		}
+		it = chunk_bitmaps.emplace(key, ChunkBitmap()).first;
+	}
+
+	auto& chunk = it->second;
+	if (chunk.step_ab != step_ab || chunk.step_c != step_c) {
+		RenderChunk(chunk, chunk_x, chunk_y, z_order, step_ab, step_c);
+	}
+
+	chunk.last_used = chunk_use_counter;
+	return chunk;
+}
+
+void TilemapLayer::RenderChunk(ChunkBitmap& chunk, int chunk_x, int chunk_y, int z_order, int step_ab, int step_c) {
+	const int min_x = chunk_x * CHUNK_TILES;
+	const int min_y = chunk_y * CHUNK_TILES;
+	const int max_x = std::min(width, min_x + CHUNK_TILES);
+	const int max_y = std::min(height, min_y + CHUNK_TILES);
+
+	if (!chunk.bitmap) {
+		chunk.bitmap = Bitmap::Create((max_x - min_x) * TILE_SIZE, (max_y - min_y) * TILE_SIZE, true);
+	}
+	chunk.bitmap->Clear();
+	chunk.step_ab = step_ab;
+	chunk.step_c = step_c;
+	chunk.opaque = true;
+	chunk.covered = true;
+
+	// The chunk starts fully transparent, so blending a tile onto it copies the tile unchanged
+	for (int y = min_y; y < max_y; ++y) {
+		for (int x = min_x; x < max_x; ++x) {
+			auto& tile = GetDataCache(x, y);
+			auto op = ImageOpacity::Transparent;
+			if (tile.z == z_order) {
+				op = DrawMapTile(*chunk.bitmap, (x - min_x) * TILE_SIZE, (y - min_y) * TILE_SIZE, tile, step_ab, step_c);
+			}
+			chunk.opaque &= op == ImageOpacity::Opaque;
+			chunk.covered &= op != ImageOpacity::Transparent;
+		}
+	}
+}
+
+void TilemapLayer::ClearChunks() {
+	chunk_infos.clear();
+	chunk_bitmaps.clear();
+	chunk_bitmap_limit = 0;
+}
+
+TilemapLayer::TileXY TilemapLayer::GetCachedAutotileAB(short ID, short animID) const {
 	short block = ID / 1000;
 	short b_subtile = (ID - block * 1000) / 50;
 	short a_subtile = ID - block * 1000 - b_subtile * 50;
 	return autotiles_ab[animID][block][b_subtile][a_subtile];
 }
 
-TilemapLayer::TileXY TilemapLayer::GetCachedAutotileD(short ID) {
+TilemapLayer::TileXY TilemapLayer::GetCachedAutotileD(short ID) const {
 	short block = (ID - 4000) / 50;
 	short subtile = ID - 4000 - block * 50;
 	return autotiles_d[block][subtile];
@@ -605,20 +897,22 @@ BitmapRef TilemapLayer::GenerateAutotiles(int count, const std::unordered_map<ui
 }
 
 void TilemapLayer::SetChipset(BitmapRef const& nchipset) {
+	++revision;
+	ClearChunks();
 	chipset = nchipset;
-	chipset_effect = Bitmap::Create(chipset->width(), chipset->height());
-	chipset_tone_tiles.clear();
 
 	if (autotiles_ab_next != 0 && autotiles_d_screen != nullptr && layer == 0) {
 		autotiles_ab_screen = GenerateAutotiles(autotiles_ab_next, autotiles_ab_map);
 		autotiles_d_screen = GenerateAutotiles(autotiles_d_next, autotiles_d_map);
-
-		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
-		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
 	}
+
+	UpdateToneVariants();
 }
 
 void TilemapLayer::SetMapData(std::vector<short> nmap_data) {
+	++revision;
+	ClearChunks();
+
 	// Create the tiles data cache
 	CreateTileCache(nmap_data);
 	memset(autotiles_ab, 0, sizeof(autotiles_ab));
@@ -648,16 +942,15 @@ void TilemapLayer::SetMapData(std::vector<short> nmap_data) {
 		autotiles_ab_screen = GenerateAutotiles(autotiles_ab_next, autotiles_ab_map);
 		autotiles_d_screen = GenerateAutotiles(autotiles_d_next, autotiles_d_map);
 
-		autotiles_ab_screen_effect = Bitmap::Create(autotiles_ab_screen->width(), autotiles_ab_screen->height());
-		autotiles_d_screen_effect = Bitmap::Create(autotiles_d_screen->width(), autotiles_d_screen->height());
-
-		chipset_tone_tiles.clear();
+		UpdateToneVariants();
 	}
 
 	map_data = std::move(nmap_data);
 }
 
 void TilemapLayer::SetPassable(std::vector<unsigned char> npassable) {
+	++revision;
+	ClearChunks();
 	passable = std::move(npassable);
 
 	// Recalculate z values of all tiles
@@ -665,6 +958,9 @@ void TilemapLayer::SetPassable(std::vector<unsigned char> npassable) {
 }
 
 void TilemapLayer::OnSubstitute() {
+	++revision;
+	ClearChunks();
+
 	// Recalculate z values of all tiles
 	CreateTileCache(map_data);
 }
@@ -677,28 +973,54 @@ TilemapSubLayer::TilemapSubLayer(TilemapLayer* tilemap, int z) :
 }
 
 void TilemapSubLayer::Draw(Bitmap& dst) {
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
+}
+
+Drawable::BandDraw TilemapSubLayer::PrepareBandDraw(Bitmap& /* dst */) {
 	if (!tilemap->GetChipset()) {
-		return;
+		return BandDraw::Skip;
 	}
 
-	tilemap->Draw(dst, GetZ());
+	tilemap->PrepareDraw(GetZ(), plan);
+	return BandDraw::Ready;
 }
 
-void TilemapLayer::SetTone(Tone tone) {
-	if (tone == this->tone) {
-		return;
-	}
+void TilemapSubLayer::DrawBand(Bitmap& dst) const {
+	tilemap->DrawPrepared(dst, GetZ(), plan);
+}
 
-	this->tone = tone;
+bool TilemapSubLayer::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
+	if (!tilemap->GetChipset()) {
+		return true;
+	}
 
-	if (autotiles_d_screen_effect) {
-		autotiles_d_screen_effect->Clear();
+	auto state = tilemap->GetDrawState();
+	if (state != last_draw_state) {
+		last_draw_state = state;
+		SetDamaged();
 	}
-	if (autotiles_ab_screen_effect) {
-		autotiles_ab_screen_effect->Clear();
+
+	rect = Rect(0, 0, SCREEN_TARGET_WIDTH, SCREEN_TARGET_HEIGHT);
+	return true;
+}
+
+void TilemapLayer::SetTone(Tone tone) {
+	auto new_draw_tone = tone;
+	if (tone != this->tone) {
+		// The tone is fading, toning the chipset for every intermediate step is too slow
+		new_draw_tone = QuantizeTone(tone);
 	}
-	if (chipset_effect) {
-		chipset_effect->Clear();
+	this->tone = tone;
+
+	if (new_draw_tone == draw_tone) {
+		return;
 	}
-	chipset_tone_tiles.clear();
+
+	draw_tone = new_draw_tone;
+	++revision;
+	tone_frame = GetFrameCounter();
+	ClearChunks();
+	UpdateToneVariants();
 }
@@ -21,16 +21,38 @@
 // Headers
 #include <vector>
 #include <map>
-#include <unordered_set>
 #include <unordered_map>
 #include "system.h"
 #include "drawable.h"
 #include "tone.h"
 #include "opacity.h"
 #include "span.h"
+#include "rect.h"
+#include "memory_management.h"
 
 class TilemapLayer;
 
+/**
+ * Blits of one tilemap sublayer for a frame.
+ * Filled by TilemapLayer::PrepareDraw, drawn by TilemapLayer::DrawPrepared.
+ */
+struct TilemapDrawPlan {
+	/** Blit of a pre-rendered chunk */
+	struct ChunkBlit {
+		BitmapRef bitmap;
+		Rect rect;
+		int x;
+		int y;
+		bool fast;
+	};
+
+	/** Draw tile by tile instead of the chunks, used while the tone fades */
+	bool tiles = false;
+	int step_ab = 0;
+	int step_c = 0;
+	std::vector<ChunkBlit> blits;
+};
+
 /**
  * TilemapSubLayer class.
  */
@@ -40,8 +62,16 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 private:
 	TilemapLayer* tilemap = nullptr;
+	uint64_t last_draw_state = 0;
+	TilemapDrawPlan plan;
 };
 
 /**
@@ -51,7 +81,31 @@ class TilemapLayer {
 public:
 	TilemapLayer(int ilayer);
 
-	void Draw(Bitmap& dst, int z_order);
+	/**
+	 * Returns a value which changes whenever drawing the layer gives a
+	 * different result: scrolling, tile animation and tile or chipset changes.
+	 *
+	 * @return draw state hash
+	 */
+	uint64_t GetDrawState() const;
+
+	/**
+	 * Renders the chunks a sublayer needs for this frame and records their blits.
+	 *
+	 * @param z_order z of the sublayer
+	 * @param plan receives the blits
+	 */
+	void PrepareDraw(int z_order, TilemapDrawPlan& plan);
+
+	/**
+	 * Draws a sublayer prepared by PrepareDraw.
+	 * Does not change the layer, so it can run on several threads at once.
+	 *
+	 * @param dst bitmap to draw onto
+	 * @param z_order z of the sublayer
+	 * @param plan blits recorded by PrepareDraw
+	 */
+	void DrawPrepared(Bitmap& dst, int z_order, const TilemapDrawPlan& plan) const;
 
 	BitmapRef const& GetChipset() const;
 	void SetChipset(BitmapRef const& nchipset);
@@ -83,12 +137,30 @@ public:
 	 */
 	void SetFastBlit(bool fast);
 
+	/**
+	 * Changes the tone of the tiles.
+	 * While the tone changes every frame the tiles are drawn with a tone
+	 * rounded to TONE_QUANTIZATION, the exact tone is used when it stays the same.
+	 *
+	 * @param tone new tone
+	 */
 	void SetTone(Tone tone);
 
+	/**
+	 * Sets the memory limit of the toned chipset copies kept for reuse.
+	 * The copies in use are always kept.
+	 *
+	 * @param bytes limit in bytes
+	 */
+	static void SetToneCacheLimit(size_t bytes);
+
+	/** Step to which the tone channels are rounded while the tone changes */
+	static constexpr int TONE_QUANTIZATION = 8;
+
 private:
 	BitmapRef chipset;
-	BitmapRef chipset_effect;
-	std::unordered_set<uint32_t> chipset_tone_tiles;
+	/** chipset with draw_tone applied, the same bitmap when there is no tone */
+	BitmapRef chipset_toned;
 	std::vector<short> map_data;
 	std::vector<uint8_t> passable;
 	Span<const uint8_t> substitutions;
@@ -100,12 +172,18 @@ private:
 	int animation_type = 0;
 	int layer = 0;
 	bool fast_blit = false;
+	/** Incremented on every change of the map data, chipset and tone */
+	uint32_t revision = 0;
+
+	void GetAnimationSteps(int& step_ab, int& step_c) const;
+	int GetFrameCounter() const;
 
 	void CreateTileCache(const std::vector<short>& nmap_data);
 	void GenerateAutotileAB(short ID, short animID);
 	void GenerateAutotileD(short ID);
-	void DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, bool allow_fast_blit = true);
-	void DrawTileImpl(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, uint32_t tone_hash, ImageOpacity op, bool allow_fast_blit);
+	ImageOpacity DrawTile(Bitmap& dst, Bitmap& tile, Bitmap& tone_tile, int x, int y, int row, int col, bool allow_fast_blit = true) const;
+	void DrawTileImpl(Bitmap& dst, Bitmap& tone_tile, int x, int y, int row, int col, ImageOpacity op, bool allow_fast_blit) const;
+	void UpdateToneVariants();
 
 	static const int TILES_PER_ROW = 64;
 
@@ -119,12 +197,12 @@ private:
 
 	BitmapRef GenerateAutotiles(int count, const std::unordered_map<uint32_t, TileXY>& map);
 
-	TileXY GetCachedAutotileAB(short ID, short animID);
-	TileXY GetCachedAutotileD(short ID);
+	TileXY GetCachedAutotileAB(short ID, short animID) const;
+	TileXY GetCachedAutotileD(short ID) const;
 	BitmapRef autotiles_ab_screen;
-	BitmapRef autotiles_ab_screen_effect;
+	BitmapRef autotiles_ab_screen_toned;
 	BitmapRef autotiles_d_screen;
-	BitmapRef autotiles_d_screen_effect;
+	BitmapRef autotiles_d_screen_toned;
 
 	int autotiles_ab_next = -1;
 	int autotiles_d_next = -1;
@@ -141,13 +219,63 @@ private:
 	};
 
 	TileData& GetDataCache(int x, int y);
+	const TileData& GetDataCache(int x, int y) const;
 
 	std::vector<TileData> data_cache_vec;
 
+	ImageOpacity DrawMapTile(Bitmap& dst, int x, int y, const TileData& tile, int step_ab, int step_c) const;
+	void DrawTiles(Bitmap& dst, int z_order, int step_ab, int step_c) const;
+	void PrepareChunks(int z_order, int step_ab, int step_c, std::vector<TilemapDrawPlan::ChunkBlit>& blits);
+
+	/** Width and height of a chunk in tiles */
+	static constexpr int CHUNK_TILES = 8;
+
+	/**
+	 * Which tiles a chunk of one sublayer contains.
+	 * Decides which animation steps change the chunk.
+	 */
+	struct ChunkInfo {
+		bool scanned = false;
+		bool empty = true;
+		bool uses_ab = false;
+		bool uses_c = false;
+	};
+
+	/**
+	 * Pre-rendered chunk of one sublayer.
+	 * Rendered again in place when the animation step changes.
+	 */
+	struct ChunkBitmap {
+		BitmapRef bitmap;
+		/** Animation steps the bitmap shows, -1 when not rendered yet */
+		int step_ab = -1;
+		int step_c = -1;
+		/** All tiles are opaque */
+		bool opaque = false;
+		/** No tile is transparent, the chunk is opaque when alpha is ignored */
+		bool covered = false;
+		uint32_t last_used = 0;
+	};
+
+	ChunkInfo& GetChunkInfo(int chunk_x, int chunk_y, int z_order);
+	ChunkBitmap& GetChunkBitmap(int chunk_x, int chunk_y, int z_order, int step_ab, int step_c);
+	void RenderChunk(ChunkBitmap& chunk, int chunk_x, int chunk_y, int z_order, int step_ab, int step_c);
+	void ClearChunks();
+
+	std::vector<ChunkInfo> chunk_infos;
+	std::unordered_map<uint64_t, ChunkBitmap> chunk_bitmaps;
+	/** Chunk bitmaps kept, enough for the visible chunks of both sublayers and a scroll margin */
+	size_t chunk_bitmap_limit = 0;
+	uint32_t chunk_use_counter = 0;
+	/** Frame in which the tone changed, chunks are not used while the tone fades */
+	int tone_frame = -1;
+
 	TilemapSubLayer lower_layer;
 	TilemapSubLayer upper_layer;
 
 	Tone tone;
+	/** Tone the tiles are drawn with */
+	Tone draw_tone;
 };
 
 inline BitmapRef const& TilemapLayer::GetChipset() const {
@@ -210,6 +338,7 @@ inline int TilemapLayer::GetAnimationSpeed() const {
 
 inline void TilemapLayer::SetAnimationSpeed(int speed) {
 	animation_speed = std::max(1, speed);
+	++revision;
 }
 
 inline int TilemapLayer::GetAnimationType() const {
@@ -218,6 +347,7 @@ inline int TilemapLayer::GetAnimationType() const {
 
 inline void TilemapLayer::SetAnimationType(int type) {
 	animation_type = type;
+	++revision;
 }
 
 inline void TilemapLayer::SetFastBlit(bool fast) {
@@ -228,5 +358,9 @@ inline TilemapLayer::TileData& TilemapLayer::GetDataCache(int x, int y) {
 	return data_cache_vec[x + y * width];
 }
 
+inline const TilemapLayer::TileData& TilemapLayer::GetDataCache(int x, int y) const {
+	return data_cache_vec[x + y * width];
+}
+
 
 #endif
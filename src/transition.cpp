@@ -170,6 +170,10 @@ void Transition::SetAttributesTransitions() {
 	}
 }
 
+bool Transition::UpdateDamage(const Bitmap& /* dst */, Rect& /* rect */) {
+	return !IsActive();
+}
+
 void Transition::Draw(Bitmap& dst) {
 	if (!IsActive())
 		return;
@@ -109,6 +109,9 @@ public:
 	void Draw(Bitmap& dst) override;
 	void Update();
 
+	/** Nothing is drawn while inactive, an active transition redraws everything */
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	bool IsActive() const;
 	bool IsErasedNotActive() const;
 
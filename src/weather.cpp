@@ -41,24 +41,20 @@ Weather::Weather() :
 void Weather::Update() {
 }
 
-void Weather::Draw(Bitmap& dst) {
-	SetTone(Main_Data::game_screen->GetTone());
+bool Weather::UpdateDamage(const Bitmap& /* dst */, Rect& /* rect */) {
+	return Main_Data::game_screen->GetWeatherType() == Game_Screen::Weather_None;
+}
 
-	switch (Main_Data::game_screen->GetWeatherType()) {
-		case Game_Screen::Weather_None:
-			break;
-		case Game_Screen::Weather_Rain:
-			DrawRain(dst);
-			break;
-		case Game_Screen::Weather_Snow:
-			DrawSnow(dst);
-			break;
-		case Game_Screen::Weather_Fog:
-			DrawFog(dst);
+void Weather::Draw(Bitmap& dst) {
+	switch (PrepareBandDraw(dst)) {
+		case BandDraw::Ready:
+			DrawBand(dst);
 			break;
-		case Game_Screen::Weather_Sandstorm:
+		case BandDraw::Unsupported:
 			DrawSandstorm(dst);
 			break;
+		case BandDraw::Skip:
+			break;
 	}
 }
 
@@ -119,6 +115,60 @@ static constexpr int fog_opacity[2][4] = {
 };
 
 
+Drawable::BandDraw Weather::PrepareBandDraw(Bitmap& /* dst */) {
+	SetTone(Main_Data::game_screen->GetTone());
+
+	switch (Main_Data::game_screen->GetWeatherType()) {
+		case Game_Screen::Weather_Rain:
+			if (!rain_bitmap) {
+				CreateRainParticle();
+			}
+			RenderParticles(*rain_bitmap, rain_bitmap_rect, 5, 12);
+			return BandDraw::Ready;
+		case Game_Screen::Weather_Snow:
+			if (!snow_bitmap) {
+				CreateSnowParticle();
+			}
+			RenderParticles(*snow_bitmap, snow_bitmap_rect, 7, 30);
+			return BandDraw::Ready;
+		case Game_Screen::Weather_Fog:
+			if (!fog_bitmap) {
+				CreateFogOverlay();
+			}
+			prepared_overlay = ApplyToneEffect(*fog_bitmap, overlay_bitmap_rect);
+			return BandDraw::Ready;
+		case Game_Screen::Weather_Sandstorm:
+			if (!sand_bitmap) {
+				CreateFogOverlay();
+			}
+			if (!sand_particle_bitmap) {
+				CreateSandParticle();
+			}
+			if (tone_effect != Tone()) {
+				return BandDraw::Unsupported;
+			}
+			prepared_overlay = sand_bitmap.get();
+			return BandDraw::Ready;
+	}
+	return BandDraw::Skip;
+}
+
+void Weather::DrawBand(Bitmap& dst) const {
+	switch (Main_Data::game_screen->GetWeatherType()) {
+		case Game_Screen::Weather_Rain:
+		case Game_Screen::Weather_Snow:
+			DrawSurface(dst);
+			break;
+		case Game_Screen::Weather_Fog:
+			DrawFogOverlay(dst, *prepared_overlay);
+			break;
+		case Game_Screen::Weather_Sandstorm:
+			DrawFogOverlay(dst, *prepared_overlay);
+			DrawSandParticles(dst, *sand_particle_bitmap);
+			break;
+	}
+}
+
 int Weather::GetMaxNumParticles(int weather_type) {
 	switch (weather_type) {
 		case Game_Screen::Weather_None:
@@ -157,7 +207,7 @@ void Weather::CreateRainParticle() {
 
 	const auto pixel = Bitmap::pixel_format.rgba_to_uint32_t(255,255,255,255);
 
-	auto* img = reinterpret_cast<uint32_t*>(rain_bitmap->pixels());
+	auto* img = reinterpret_cast<uint32_t*>(rain_bitmap->MutablePixels());
 
 	for (int y = 0; y < h; ++y) {
 		int x = w - (y / 4) - 1;
@@ -166,14 +216,6 @@ void Weather::CreateRainParticle() {
 	}
 }
 
-void Weather::DrawRain(Bitmap& dst) {
-	if (!rain_bitmap) {
-		CreateRainParticle();
-	}
-	DrawParticles(dst, *rain_bitmap, rain_bitmap_rect, 5, 12);
-}
-
-
 void Weather::CreateSnowParticle() {
 	constexpr auto w = snow_bitmap_rect.width;
 	constexpr auto h = snow_bitmap_rect.height;
@@ -181,21 +223,14 @@ void Weather::CreateSnowParticle() {
 
 	const auto pixel = Bitmap::pixel_format.rgba_to_uint32_t(255,255,255,255);
 
-	auto* img = reinterpret_cast<uint32_t*>(snow_bitmap->pixels());
+	auto* img = reinterpret_cast<uint32_t*>(snow_bitmap->MutablePixels());
 
 	for (int i = 0; i < w * h; ++i) {
 		img[i] = pixel;
 	}
 }
 
-void Weather::DrawSnow(Bitmap& dst) {
-	if (!snow_bitmap) {
-		CreateSnowParticle();
-	}
-	DrawParticles(dst, *snow_bitmap, snow_bitmap_rect, 7, 30);
-}
-
-void Weather::DrawParticles(Bitmap& dst, const Bitmap& particle, const Rect rect, int abase, int tmax) {
+void Weather::RenderParticles(const Bitmap& particle, const Rect rect, int abase, int tmax) {
 	auto* bitmap = ApplyToneEffect(particle, rect);
 
 	const auto strength = Main_Data::game_screen->GetWeatherStrength();
@@ -204,7 +239,6 @@ void Weather::DrawParticles(Bitmap& dst, const Bitmap& particle, const Rect rect
 	const int num_particles = num_rain_or_snow_particles[Utils::Clamp(strength, 0, num_strength - 1)];
 	const auto ainc = abase + strength;
 
-	auto surface_rect = weather_surface->GetRect();
 	weather_surface->Clear();
 
 	assert(num_particles <= static_cast<int>(particles.size()));
@@ -219,31 +253,19 @@ void Weather::DrawParticles(Bitmap& dst, const Bitmap& particle, const Rect rect
 
 		weather_surface->EdgeMirrorBlit(p.x, p.y, *bitmap, rect, true, true, alpha);
 	}
+}
 
+void Weather::DrawSurface(Bitmap& dst) const {
 	const auto shake_x = Main_Data::game_screen->GetShakeOffsetX();
 	const auto shake_y = Main_Data::game_screen->GetShakeOffsetY();
 	auto pan_rect = Main_Data::game_screen->GetScreenEffectsRect();
-	dst.TiledBlit(-pan_rect.x + shake_x, -pan_rect.y + shake_y, surface_rect, *weather_surface, dst.GetRect(), Opacity::Opaque());
-}
-
-void Weather::DrawFog(Bitmap& dst) {
-	if (!fog_bitmap) {
-		CreateFogOverlay();
-	}
-
-	DrawFogOverlay(dst, *fog_bitmap);
+	dst.TiledBlit(-pan_rect.x + shake_x, -pan_rect.y + shake_y, weather_surface->GetRect(), *weather_surface, dst.GetRect(), Opacity::Opaque());
 }
 
 void Weather::DrawSandstorm(Bitmap& dst) {
-	if (!sand_bitmap) {
-		CreateFogOverlay();
-	}
-	if (!sand_particle_bitmap) {
-		CreateSandParticle();
-	}
-
-	DrawFogOverlay(dst, *sand_bitmap);
-	DrawSandParticles(dst, *sand_particle_bitmap);
+	// The overlay and the particles are toned one after another into tone_bitmap
+	DrawFogOverlay(dst, *ApplyToneEffect(*sand_bitmap, overlay_bitmap_rect));
+	DrawSandParticles(dst, *ApplyToneEffect(*sand_particle_bitmap, sand_particle_bitmap->GetRect()));
 }
 
 void Weather::CreateSandParticle() {
@@ -259,19 +281,17 @@ void Weather::CreateSandParticle() {
 		Bitmap::pixel_format.rgba_to_uint32_t(255,255,240,255), // White
 	}};
 
-	auto* img = reinterpret_cast<uint32_t*>(sand_particle_bitmap->pixels());
+	auto* img = reinterpret_cast<uint32_t*>(sand_particle_bitmap->MutablePixels());
 
 	for (int i = 0; i < w * h; ++i) {
 		img[i] = pixels[i / 2];
 	}
 }
 
-void Weather::DrawSandParticles(Bitmap& dst, const Bitmap& particle_bitmap) {
+void Weather::DrawSandParticles(Bitmap& dst, const Bitmap& particle_bitmap) const {
 	const auto strength = Main_Data::game_screen->GetWeatherStrength();
 	const auto& particles = Main_Data::game_screen->GetParticles();
 
-	auto* bitmap = ApplyToneEffect(particle_bitmap, particle_bitmap.GetRect());
-
 	const int num_particles = num_sand_particles[Utils::Clamp(strength, 0, num_strength - 1)];
 
 	assert(num_particles <= static_cast<int>(particles.size()));
@@ -287,7 +307,7 @@ void Weather::DrawSandParticles(Bitmap& dst, const Bitmap& particle_bitmap) {
 			sand_particle_rect.height
 		};
 
-		dst.Blit(p.x, p.y, *bitmap, rect, p.alpha);
+		dst.Blit(p.x, p.y, particle_bitmap, rect, p.alpha);
 	}
 }
 
@@ -308,8 +328,8 @@ void Weather::CreateFogOverlay() {
 	fog_bitmap = Bitmap::Create(w, h);
 	sand_bitmap = Bitmap::Create(w, h);
 
-	auto* fog_img = reinterpret_cast<uint32_t*>(fog_bitmap->pixels());
-	auto* sand_img = reinterpret_cast<uint32_t*>(sand_bitmap->pixels());
+	auto* fog_img = reinterpret_cast<uint32_t*>(fog_bitmap->MutablePixels());
+	auto* sand_img = reinterpret_cast<uint32_t*>(sand_bitmap->MutablePixels());
 
 	for (int i = 0; i < w * h; ++i) {
 		int px = Rand::GetRandomNumber(0, num_overlay_colors - 1);
@@ -319,12 +339,10 @@ void Weather::CreateFogOverlay() {
 	}
 }
 
-void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) {
+void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) const {
 	const auto dr = dst.GetRect();
 	constexpr auto sr = overlay_bitmap_rect;
 
-	auto* src = ApplyToneEffect(overlay, sr);
-
 	auto strength = Utils::Clamp(Main_Data::game_screen->GetWeatherStrength(), 0, num_opacities - 1);
 	int back_opacity = fog_opacity[0][strength];
 	int front_opacity = fog_opacity[1][strength];
@@ -348,8 +366,8 @@ void Weather::DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) {
 	// Back layer never moves vertically
 	const int by = shake_y;
 
-	dst.TiledBlit(bx, by, sr, *src, dr, back_opacity);
-	dst.TiledBlit(fx, fy, sr, *src, dr, front_opacity);
+	dst.TiledBlit(bx, by, sr, overlay, dr, back_opacity);
+	dst.TiledBlit(fx, fy, sr, overlay, dr, front_opacity);
 }
 
 void Weather::SetTone(Tone tone) {
@@ -35,6 +35,14 @@ public:
 	void Draw(Bitmap& dst) override;
 	void Update();
 
+	/** A toned sandstorm is drawn serially, both layers share the tone bitmap */
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	/** Nothing is drawn without weather, the particles move every frame otherwise */
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	Tone GetTone() const;
 	void SetTone(Tone tone);
 
@@ -43,18 +51,16 @@ public:
 	static int GetMaxNumParticles(int weather_type);
 
 private:
-	void DrawRain(Bitmap& dst);
-	void DrawSnow(Bitmap& dst);
-	void DrawFog(Bitmap& dst);
 	void DrawSandstorm(Bitmap& dst);
 	void CreateRainParticle();
 	void CreateSnowParticle();
 	void CreateSandParticle();
 	void CreateFogOverlay();
 
-	void DrawParticles(Bitmap& dst, const Bitmap& particle, Rect rect, int abase, int tmax);
-	void DrawFogOverlay(Bitmap& dst, const Bitmap& overlay);
-	void DrawSandParticles(Bitmap& dst, const Bitmap& particle);
+	void RenderParticles(const Bitmap& particle, Rect rect, int abase, int tmax);
+	void DrawSurface(Bitmap& dst) const;
+	void DrawFogOverlay(Bitmap& dst, const Bitmap& overlay) const;
+	void DrawSandParticles(Bitmap& dst, const Bitmap& particle) const;
 	const Bitmap* ApplyToneEffect(const Bitmap& bitmap, Rect rect);
 
 	BitmapRef snow_bitmap;
@@ -67,6 +73,9 @@ private:
 
 	BitmapRef weather_surface;
 
+	/** Toned fog or sand overlay drawn by DrawBand */
+	const Bitmap* prepared_overlay = nullptr;
+
 	Tone tone_effect;
 
 	bool tone_dirty = true;
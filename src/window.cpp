@@ -34,6 +34,7 @@ Window::Window(Drawable::Flags flags): Drawable(Priority_Window, flags)
 }
 
 void Window::SetOpenAnimation(int frames) {
+	SetDamaged();
 	closing = false;
 	SetVisible(true);
 
@@ -48,6 +49,7 @@ void Window::SetOpenAnimation(int frames) {
 }
 
 void Window::SetCloseAnimation(int frames) {
+	SetDamaged();
 	if (frames > 0) {
 		closing = true;
 		animation_frames = frames;
@@ -59,14 +61,36 @@ void Window::SetCloseAnimation(int frames) {
 }
 
 void Window::Draw(Bitmap& dst) {
-	if (!IsVisible()) return;
-	if (width <= 0 || height <= 0) return;
-	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return;
+	if (PrepareBandDraw(dst) == BandDraw::Ready) {
+		DrawBand(dst);
+	}
+}
+
+Drawable::BandDraw Window::PrepareBandDraw(Bitmap& dst) {
+	if (!IsVisible()) return BandDraw::Skip;
+	if (width <= 0 || height <= 0) return BandDraw::Skip;
+	if (x < -width || x > dst.GetWidth() || y < -height || y > dst.GetHeight()) return BandDraw::Skip;
 
 	if (windowskin) {
 		if (width > 4 && height > 4 && (back_opacity * opacity / 255 > 0)) {
 			if (background_needs_refresh) RefreshBackground();
+		}
 
+		if (width > 0 && height > 0 && opacity > 0) {
+			if (frame_needs_refresh) RefreshFrame();
+		}
+
+		if (width >= 16 && height > 16 && cursor_rect.width > 4 && cursor_rect.height > 4 && animation_frames == 0) {
+			if (cursor_needs_refresh) RefreshCursor();
+		}
+	}
+
+	return BandDraw::Ready;
+}
+
+void Window::DrawBand(Bitmap& dst) const {
+	if (windowskin) {
+		if (width > 4 && height > 4 && (back_opacity * opacity / 255 > 0)) {
 			if (animation_frames > 0) {
 				int ianimation_count = (int)animation_count;
 
@@ -79,8 +103,6 @@ void Window::Draw(Bitmap& dst) {
 		}
 
 		if (width > 0 && height > 0 && opacity > 0) {
-			if (frame_needs_refresh) RefreshFrame();
-
 			if (animation_frames > 0) {
 				int ianimation_count = (int)animation_count;
 
@@ -105,8 +127,6 @@ void Window::Draw(Bitmap& dst) {
 		}
 
 		if (width >= 16 && height > 16 && cursor_rect.width > 4 && cursor_rect.height > 4 && animation_frames == 0) {
-			if (cursor_needs_refresh) RefreshCursor();
-
 			Rect src_rect(
 				-min(cursor_rect.x + border_x, 0),
 				-min(cursor_rect.y + border_y, 0),
@@ -292,14 +312,23 @@ void Window::RefreshCursor() {
 
 void Window::Update() {
 	if (active) {
+		const bool cursor_blink = cursor_frame <= 10;
+		const bool pause_blink = pause_frame < pause_animation_frames;
+
 		cursor_frame += 1;
 		if (cursor_frame > 20) cursor_frame = 0;
 		if (pause) {
 			pause_frame = (pause_frame + 1) % (pause_animation_frames * 2);
 		}
+
+		if (cursor_blink != (cursor_frame <= 10) || pause_blink != (pause_frame < pause_animation_frames)) {
+			SetDamaged();
+		}
 	}
 
 	if (animation_frames > 0) {
+		SetDamaged();
+
 		// Open/Close Animation
 		animation_frames -= 1;
 		animation_count += animation_increment;
@@ -318,15 +347,20 @@ void Window::SetWindowskin(BitmapRef const& nwindowskin) {
 	frame_needs_refresh = true;
 	cursor_needs_refresh = true;
 	windowskin = nwindowskin;
+	SetDamaged();
 }
 
 void Window::SetStretch(bool nstretch) {
-	if (stretch != nstretch) background_needs_refresh = true;
+	if (stretch != nstretch) {
+		background_needs_refresh = true;
+		SetDamaged();
+	}
 	stretch = nstretch;
 }
 
 void Window::SetCursorRect(Rect const& ncursor_rect) {
 	if (cursor_rect.width != ncursor_rect.width || cursor_rect.height != ncursor_rect.height) cursor_needs_refresh = true;
+	if (cursor_rect != ncursor_rect) SetDamaged();
 	cursor_rect = ncursor_rect;
 }
 
@@ -334,6 +368,7 @@ void Window::SetWidth(int nwidth) {
 	if (width != nwidth) {
 		background_needs_refresh = true;
 		frame_needs_refresh = true;
+		SetDamaged();
 	}
 	width = nwidth;
 }
@@ -342,8 +377,28 @@ void Window::SetHeight(int nheight) {
 	if (height != nheight) {
 		background_needs_refresh = true;
 		frame_needs_refresh = true;
+		SetDamaged();
 	}
 	height = nheight;
 }
 
+bool Window::UpdateDamage(const Bitmap& /* dst */, Rect& rect) {
+	if (width <= 0 || height <= 0) {
+		return true;
+	}
+
+	if (windowskin && windowskin->GetRevision() != windowskin_revision) {
+		windowskin_revision = windowskin->GetRevision();
+		SetDamaged();
+	}
+	if (contents && contents->GetRevision() != contents_revision) {
+		contents_revision = contents->GetRevision();
+		SetDamaged();
+	}
+
+	// The rotated side arrows can reach over the border
+	rect = Rect(x - 8, y - 8, width + 16, height + 16);
+	return true;
+}
+
 
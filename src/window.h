@@ -32,6 +32,12 @@ public:
 
 	void Draw(Bitmap& dst) override;
 
+	BandDraw PrepareBandDraw(Bitmap& dst) override;
+
+	void DrawBand(Bitmap& dst) const override;
+
+	bool UpdateDamage(const Bitmap& dst, Rect& rect) override;
+
 	void Update();
 	BitmapRef const& GetWindowskin() const;
 	void SetWindowskin(BitmapRef const& nwindowskin);
@@ -126,6 +132,9 @@ private:
 	int animation_frames = 0;
 	double animation_count = 0.0;
 	double animation_increment = 0.0;
+
+	uint32_t windowskin_revision = 0;
+	uint32_t contents_revision = 0;
 };
 
 inline bool Window::IsOpening() const {
@@ -149,7 +158,10 @@ inline BitmapRef Window::GetContents() const {
 }
 
 inline void Window::SetContents(BitmapRef const& ncontents) {
-	contents = ncontents;
+	if (contents != ncontents) {
+		contents = ncontents;
+		SetDamaged();
+	}
 }
 
 inline bool Window::GetStretch() const {
@@ -165,7 +177,10 @@ inline bool Window::GetActive() const {
 }
 
 inline void Window::SetActive(bool nactive) {
-	active = nactive;
+	if (active != nactive) {
+		active = nactive;
+		SetDamaged();
+	}
 }
 
 inline bool Window::GetPause() const {
@@ -173,6 +188,9 @@ inline bool Window::GetPause() const {
 }
 
 inline void Window::SetPause(bool npause) {
+	if (pause != npause) {
+		SetDamaged();
+	}
 	pause = npause;
 	pause_frame = 0;
 }
@@ -182,7 +200,10 @@ inline bool Window::GetUpArrow() const {
 }
 
 inline void Window::SetUpArrow(bool nup_arrow) {
-	up_arrow = nup_arrow;
+	if (up_arrow != nup_arrow) {
+		up_arrow = nup_arrow;
+		SetDamaged();
+	}
 }
 
 inline bool Window::GetDownArrow() const {
@@ -190,7 +211,10 @@ inline bool Window::GetDownArrow() const {
 }
 
 inline void Window::SetDownArrow(bool ndown_arrow) {
-	down_arrow = ndown_arrow;
+	if (down_arrow != ndown_arrow) {
+		down_arrow = ndown_arrow;
+		SetDamaged();
+	}
 }
 
 inline bool Window::GetLeftArrow() const {
@@ -198,7 +222,10 @@ inline bool Window::GetLeftArrow() const {
 }
 
 inline void Window::SetLeftArrow(bool nleft_arrow) {
-	left_arrow = nleft_arrow;
+	if (left_arrow != nleft_arrow) {
+		left_arrow = nleft_arrow;
+		SetDamaged();
+	}
 }
 
 inline bool Window::GetRightArrow() const {
@@ -206,7 +233,10 @@ inline bool Window::GetRightArrow() const {
 }
 
 inline void Window::SetRightArrow(bool nright_arrow) {
-	right_arrow = nright_arrow;
+	if (right_arrow != nright_arrow) {
+		right_arrow = nright_arrow;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetX() const {
@@ -214,7 +244,10 @@ inline int Window::GetX() const {
 }
 
 inline void Window::SetX(int nx) {
-	x = nx;
+	if (x != nx) {
+		x = nx;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetY() const {
@@ -222,7 +255,10 @@ inline int Window::GetY() const {
 }
 
 inline void Window::SetY(int ny) {
-	y = ny;
+	if (y != ny) {
+		y = ny;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetWidth() const {
@@ -238,7 +274,10 @@ inline int Window::GetOx() const {
 }
 
 inline void Window::SetOx(int nox) {
-	ox = nox;
+	if (ox != nox) {
+		ox = nox;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetOy() const {
@@ -246,7 +285,10 @@ inline int Window::GetOy() const {
 }
 
 inline void Window::SetOy(int noy) {
-	oy = noy;
+	if (oy != noy) {
+		oy = noy;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetBorderX() const {
@@ -254,7 +296,10 @@ inline int Window::GetBorderX() const {
 }
 
 inline void Window::SetBorderX(int x) {
-	border_x = x;
+	if (border_x != x) {
+		border_x = x;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetBorderY() const {
@@ -262,7 +307,10 @@ inline int Window::GetBorderY() const {
 }
 
 inline void Window::SetBorderY(int y) {
-	border_y = y;
+	if (border_y != y) {
+		border_y = y;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetOpacity() const {
@@ -270,7 +318,10 @@ inline int Window::GetOpacity() const {
 }
 
 inline void Window::SetOpacity(int nopacity) {
-	opacity = nopacity;
+	if (opacity != nopacity) {
+		opacity = nopacity;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetBackOpacity() const {
@@ -278,7 +329,10 @@ inline int Window::GetBackOpacity() const {
 }
 
 inline void Window::SetBackOpacity(int nback_opacity) {
-	back_opacity = nback_opacity;
+	if (back_opacity != nback_opacity) {
+		back_opacity = nback_opacity;
+		SetDamaged();
+	}
 }
 
 inline int Window::GetContentsOpacity() const {
@@ -286,7 +340,10 @@ inline int Window::GetContentsOpacity() const {
 }
 
 inline void Window::SetContentsOpacity(int ncontents_opacity) {
-	contents_opacity = ncontents_opacity;
+	if (contents_opacity != ncontents_opacity) {
+		contents_opacity = ncontents_opacity;
+		SetDamaged();
+	}
 }
 
 inline bool Window::IsSystemGraphicUpdateAllowed() const {
@@ -0,0 +1,121 @@
+#include <cstring>
+#include <random>
+#include <vector>
+#include "audio_kernels.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("AudioKernels");
+
+namespace {
+
+using AudioKernels::Isa;
+using AudioKernels::Format;
+
+constexpr Isa simd_isas[] = { Isa::SSE2, Isa::AVX2, Isa::NEON };
+constexpr Format formats[] = { Format::S8, Format::U8, Format::S16, Format::U16, Format::S32, Format::U32, Format::F32 };
+
+int SampleSize(Format format) {
+	switch (format) {
+		case Format::S8:
+		case Format::U8:
+			return 1;
+		case Format::S16:
+		case Format::U16:
+			return 2;
+		default:
+			return 4;
+	}
+}
+
+}
+
+TEST_CASE("Scalar") {
+	std::vector<float> mixed(2, 0.5f);
+
+	const int8_t s8[] = { -128, 64 };
+	AudioKernels::detail::MixScalar(Format::S8, s8, mixed.data(), 2, 1.0f);
+	REQUIRE_EQ(mixed[0], -0.5f);
+	REQUIRE_EQ(mixed[1], 1.0f);
+
+	const uint8_t u8[] = { 128, 0 };
+	AudioKernels::detail::MixScalar(Format::U8, u8, mixed.data(), 2, 0.5f);
+	REQUIRE_EQ(mixed[0], -0.5f);
+	REQUIRE_EQ(mixed[1], 0.5f);
+
+	const uint32_t u32[] = { 0xC0000000u, 0x80000000u };
+	AudioKernels::detail::MixScalar(Format::U32, u32, mixed.data(), 2, 1.0f);
+	REQUIRE_EQ(mixed[0], 0.0f);
+	REQUIRE_EQ(mixed[1], 0.5f);
+}
+
+TEST_CASE("ToS16Clamps") {
+	const float mixed[] = { 0.0f, 0.5f, -0.5f, 1.0f, -1.0f, 2.0f, -2.0f };
+	int16_t out[7] = {};
+
+	AudioKernels::detail::ToS16Scalar(mixed, out, 7, 1.0f);
+	REQUIRE_EQ(out[0], 0);
+	REQUIRE_EQ(out[1], 16384);
+	REQUIRE_EQ(out[2], -16384);
+	REQUIRE_EQ(out[3], 32767);
+	REQUIRE_EQ(out[4], -32768);
+	REQUIRE_EQ(out[5], 32767);
+	REQUIRE_EQ(out[6], -32768);
+
+	// Compression keeps quiet samples and maps total_volume to full scale
+	const float loud[] = { 0.5f, 2.0f, -2.0f };
+	AudioKernels::detail::ToS16Scalar(loud, out, 3, 2.0f);
+	REQUIRE_EQ(out[0], 16384);
+	REQUIRE_EQ(out[1], 32767);
+	REQUIRE_EQ(out[2], -32768);
+}
+
+TEST_CASE("SimdMatchesScalar") {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<int> byte_dist(0, 255);
+	std::uniform_real_distribution<float> float_dist(-1.5f, 1.5f);
+
+	// Odd size to cover the scalar tail
+	constexpr int count = 1027;
+	std::vector<uint8_t> src(count * 4);
+	for (auto& b: src) {
+		b = byte_dist(rng);
+	}
+	std::vector<float> src_f32(count);
+	for (auto& f: src_f32) {
+		f = float_dist(rng);
+	}
+	std::vector<float> base(count);
+	for (auto& f: base) {
+		f = float_dist(rng);
+	}
+
+	auto old_isa = AudioKernels::GetIsa();
+	for (auto isa: simd_isas) {
+		if (!AudioKernels::SetIsa(isa)) {
+			continue;
+		}
+		INFO(PixelKernels::GetIsaName(isa));
+
+		for (auto format: formats) {
+			const void* samples = format == Format::F32 ? static_cast<const void*>(src_f32.data()) : src.data();
+			INFO(SampleSize(format));
+
+			auto expected = base;
+			AudioKernels::detail::MixScalar(format, samples, expected.data(), count, 0.7f);
+			auto result = base;
+			AudioKernels::Mix(format, samples, result.data(), count, 0.7f);
+			REQUIRE(result == expected);
+		}
+
+		for (float total_volume: { 0.5f, 1.0f, 1.5f, 31.0f }) {
+			std::vector<int16_t> expected(count);
+			AudioKernels::detail::ToS16Scalar(base.data(), expected.data(), count, total_volume);
+			std::vector<int16_t> result(count);
+			AudioKernels::ToS16(base.data(), result.data(), count, total_volume);
+			REQUIRE(result == expected);
+		}
+	}
+	AudioKernels::SetIsa(old_isa);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,79 @@
+#include "damage_region.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DamageRegion");
+
+TEST_CASE("Default") {
+	DamageRegion damage;
+	damage.Reset(Rect(0, 0, 320, 240));
+
+	REQUIRE(damage.IsEmpty());
+	REQUIRE_FALSE(damage.IsFull());
+	REQUIRE(damage.GetRects().empty());
+	REQUIRE_EQ(damage.GetBounds(), Rect(0, 0, 320, 240));
+	REQUIRE_FALSE(damage.Intersects(Rect(0, 0, 320, 240)));
+}
+
+TEST_CASE("Clip") {
+	DamageRegion damage;
+	damage.Reset(Rect(0, 0, 320, 240));
+
+	damage.Add(Rect(-10, -10, 20, 20));
+	damage.Add(Rect(400, 0, 20, 20));
+	damage.Add(Rect(10, 10, 0, 5));
+
+	REQUIRE_EQ(damage.GetRects().size(), 1);
+	REQUIRE_EQ(damage.GetRects()[0], Rect(0, 0, 10, 10));
+}
+
+TEST_CASE("Merge") {
+	DamageRegion damage;
+	damage.Reset(Rect(0, 0, 320, 240));
+
+	damage.Add(Rect(0, 0, 10, 10));
+	damage.Add(Rect(100, 100, 10, 10));
+	REQUIRE_EQ(damage.GetRects().size(), 2);
+
+	// Touching edges do not overlap
+	damage.Add(Rect(10, 0, 10, 10));
+	REQUIRE_EQ(damage.GetRects().size(), 3);
+
+	// Joins all three into one
+	damage.Add(Rect(5, 5, 100, 100));
+	REQUIRE_EQ(damage.GetRects().size(), 1);
+	REQUIRE_EQ(damage.GetRects()[0], Rect(0, 0, 110, 110));
+	REQUIRE_FALSE(damage.IsFull());
+
+	REQUIRE(damage.Intersects(Rect(50, 50, 1, 1)));
+	REQUIRE_FALSE(damage.Intersects(Rect(110, 0, 10, 10)));
+}
+
+TEST_CASE("TooManyRects") {
+	DamageRegion damage;
+	damage.Reset(Rect(0, 0, 320, 240));
+
+	for (int i = 0; i <= DamageRegion::max_rects; ++i) {
+		damage.Add(Rect(i * 20, 0, 10, 10));
+	}
+
+	REQUIRE_EQ(damage.GetRects().size(), 1);
+	REQUIRE_EQ(damage.GetRects()[0], Rect(0, 0, DamageRegion::max_rects * 20 + 10, 10));
+}
+
+TEST_CASE("Full") {
+	DamageRegion damage;
+	damage.Reset(Rect(0, 0, 320, 240));
+
+	damage.Add(Rect(0, 0, 320, 200));
+	REQUIRE(damage.IsFull());
+	REQUIRE_FALSE(damage.IsEmpty());
+	REQUIRE(damage.Intersects(Rect(300, 220, 1, 1)));
+
+	damage.Reset(Rect(0, 0, 320, 240));
+	REQUIRE(damage.IsEmpty());
+
+	damage.AddAll();
+	REQUIRE(damage.IsFull());
+	damage.Add(Rect(0, 0, 1, 1));
+	REQUIRE(damage.GetRects().empty());
+}
@@ -0,0 +1,43 @@
+#include "display_scaler.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DisplayScaler");
+
+using Filter = DisplayScaler::Filter;
+
+static void testSize(Filter filter, int width, int height, int expected_width, int expected_height) {
+	int w = 0;
+	int h = 0;
+	DisplayScaler::GetOutputSize(filter, 320, 240, width, height, w, h);
+	REQUIRE_EQ(w, expected_width);
+	REQUIRE_EQ(h, expected_height);
+}
+
+TEST_CASE("FilterFromName") {
+	REQUIRE(DisplayScaler::FilterFromName("none") == Filter::None);
+	REQUIRE(DisplayScaler::FilterFromName("nearest") == Filter::Nearest);
+	REQUIRE(DisplayScaler::FilterFromName("integer") == Filter::Integer);
+	REQUIRE(DisplayScaler::FilterFromName("scale2x") == Filter::Scale2x);
+	REQUIRE(DisplayScaler::FilterFromName("xyz") == Filter::None);
+}
+
+TEST_CASE("OutputSize") {
+	SUBCASE("nearest") {
+		testSize(Filter::Nearest, 640, 480, 640, 480);
+		testSize(Filter::Nearest, 1920, 1080, 1440, 1080);
+		testSize(Filter::Nearest, 800, 1000, 800, 600);
+	}
+
+	SUBCASE("integer") {
+		testSize(Filter::Integer, 1920, 1080, 1280, 960);
+		testSize(Filter::Integer, 639, 479, 320, 240);
+		testSize(Filter::Integer, 100, 100, 320, 240);
+	}
+
+	SUBCASE("scale2x") {
+		testSize(Filter::Scale2x, 1920, 1080, 640, 480);
+		testSize(Filter::Scale2x, 100, 100, 640, 480);
+	}
+}
+
+TEST_SUITE_END();
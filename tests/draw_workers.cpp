@@ -0,0 +1,61 @@
+#include <atomic>
+#include <vector>
+#include "draw_workers.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("DrawWorkers");
+
+static void testRun(int threads, int count) {
+	DrawWorkers::SetThreadCount(threads);
+
+	std::vector<std::atomic<int>> calls(count);
+	for (auto& c : calls) {
+		c = 0;
+	}
+
+	// Run several jobs to reuse the started threads
+	for (int i = 0; i < 3; ++i) {
+		DrawWorkers::Run(count, [&](int task) { ++calls[task]; });
+	}
+
+	for (auto& c : calls) {
+		REQUIRE_EQ(c.load(), 3);
+	}
+
+	DrawWorkers::Quit();
+	DrawWorkers::SetThreadCount(1);
+}
+
+TEST_CASE("Default") {
+	REQUIRE_EQ(DrawWorkers::GetThreadCount(), 1);
+}
+
+TEST_CASE("Run") {
+	SUBCASE("serial") {
+		testRun(1, 8);
+	}
+
+	SUBCASE("threads") {
+		testRun(4, 8);
+	}
+
+	SUBCASE("fewer tasks than threads") {
+		testRun(4, 2);
+	}
+
+	SUBCASE("no tasks") {
+		testRun(4, 0);
+	}
+}
+
+TEST_CASE("ThreadCount") {
+	DrawWorkers::SetThreadCount(0);
+	REQUIRE_EQ(DrawWorkers::GetThreadCount(), 1);
+
+	DrawWorkers::SetThreadCount(4);
+	REQUIRE_EQ(DrawWorkers::GetThreadCount(), DrawWorkers::IsSupported() ? 4 : 1);
+
+	DrawWorkers::SetThreadCount(1);
+}
+
+TEST_SUITE_END();
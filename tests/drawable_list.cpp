@@ -1,9 +1,13 @@
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <limits>
 #include "utils.h"
 #include "drawable_list.h"
 #include "drawable_mgr.h"
 #include "bitmap.h"
+#include "damage_region.h"
+#include "draw_workers.h"
 #include "doctest.h"
 
 TEST_SUITE_BEGIN("DrawableList");
@@ -22,6 +26,41 @@ class TestFrame : public Drawable {
 		void Draw(Bitmap&) override {}
 };
 
+class TestDamageSprite : public Drawable {
+	public:
+		TestDamageSprite(int z = 0) : Drawable(z, Drawable::Flags::Global) {}
+		void Draw(Bitmap&) override { ++draw_count; }
+		bool UpdateDamage(const Bitmap&, Rect& r) override {
+			r = rect;
+			return true;
+		}
+
+		Rect rect;
+		int draw_count = 0;
+};
+
+class TestBandSprite : public TestDamageSprite {
+	public:
+		TestBandSprite(int z, Rect r, Color c, bool band = true) : TestDamageSprite(z), color(c), band_draw(band) {
+			rect = r;
+		}
+		void Draw(Bitmap& dst) override {
+			++draw_count;
+			dst.FillRect(rect, color);
+		}
+		BandDraw PrepareBandDraw(Bitmap&) override {
+			++prepare_count;
+			return band_draw ? BandDraw::Ready : BandDraw::Unsupported;
+		}
+		void DrawBand(Bitmap& dst) const override {
+			dst.FillRect(rect, color);
+		}
+
+		Color color;
+		bool band_draw = true;
+		int prepare_count = 0;
+};
+
 }
 
 TEST_CASE("Default") {
@@ -350,4 +389,142 @@ TEST_CASE("TakeFromPred") {
 	REQUIRE(list2.IsDirty());
 }
 
+TEST_CASE("Damage") {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap bitmap(32, 32, false);
+
+	DrawableList default_list;
+	DrawableMgr::SetLocalList(&default_list);
+
+	DrawableList list;
+	DamageRegion damage;
+
+	TestDamageSprite s1;
+	s1.rect = Rect(0, 0, 4, 4);
+	TestDamageSprite s2;
+	s2.rect = Rect(20, 20, 4, 4);
+	list.Append(&s1);
+	list.Append(&s2);
+
+	SUBCASE("initial") {
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE_EQ(damage.GetRects().size(), 2);
+
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE(damage.IsEmpty());
+	}
+
+	damage.Reset(bitmap.GetRect());
+	list.CollectDamage(bitmap, damage);
+
+	SUBCASE("move") {
+		s1.rect = Rect(8, 0, 4, 4);
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE_EQ(damage.GetRects().size(), 2);
+		REQUIRE(damage.Intersects(Rect(0, 0, 4, 4)));
+		REQUIRE(damage.Intersects(Rect(8, 0, 4, 4)));
+		REQUIRE_FALSE(damage.Intersects(s2.rect));
+	}
+
+	SUBCASE("damaged") {
+		s2.SetDamaged();
+		REQUIRE(s2.IsDamaged());
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE_FALSE(s2.IsDamaged());
+		REQUIRE_EQ(damage.GetRects().size(), 1);
+		REQUIRE_EQ(damage.GetRects()[0], s2.rect);
+	}
+
+	SUBCASE("invisible") {
+		s1.SetVisible(false);
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE_EQ(damage.GetRects().size(), 1);
+		REQUIRE_EQ(damage.GetRects()[0], Rect(0, 0, 4, 4));
+	}
+
+	SUBCASE("take") {
+		list.Take(&s2);
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE_EQ(damage.GetRects().size(), 1);
+		REQUIRE_EQ(damage.GetRects()[0], Rect(20, 20, 4, 4));
+	}
+
+	SUBCASE("draw area") {
+		list.Draw(bitmap, Rect(0, 0, 8, 8), std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+		REQUIRE_EQ(s1.draw_count, 1);
+		REQUIRE_EQ(s2.draw_count, 0);
+	}
+
+	SUBCASE("unknown") {
+		TestSprite s3;
+		list.Append(&s3);
+		damage.Reset(bitmap.GetRect());
+		list.CollectDamage(bitmap, damage);
+		REQUIRE(damage.IsFull());
+		list.Take(&s3);
+	}
+}
+
+static void testDrawBands(int threads, bool band_draw) {
+	Bitmap::SetFormat(format_R8G8B8A8_a().format());
+	Bitmap serial(32, 32, false);
+	Bitmap parallel(32, 32, false);
+
+	DrawableList default_list;
+	DrawableMgr::SetLocalList(&default_list);
+
+	DrawableList list;
+	DamageRegion damage;
+
+	TestBandSprite s1(1, Rect(0, 0, 20, 20), Color(255, 0, 0, 255));
+	TestBandSprite s2(2, Rect(10, 10, 20, 20), Color(0, 255, 0, 128), band_draw);
+	TestBandSprite s3(3, Rect(5, 15, 10, 10), Color(0, 0, 255, 255));
+	list.Append(&s3);
+	list.Append(&s1);
+	list.Append(&s2);
+
+	damage.Reset(serial.GetRect());
+	list.CollectDamage(serial, damage);
+
+	std::vector<Rect> areas = { Rect(0, 0, 32, 12), Rect(0, 20, 32, 12) };
+	for (auto& area : areas) {
+		serial.SetClipRect(area);
+		list.Draw(serial, area, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+	}
+	serial.ClearClipRect();
+
+	DrawWorkers::SetThreadCount(threads);
+	list.DrawBands(parallel, areas, 5, std::numeric_limits<int>::min(), std::numeric_limits<int>::max());
+	DrawWorkers::Quit();
+	DrawWorkers::SetThreadCount(1);
+
+	REQUIRE_EQ(s1.prepare_count, 1);
+	REQUIRE_EQ(s2.prepare_count, 1);
+	REQUIRE_EQ(s3.prepare_count, band_draw ? 1 : 0);
+
+	auto* a = reinterpret_cast<const uint8_t*>(serial.pixels());
+	auto* b = reinterpret_cast<const uint8_t*>(parallel.pixels());
+	REQUIRE(std::equal(a, a + serial.pitch() * serial.height(), b));
+}
+
+TEST_CASE("DrawBands") {
+	SUBCASE("serial") {
+		testDrawBands(1, true);
+	}
+
+	SUBCASE("threads") {
+		testDrawBands(4, true);
+	}
+
+	SUBCASE("fallback") {
+		testDrawBands(4, false);
+	}
+}
+
 TEST_SUITE_END();
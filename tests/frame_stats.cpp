@@ -0,0 +1,47 @@
+#include <chrono>
+#include "frame_stats.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("FrameStats");
+
+TEST_CASE("SummarizeEmpty") {
+	auto s = FrameStats::Summarize({});
+	REQUIRE_EQ(s.count, 0);
+	REQUIRE_EQ(s.mean, 0.0);
+	REQUIRE_EQ(s.p99, 0.0);
+}
+
+TEST_CASE("Summarize") {
+	std::vector<double> samples;
+	for (int i = 100; i >= 1; --i) {
+		samples.push_back(i);
+	}
+
+	auto s = FrameStats::Summarize(samples);
+	REQUIRE_EQ(s.count, 100);
+	REQUIRE_EQ(s.mean, doctest::Approx(50.5));
+	REQUIRE_EQ(s.p50, 50.0);
+	REQUIRE_EQ(s.p99, 99.0);
+
+	s = FrameStats::Summarize({ 3.0 });
+	REQUIRE_EQ(s.p50, 3.0);
+	REQUIRE_EQ(s.p99, 3.0);
+}
+
+TEST_CASE("Report") {
+	using namespace std::chrono_literals;
+
+	FrameStats stats;
+	stats.AddUpdate("Map", 2ms);
+	stats.AddDraw("Map", 4ms);
+	stats.AddDraw("Title", 1ms);
+
+	auto report = stats.GetReport();
+	REQUIRE_EQ(report.size(), 3);
+	REQUIRE(report[1].find("Map") == 0);
+	REQUIRE(report[1].find("2.000") != std::string::npos);
+	REQUIRE(report[1].find("4.000") != std::string::npos);
+	REQUIRE(report[2].find("Title") == 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,76 @@
+#include <sstream>
+#include <string>
+#include <thread>
+#include "instrumentation.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("Instrumentation");
+
+static void runZone(Instrumentation::Zone& zone, int count) {
+	for (int i = 0; i < count; ++i) {
+		Instrumentation::Scope scope(zone);
+	}
+}
+
+TEST_CASE("ZoneStats") {
+	static Instrumentation::Zone zone_a("Test::A");
+	static Instrumentation::Zone zone_b("Test::B");
+	static Instrumentation::Zone zone_b2("Test::B");
+
+	// Nothing is collected while the profiler is disabled
+	if (!Instrumentation::IsProfilerEnabled()) {
+		runZone(zone_a, 1);
+		REQUIRE(Instrumentation::TakeZoneStats().empty());
+	}
+
+	Instrumentation::EnableProfiler(true);
+	Instrumentation::TakeZoneStats();
+
+	for (int frame = 0; frame < 2; ++frame) {
+		Instrumentation::FrameScope iframe;
+		runZone(zone_a, 3);
+		runZone(zone_b, 1);
+		runZone(zone_b2, 1);
+	}
+
+	auto stats = Instrumentation::TakeZoneStats();
+	REQUIRE_EQ(stats.size(), 2);
+	for (auto& s : stats) {
+		if (std::string(s.name) == "Test::A") {
+			REQUIRE_EQ(s.calls_per_frame, doctest::Approx(3.0));
+		} else {
+			REQUIRE_EQ(std::string(s.name), "Test::B");
+			REQUIRE_EQ(s.calls_per_frame, doctest::Approx(2.0));
+		}
+	}
+	REQUIRE_GE(stats[0].ms_per_frame, stats[1].ms_per_frame);
+
+	REQUIRE(Instrumentation::TakeZoneStats().empty());
+}
+
+TEST_CASE("WriteTrace") {
+	static Instrumentation::Zone zone("Test::\"Trace\"");
+
+	Instrumentation::EnableProfiler(true);
+	Instrumentation::SetThreadName("Main");
+	runZone(zone, 1);
+
+	std::thread worker([]() {
+		Instrumentation::SetThreadName("Worker");
+		runZone(zone, 1);
+	});
+	worker.join();
+
+	std::stringstream ss;
+	Instrumentation::WriteTrace(ss);
+	auto json = ss.str();
+
+	REQUIRE(json.find("{\"traceEvents\":[") == 0);
+	REQUIRE(json.find("\"args\":{\"name\":\"Main\"}") != std::string::npos);
+	REQUIRE(json.find("\"args\":{\"name\":\"Worker\"}") != std::string::npos);
+	REQUIRE(json.find("\"name\":\"Test::\\\"Trace\\\"\",\"ph\":\"X\"") != std::string::npos);
+
+	Instrumentation::TakeZoneStats();
+}
+
+TEST_SUITE_END();
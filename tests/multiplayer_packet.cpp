@@ -0,0 +1,80 @@
+#include "multiplayer_packet.h"
+#include "doctest.h"
+#include <string>
+
+TEST_SUITE_BEGIN("MultiplayerPacketReader");
+
+TEST_CASE("ReadValues") {
+	const char data[] = { 0x34, 0x12, char(0xFE), char(0xFF), char(0xFF), char(0xFF), 'a', 'b', 'c' };
+	MultiplayerPacketReader r(data, sizeof(data));
+
+	REQUIRE_EQ(r.ReadU16(), 0x1234);
+	REQUIRE_EQ(r.ReadI32(), -2);
+	REQUIRE_EQ(r.Remaining(), 3);
+	REQUIRE_EQ(ToString(r.ReadRest()), "abc");
+	REQUIRE_EQ(r.Remaining(), 0);
+	REQUIRE_FALSE(r.Failed());
+}
+
+TEST_CASE("ReadU8") {
+	const char data[] = { 3, '\xff', 2 };
+	MultiplayerPacketReader r(data, sizeof(data));
+
+	REQUIRE_EQ(r.ReadU8(), 3);
+	REQUIRE_EQ(r.ReadU8(), 255);
+	REQUIRE_EQ(r.ReadU16(), 0);
+	REQUIRE(r.Failed());
+}
+
+TEST_CASE("ReadPastEnd") {
+	const char data[] = { 1, 0, 2 };
+	MultiplayerPacketReader r(data, sizeof(data));
+
+	REQUIRE_EQ(r.ReadU16(), 1);
+	REQUIRE_EQ(r.ReadU16(), 0);
+	REQUIRE(r.Failed());
+	REQUIRE_EQ(r.Remaining(), 0);
+	REQUIRE(r.ReadString(1).empty());
+}
+
+TEST_CASE("ReadRecords") {
+	const char data[] = {
+		1, 0,
+		10, 0, 2, 0, 'i', 'd',
+		1, 0, 4, 0, 5, 0, 6, 0,
+		99, 0, 1, 0, 0,
+	};
+	MultiplayerPacketReader r(data, sizeof(data));
+	REQUIRE_EQ(r.ReadU16(), 1);
+
+	uint16_t type = 0;
+	auto uid = r.ReadRecord(type);
+	REQUIRE_EQ(type, 10);
+	REQUIRE_EQ(ToString(uid.ReadRest()), "id");
+
+	auto pos = r.ReadRecord(type);
+	REQUIRE_EQ(type, 1);
+	REQUIRE_EQ(pos.ReadU16(), 5);
+	REQUIRE_EQ(pos.ReadU16(), 6);
+	REQUIRE_FALSE(pos.Failed());
+
+	auto unknown = r.ReadRecord(type);
+	REQUIRE_EQ(type, 99);
+	REQUIRE_EQ(unknown.Remaining(), 1);
+
+	REQUIRE_EQ(r.Remaining(), 0);
+	REQUIRE_FALSE(r.Failed());
+}
+
+TEST_CASE("TruncatedRecord") {
+	const char data[] = { 1, 0, 8, 0, 'x' };
+	MultiplayerPacketReader r(data, sizeof(data));
+
+	uint16_t type = 0;
+	auto rec = r.ReadRecord(type);
+	REQUIRE(r.Failed());
+	REQUIRE(rec.Failed());
+	REQUIRE_EQ(rec.Remaining(), 0);
+}
+
+TEST_SUITE_END();
@@ -0,0 +1,211 @@
+#include <random>
+#include <vector>
+#include "pixel_kernels.h"
+#include "doctest.h"
+
+TEST_SUITE_BEGIN("PixelKernels");
+
+namespace {
+
+using PixelKernels::Isa;
+
+constexpr Isa simd_isas[] = { Isa::SSE2, Isa::AVX2, Isa::NEON };
+
+PixelKernels::ToneParams MakeParams(int rs, int gs, int bs, int as, int red, int green, int blue, int gray) {
+	PixelKernels::ToneParams p;
+	p.rs = rs;
+	p.gs = gs;
+	p.bs = bs;
+	p.as = as;
+	p.saturate = gray != 128;
+	p.saturation = gray > 128 ? 1024 + (gray - 128) * 16 : gray * 8;
+	p.color = red != 128 || green != 128 || blue != 128;
+	p.red = red;
+	p.green = green;
+	p.blue = blue;
+	return p;
+}
+
+void CompareWithScalar(const std::vector<uint32_t>& input, const PixelKernels::ToneParams& p) {
+	auto expected = input;
+	PixelKernels::detail::ToneRowScalar(expected.data(), expected.size(), p);
+
+	auto old_isa = PixelKernels::GetIsa();
+	for (auto isa: simd_isas) {
+		if (!PixelKernels::SetIsa(isa)) {
+			continue;
+		}
+		auto result = input;
+		PixelKernels::ToneRow(result.data(), result.size(), p);
+		INFO(PixelKernels::GetIsaName(isa));
+		REQUIRE(result == expected);
+	}
+	PixelKernels::SetIsa(old_isa);
+}
+
+}
+
+TEST_CASE("Scalar") {
+	REQUIRE(PixelKernels::IsSupported(Isa::Scalar));
+	REQUIRE(PixelKernels::SetIsa(Isa::Scalar));
+	REQUIRE_EQ(PixelKernels::GetIsa(), Isa::Scalar);
+
+	// RGBA, full saturation gray
+	std::vector<uint32_t> pixels = { 0xFF0000FF, 0x00000000 };
+	auto p = MakeParams(0, 8, 16, 24, 128, 128, 128, 0);
+	PixelKernels::ToneRow(pixels.data(), pixels.size(), p);
+	REQUIRE_EQ(pixels[0], 0xFF4C4C4C);
+	REQUIRE_EQ(pixels[1], 0x00000000);
+
+	// Hard light to white and black
+	pixels = { 0x80808080 };
+	p = MakeParams(0, 8, 16, 24, 255, 0, 128, 128);
+	PixelKernels::ToneRow(pixels.data(), pixels.size(), p);
+	REQUIRE_EQ(pixels[0], 0x808000FF);
+}
+
+TEST_CASE("SkipTransparent") {
+	std::vector<uint32_t> pixels = { 0x00FFFFFF, 0x01FFFFFF };
+	auto p = MakeParams(0, 8, 16, 24, 0, 0, 0, 128);
+
+	PixelKernels::detail::ToneRowScalar(pixels.data(), pixels.size(), p);
+	REQUIRE_EQ(pixels[0], 0x00000000);
+	REQUIRE_EQ(pixels[1], 0x01000000);
+
+	pixels = { 0x00FFFFFF, 0x01FFFFFF };
+	p.skip_transparent = true;
+	PixelKernels::detail::ToneRowScalar(pixels.data(), pixels.size(), p);
+	REQUIRE_EQ(pixels[0], 0x00FFFFFF);
+	REQUIRE_EQ(pixels[1], 0x01000000);
+}
+
+TEST_CASE("SimdMatchesScalar") {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> pixel_dist;
+	std::uniform_int_distribution<int> tone_dist(0, 255);
+
+	// Odd size to cover the scalar tail
+	std::vector<uint32_t> pixels(1027);
+	for (auto& px: pixels) {
+		px = pixel_dist(rng);
+	}
+	// Some fully transparent pixels in every format
+	for (size_t i = 0; i < pixels.size(); i += 5) {
+		pixels[i] &= (i % 2) ? 0x00FFFFFF : 0xFFFFFF00;
+	}
+
+	const int shifts[][4] = { { 0, 8, 16, 24 }, { 16, 8, 0, 24 }, { 24, 16, 8, 0 }, { 8, 16, 24, 0 } };
+
+	for (auto& s: shifts) {
+		for (int n = 0; n < 50; ++n) {
+			auto p = MakeParams(s[0], s[1], s[2], s[3], tone_dist(rng), tone_dist(rng), tone_dist(rng), tone_dist(rng));
+			CompareWithScalar(pixels, p);
+			p.skip_transparent = true;
+			CompareWithScalar(pixels, p);
+		}
+
+		// Extreme tones
+		for (int t: { 0, 127, 128, 129, 255 }) {
+			CompareWithScalar(pixels, MakeParams(s[0], s[1], s[2], s[3], t, 255 - t, t, t));
+			CompareWithScalar(pixels, MakeParams(s[0], s[1], s[2], s[3], 128, 128, 128, t));
+		}
+	}
+}
+
+TEST_CASE("AllHardLightValues") {
+	// Every tone and channel value once
+	std::vector<uint32_t> pixels(256);
+	for (int c = 0; c < 256; ++c) {
+		pixels[c] = 0xFF000000 | c << 16 | c << 8 | c;
+	}
+
+	for (int t = 0; t < 256; ++t) {
+		CompareWithScalar(pixels, MakeParams(0, 8, 16, 24, t, t, t, 128));
+	}
+}
+
+TEST_CASE("ScaleRow") {
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> pixel_dist;
+
+	std::vector<uint32_t> pixels(37);
+	for (auto& px: pixels) {
+		px = pixel_dist(rng);
+	}
+
+	auto old_isa = PixelKernels::GetIsa();
+	for (int factor = 1; factor <= 9; ++factor) {
+		std::vector<uint32_t> expected(pixels.size() * factor);
+		for (size_t i = 0; i < expected.size(); ++i) {
+			expected[i] = pixels[i / factor];
+		}
+
+		for (auto isa: { Isa::Scalar, Isa::SSE2, Isa::AVX2, Isa::NEON }) {
+			if (!PixelKernels::SetIsa(isa)) {
+				continue;
+			}
+			std::vector<uint32_t> result(expected.size());
+			PixelKernels::ScaleRow(pixels.data(), result.data(), pixels.size(), factor);
+			INFO(PixelKernels::GetIsaName(isa), " x", factor);
+			REQUIRE(result == expected);
+		}
+	}
+	PixelKernels::SetIsa(old_isa);
+}
+
+TEST_CASE("Scale2x") {
+	// The corners along the diagonal line are filled
+	const uint32_t above[] = { 1, 0, 0 };
+	const uint32_t row[] = { 0, 1, 0 };
+	const uint32_t below[] = { 0, 0, 1 };
+	uint32_t dst0[6];
+	uint32_t dst1[6];
+
+	PixelKernels::detail::Scale2xRowScalar(above, row, below, dst0, dst1, 3);
+	const uint32_t expected0[] = { 0, 1, 1, 1, 0, 0 };
+	const uint32_t expected1[] = { 0, 0, 1, 1, 1, 0 };
+	for (int i = 0; i < 6; ++i) {
+		INFO(i);
+		REQUIRE_EQ(dst0[i], expected0[i]);
+		REQUIRE_EQ(dst1[i], expected1[i]);
+	}
+
+	// A single pixel has no neighbours
+	const uint32_t single[] = { 7 };
+	PixelKernels::detail::Scale2xRowScalar(single, single, single, dst0, dst1, 1);
+	REQUIRE_EQ(dst0[0], 7);
+	REQUIRE_EQ(dst1[1], 7);
+}
+
+TEST_CASE("Scale2xSimdMatchesScalar") {
+	std::mt19937 rng(1234);
+	// Few colors, so that the neighbours are often equal
+	std::uniform_int_distribution<uint32_t> pixel_dist(0, 2);
+
+	for (int count: { 0, 1, 2, 5, 8, 9, 16, 17, 320 }) {
+		std::vector<uint32_t> above(count), row(count), below(count);
+		for (int i = 0; i < count; ++i) {
+			above[i] = pixel_dist(rng);
+			row[i] = pixel_dist(rng);
+			below[i] = pixel_dist(rng);
+		}
+
+		std::vector<uint32_t> expected0(count * 2), expected1(count * 2);
+		PixelKernels::detail::Scale2xRowScalar(above.data(), row.data(), below.data(), expected0.data(), expected1.data(), count);
+
+		auto old_isa = PixelKernels::GetIsa();
+		for (auto isa: simd_isas) {
+			if (!PixelKernels::SetIsa(isa)) {
+				continue;
+			}
+			std::vector<uint32_t> result0(count * 2), result1(count * 2);
+			PixelKernels::Scale2xRow(above.data(), row.data(), below.data(), result0.data(), result1.data(), count);
+			INFO(PixelKernels::GetIsaName(isa), " ", count);
+			REQUIRE(result0 == expected0);
+			REQUIRE(result1 == expected1);
+		}
+		PixelKernels::SetIsa(old_isa);
+	}
+}
+
+TEST_SUITE_END();
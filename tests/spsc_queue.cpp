@@ -0,0 +1,71 @@
+#include "spsc_queue.h"
+#include "doctest.h"
+#include <memory>
+#include <thread>
+
+TEST_SUITE_BEGIN("SpscQueue");
+
+TEST_CASE("PushPop") {
+	SpscQueue<int, 4> queue;
+	int value = 0;
+
+	REQUIRE(queue.IsEmpty());
+	REQUIRE_FALSE(queue.Pop(value));
+
+	for (int i = 1; i <= 4; ++i) {
+		REQUIRE(queue.Push(std::move(i)));
+	}
+	int extra = 5;
+	REQUIRE_FALSE(queue.Push(std::move(extra)));
+
+	for (int i = 1; i <= 4; ++i) {
+		REQUIRE(queue.Pop(value));
+		REQUIRE_EQ(value, i);
+	}
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_CASE("FullKeepsValue") {
+	SpscQueue<std::unique_ptr<int>, 1> queue;
+	auto first = std::make_unique<int>(1);
+	auto second = std::make_unique<int>(2);
+
+	REQUIRE(queue.Push(std::move(first)));
+	REQUIRE_FALSE(first);
+	REQUIRE_FALSE(queue.Push(std::move(second)));
+	REQUIRE(second);
+
+	std::unique_ptr<int> value;
+	REQUIRE(queue.Pop(value));
+	REQUIRE_EQ(*value, 1);
+}
+
+TEST_CASE("TwoThreads") {
+	SpscQueue<int, 16> queue;
+	constexpr int count = 100000;
+
+	std::thread producer([&]() {
+		for (int i = 0; i < count; ++i) {
+			int value = i;
+			while (!queue.Push(std::move(value))) {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	int expected = 0;
+	while (expected < count) {
+		int value;
+		if (queue.Pop(value)) {
+			REQUIRE_EQ(value, expected);
+			++expected;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+	producer.join();
+
+	REQUIRE(queue.IsEmpty());
+}
+
+TEST_SUITE_END();